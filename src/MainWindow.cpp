@@ -8,11 +8,17 @@
 #include "VisualizerWidget.h"
 #include "audio/AudioSource.h"
 #include "audio/AudioSourceFactory.h"
-#include "audio/DummyAudioSource.h"
+#include "audio/FileAudioSource.h"
+#include "audio/OnsetAnalyzer.h"
+#include "audio/RtSafetyGuard.h"
+#include "audio/SignalGeneratorAudioSource.h"
+#include "audio/ThreadPlacement.h"
+#include "widgets/LevelMeterWidget.h"
 #include "widgets/RatingDelegate.h"
 
 #include <QCheckBox>
 #include <QComboBox>
+#include <QDateTime>
 #include <QCoreApplication>
 #include <QDockWidget>
 #include <QDir>
@@ -36,6 +42,7 @@
 #include <QSignalBlocker>
 #include <QSettings>
 #include <QSizePolicy>
+#include <QSlider>
 #include <QStringList>
 #include <QSpinBox>
 #include <QSplitter>
@@ -47,7 +54,12 @@
 #include <QTimer>
 #include <QVBoxLayout>
 
+#include <cmath>
+#include <utility>
+
 namespace {
+float dbfsToAmplitude(int dbfs) { return static_cast<float>(std::pow(10.0, dbfs / 20.0)); }
+
 QString defaultPresetDirectory() {
   Q_UNUSED(QCoreApplication::applicationDirPath());
   return QDir::homePath() + QStringLiteral("/.projectM/presets");
@@ -111,10 +123,13 @@ void allowHorizontalShrink(QWidget *widget) {
 } // namespace
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
+  // projectM renders from the GUI thread, so that is the thread the render placement moves.
+  registerThread(currentThreadId(), ThreadRole::Render, "gui-render");
   m_presetModel = new PresetLibraryModel(this);
   m_playlistModel = new PlaylistModel(this);
   m_settingsManager = new SettingsManager(this);
   m_projectMEngine = new ProjectMEngine(this);
+  m_onsetAnalyzer = new OnsetAnalyzer(this);
 
   m_presetProxyModel = new PresetFilterProxyModel(this);
   m_presetProxyModel->setSourceModel(m_presetModel);
@@ -123,23 +138,55 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   wireSignals();
   loadInitialState();
 
-  bindAudioSource(createAudioSource(this));
+  m_onsetAnalyzer->setGate(static_cast<float>(m_onsetGateSpin->value()));
+  m_onsetAnalyzer->start();
+  bindAudioSource(createAudioSource(this, m_audioBackendCombo->currentData().toString()));
   startCurrentAudioSourceWithFallback();
   updateAudioBackendIndicator();
   updateRenderBackendIndicator();
   refreshAudioDeviceList();
 
   connect(m_projectMEngine, &ProjectMEngine::frameReady, m_visualizerWidget, &VisualizerWidget::consumeFrame);
+  connect(m_onsetAnalyzer, &OnsetAnalyzer::onsetDetected, this, &MainWindow::onOnsetDetected);
 
   m_playbackTimer = new QTimer(this);
   m_playbackTimer->setInterval(200);
   connect(m_playbackTimer, &QTimer::timeout, this, &MainWindow::onPlaybackTimerTick);
+
+  m_audioStatusTimer = new QTimer(this);
+  m_audioStatusTimer->setInterval(1000);
+  connect(m_audioStatusTimer, &QTimer::timeout, this, [this]() {
+    applyPendingThreadPlacement();
+    updateAudioBackendIndicator();
+    updateAudioFilePosition();
+    updateRenderIdleState();
+    learnPresetFeatures();
+    refreshPresetFeatureIndex();
+    if (m_audioDeviceDebugText != nullptr && m_audioDeviceDebugText->isVisible() && m_audioSource != nullptr) {
+      updateAudioDeviceDebugPanel(m_audioSource->availableDevices());
+    }
+  });
+  m_audioStatusTimer->start();
+
+  m_levelMeterTimer = new QTimer(this);
+  m_levelMeterTimer->setInterval(33);
+  connect(m_levelMeterTimer, &QTimer::timeout, this, &MainWindow::updateLevelMeter);
+  m_levelMeterTimer->start();
+
+  // Learned features are written in batches, never on the preset switch itself.
+  m_learnedFeaturesSaveTimer = new QTimer(this);
+  m_learnedFeaturesSaveTimer->setInterval(30000);
+  m_learnedFeaturesSaveTimer->setSingleShot(true);
+  connect(m_learnedFeaturesSaveTimer, &QTimer::timeout, this, &MainWindow::saveLearnedFeatures);
 }
 
 MainWindow::~MainWindow() {
+  flushLearnedFeatures();
+  saveLearnedFeatures();
   if (m_audioSource != nullptr) {
     m_audioSource->stop();
   }
+  unregisterThread(currentThreadId());
 }
 
 void MainWindow::buildUi() {
@@ -314,10 +361,15 @@ void MainWindow::buildUi() {
   m_playPauseButton = new QPushButton(QStringLiteral("Play"), playlistGroup);
   auto *nextButton = new QPushButton(QStringLiteral("Next"), playlistGroup);
   m_shuffleCheck = new QCheckBox(QStringLiteral("Shuffle"), playlistGroup);
+  m_matchAudioCheck = new QCheckBox(QStringLiteral("Match Audio"), playlistGroup);
+  m_matchAudioCheck->setToolTip(
+      QStringLiteral("Advance to a preset whose learned or tagged mood is close to the current input's energy, "
+                     "brightness, onset density and tempo."));
   allowHorizontalShrink(prevButton);
   allowHorizontalShrink(m_playPauseButton);
   allowHorizontalShrink(nextButton);
   allowHorizontalShrink(m_shuffleCheck);
+  allowHorizontalShrink(m_matchAudioCheck);
 
   m_autoAdvanceModeCombo = new QComboBox(playlistGroup);
   m_autoAdvanceModeCombo->addItems(
@@ -331,17 +383,19 @@ void MainWindow::buildUi() {
   m_autoBeatCountSpin = new QSpinBox(playlistGroup);
   m_autoBeatCountSpin->setRange(1, 128);
   m_autoBeatCountSpin->setValue(16);
-  m_autoBeatThresholdSpin = new QDoubleSpinBox(playlistGroup);
-  m_autoBeatThresholdSpin->setRange(0.001, 1.0);
-  m_autoBeatThresholdSpin->setDecimals(3);
-  m_autoBeatThresholdSpin->setValue(0.12);
-  m_autoBeatThresholdSpin->setSingleStep(0.01);
+  m_onsetGateSpin = new QDoubleSpinBox(playlistGroup);
+  m_onsetGateSpin->setRange(0.0, 1.0);
+  m_onsetGateSpin->setDecimals(3);
+  m_onsetGateSpin->setValue(0.01);
+  m_onsetGateSpin->setSingleStep(0.005);
+  m_onsetGateSpin->setToolTip(QStringLiteral("Input level (RMS) below which no beats are counted."));
 
   auto *transportRow = new QHBoxLayout();
   transportRow->addWidget(prevButton);
   transportRow->addWidget(m_playPauseButton);
   transportRow->addWidget(nextButton);
   transportRow->addWidget(m_shuffleCheck);
+  transportRow->addWidget(m_matchAudioCheck);
   transportRow->addStretch(1);
   auto *timingRow = new QHBoxLayout();
   timingRow->addWidget(new QLabel(QStringLiteral("Advance"), playlistGroup));
@@ -351,8 +405,8 @@ void MainWindow::buildUi() {
   auto *beatRow = new QHBoxLayout();
   beatRow->addWidget(new QLabel(QStringLiteral("Beats"), playlistGroup));
   beatRow->addWidget(m_autoBeatCountSpin);
-  beatRow->addWidget(new QLabel(QStringLiteral("Beat Threshold"), playlistGroup));
-  beatRow->addWidget(m_autoBeatThresholdSpin);
+  beatRow->addWidget(new QLabel(QStringLiteral("Onset Gate"), playlistGroup));
+  beatRow->addWidget(m_onsetGateSpin);
   beatRow->addStretch(1);
   playbackControls->addLayout(transportRow);
   playbackControls->addLayout(timingRow);
@@ -373,12 +427,34 @@ void MainWindow::buildUi() {
   m_meshYSpin->setRange(8, 256);
   m_targetFpsSpin = new QSpinBox(settingsTab);
   m_targetFpsSpin->setRange(15, 240);
+  m_silenceFloorSpin = new QSpinBox(settingsTab);
+  m_silenceFloorSpin->setRange(-96, 0);
+  m_silenceFloorSpin->setSuffix(QStringLiteral(" dBFS"));
+  m_silenceFloorSpin->setToolTip(QStringLiteral("Input peaks below this level count as silence."));
+  m_silenceHoldSpin = new QSpinBox(settingsTab);
+  m_silenceHoldSpin->setRange(1, 3600);
+  m_silenceHoldSpin->setSuffix(QStringLiteral(" s"));
+  m_silenceHoldSpin->setToolTip(QStringLiteral("How long the input must stay silent before rendering idles."));
+  m_idleFpsSpin = new QSpinBox(settingsTab);
+  m_idleFpsSpin->setRange(0, 30);
+  m_idleFpsSpin->setSpecialValueText(QStringLiteral("Freeze"));
+  m_idleFpsSpin->setToolTip(
+      QStringLiteral("Render rate while the input is silent; Freeze holds the last frame until signal returns."));
   m_beatSensitivitySpin = new QDoubleSpinBox(settingsTab);
   m_beatSensitivitySpin->setRange(0.1, 5.0);
   m_beatSensitivitySpin->setSingleStep(0.1);
   m_hardCutEnabledCheck = new QCheckBox(settingsTab);
   m_hardCutDurationSpin = new QSpinBox(settingsTab);
   m_hardCutDurationSpin->setRange(1, 120);
+  m_analysisBlockSpin = new QSpinBox(settingsTab);
+  m_analysisBlockSpin->setRange(64, 16384);
+  m_analysisBlockSpin->setSuffix(QStringLiteral(" frames"));
+  m_analysisBlockSpin->setToolTip(
+      QStringLiteral("Audio is regrouped into windows of this size before analysis, whatever the capture quantum."));
+  m_analysisHopSpin = new QSpinBox(settingsTab);
+  m_analysisHopSpin->setRange(1, 16384);
+  m_analysisHopSpin->setSuffix(QStringLiteral(" frames"));
+  m_analysisHopSpin->setToolTip(QStringLiteral("New frames per window; smaller than the window means overlap."));
   m_upscalePresetCombo = new QComboBox(settingsTab);
   m_upscalePresetCombo->addItem(QStringLiteral("Quality"), QStringLiteral("quality"));
   m_upscalePresetCombo->addItem(QStringLiteral("Balanced"), QStringLiteral("balanced"));
@@ -391,6 +467,7 @@ void MainWindow::buildUi() {
   m_upscaleSharpnessSpin->setRange(0.0, 1.0);
   m_upscaleSharpnessSpin->setDecimals(2);
   m_upscaleSharpnessSpin->setSingleStep(0.05);
+  m_previewMonoDownmixCheck = new QCheckBox(settingsTab);
   m_gpuPreferenceCombo = new QComboBox(settingsTab);
   m_gpuPreferenceCombo->addItem(QStringLiteral("Auto (system default)"), QStringLiteral("auto"));
   m_gpuPreferenceCombo->addItem(QStringLiteral("Discrete GPU (dGPU)"), QStringLiteral("dgpu"));
@@ -399,26 +476,105 @@ void MainWindow::buildUi() {
   m_audioDeviceCombo->setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLengthWithIcon);
   m_audioDeviceCombo->setMinimumContentsLength(20);
   m_refreshAudioDevicesButton = new QPushButton(QStringLiteral("Refresh"), settingsTab);
+  m_levelMeter = new LevelMeterWidget(settingsTab);
   allowHorizontalShrink(m_audioDeviceCombo);
   allowHorizontalShrink(m_refreshAudioDevicesButton);
+  m_saveCaptureButton = new QPushButton(QStringLiteral("Save Capture..."), settingsTab);
+  m_saveCaptureButton->setToolTip(QStringLiteral("Write the recent capture history to a WAV file for replay."));
+  allowHorizontalShrink(m_saveCaptureButton);
+  m_captureHistorySpin = new QSpinBox(settingsTab);
+  m_captureHistorySpin->setRange(0, 600);
+  m_captureHistorySpin->setSuffix(QStringLiteral(" s"));
+  m_captureHistorySpin->setSpecialValueText(QStringLiteral("Off"));
+  m_audioLatencyCombo = new QComboBox(settingsTab);
+  m_audioLatencyCombo->addItem(QStringLiteral("Graph default"), 0);
+  for (const int frames : {64, 128, 256, 512, 1024, 2048}) {
+    m_audioLatencyCombo->addItem(
+        QStringLiteral("%1 frames (%2 ms @ 48 kHz)").arg(frames).arg(frames * 1000.0 / 48000.0, 0, 'f', 1), frames);
+  }
+
+  m_audioBackendCombo = new QComboBox(settingsTab);
+  for (const QString &backend : availableAudioBackends()) {
+    const QString label = backend == QStringLiteral("auto")        ? QStringLiteral("Automatic")
+                          : backend == QStringLiteral("pipewire")  ? QStringLiteral("PipeWire")
+                          : backend == QStringLiteral("jack")      ? QStringLiteral("JACK")
+                          : backend == QStringLiteral("file")      ? QStringLiteral("Audio files")
+                          : backend == QStringLiteral("rtp")       ? QStringLiteral("RTP (network)")
+                          : backend == QStringLiteral("local-pcm") ? QStringLiteral("Local PCM (pipe or shared memory)")
+                          : backend == QStringLiteral("replay")    ? QStringLiteral("Capture replay")
+                                                                   : QStringLiteral("Signal generator");
+    m_audioBackendCombo->addItem(label, backend);
+  }
+  m_audioBackendCombo->setToolTip(QStringLiteral("Capture backend; QT6MPLAYER_AUDIO_BACKEND overrides it."));
+
+  m_mixInputsEdit = new QLineEdit(settingsTab);
+  m_mixInputsEdit->setPlaceholderText(QStringLiteral("node.name=gain; other.node=gain (empty: Audio Input only)"));
+  m_mixInputsEdit->setToolTip(
+      QStringLiteral("Capture several PipeWire nodes at once and mix them with per-input gain. "
+                     "Overrides Audio Input when set; \"default\" follows the default sink."));
+  const QString threadPlaceholder = QStringLiteral("cpus=2-3 policy=fifo priority=60 nice=-5 (empty: unchanged)");
+  const QString threadToolTip =
+      QStringLiteral("CPU set, scheduling policy (other, batch, idle, fifo, rr) and niceness. "
+                     "Anything the system refuses is left as is and noted in the debug panel.");
+  m_captureThreadsEdit = new QLineEdit(settingsTab);
+  m_captureThreadsEdit->setPlaceholderText(threadPlaceholder);
+  m_captureThreadsEdit->setToolTip(threadToolTip);
+  m_renderThreadEdit = new QLineEdit(settingsTab);
+  m_renderThreadEdit->setPlaceholderText(threadPlaceholder);
+  m_renderThreadEdit->setToolTip(threadToolTip);
+  m_workerThreadsEdit = new QLineEdit(settingsTab);
+  m_workerThreadsEdit->setPlaceholderText(threadPlaceholder);
+  m_workerThreadsEdit->setToolTip(threadToolTip);
+
+  m_openAudioFilesButton = new QPushButton(QStringLiteral("Open Audio Files..."), settingsTab);
+  m_openAudioFilesButton->setToolTip(QStringLiteral("Play FLAC, Ogg, MP3 or WAV files instead of capturing."));
+  m_audioFilePlayoutCheck = new QCheckBox(QStringLiteral("Play through PipeWire"), settingsTab);
+  m_audioFilePlayoutCheck->setToolTip(QStringLiteral("Also send the files to the default output, with visuals timed to it."));
+  m_audioFilePositionSlider = new QSlider(Qt::Horizontal, settingsTab);
+  m_audioFilePositionSlider->setEnabled(false);
+  m_audioFilePositionLabel = new QLabel(QStringLiteral("--:-- / --:--"), settingsTab);
+
+  auto *audioFileRowWidget = new QWidget(settingsTab);
+  auto *audioFileRowLayout = new QHBoxLayout(audioFileRowWidget);
+  audioFileRowLayout->setContentsMargins(0, 0, 0, 0);
+  audioFileRowLayout->addWidget(m_openAudioFilesButton);
+  audioFileRowLayout->addWidget(m_audioFilePlayoutCheck);
+  audioFileRowLayout->addWidget(m_audioFilePositionSlider, 1);
+  audioFileRowLayout->addWidget(m_audioFilePositionLabel);
 
   auto *audioDeviceRowWidget = new QWidget(settingsTab);
   auto *audioDeviceRowLayout = new QHBoxLayout(audioDeviceRowWidget);
   audioDeviceRowLayout->setContentsMargins(0, 0, 0, 0);
   audioDeviceRowLayout->addWidget(m_audioDeviceCombo, 1);
+  audioDeviceRowLayout->addWidget(m_levelMeter);
   audioDeviceRowLayout->addWidget(m_refreshAudioDevicesButton);
+  audioDeviceRowLayout->addWidget(m_saveCaptureButton);
 
   form->addRow(QStringLiteral("Mesh X"), m_meshXSpin);
   form->addRow(QStringLiteral("Mesh Y"), m_meshYSpin);
   form->addRow(QStringLiteral("Target FPS"), m_targetFpsSpin);
+  form->addRow(QStringLiteral("Silence Floor"), m_silenceFloorSpin);
+  form->addRow(QStringLiteral("Silence Hold"), m_silenceHoldSpin);
+  form->addRow(QStringLiteral("Idle FPS"), m_idleFpsSpin);
   form->addRow(QStringLiteral("Beat Sensitivity"), m_beatSensitivitySpin);
   form->addRow(QStringLiteral("Hard Cut Enabled"), m_hardCutEnabledCheck);
   form->addRow(QStringLiteral("Hard Cut Duration (s)"), m_hardCutDurationSpin);
+  form->addRow(QStringLiteral("Analysis Window"), m_analysisBlockSpin);
+  form->addRow(QStringLiteral("Analysis Hop"), m_analysisHopSpin);
   form->addRow(QStringLiteral("Upscaler Preset"), m_upscalePresetCombo);
   form->addRow(QStringLiteral("Render Scale"), m_renderScaleSpin);
   form->addRow(QStringLiteral("Upscale Sharpness"), m_upscaleSharpnessSpin);
+  form->addRow(QStringLiteral("Mono Fallback Preview"), m_previewMonoDownmixCheck);
   form->addRow(QStringLiteral("GPU Preference (restart app)"), m_gpuPreferenceCombo);
+  form->addRow(QStringLiteral("Audio Backend"), m_audioBackendCombo);
   form->addRow(QStringLiteral("Audio Input"), audioDeviceRowWidget);
+  form->addRow(QStringLiteral("Audio Files"), audioFileRowWidget);
+  form->addRow(QStringLiteral("Mix Inputs"), m_mixInputsEdit);
+  form->addRow(QStringLiteral("Capture Latency"), m_audioLatencyCombo);
+  form->addRow(QStringLiteral("Capture History"), m_captureHistorySpin);
+  form->addRow(QStringLiteral("Capture Threads"), m_captureThreadsEdit);
+  form->addRow(QStringLiteral("Render Thread"), m_renderThreadEdit);
+  form->addRow(QStringLiteral("Worker Threads"), m_workerThreadsEdit);
 
   settingsLayout->addLayout(form);
   settingsLayout->addWidget(new QLabel(QStringLiteral("Audio Node Debug"), settingsTab));
@@ -485,6 +641,9 @@ void MainWindow::buildUi() {
   connect(m_previewFloatButton, &QPushButton::clicked, this, &MainWindow::togglePreviewFloating);
   connect(m_previewFullscreenButton, &QPushButton::clicked, this, &MainWindow::togglePreviewFullscreen);
   connect(m_showFpsCheck, &QCheckBox::toggled, m_visualizerWidget, &VisualizerWidget::setFpsDisplayEnabled);
+  connect(m_onsetGateSpin, qOverload<double>(&QDoubleSpinBox::valueChanged), this, [this](double value) {
+    m_onsetAnalyzer->setGate(static_cast<float>(value));
+  });
   connect(saveNowPlayingButton, &QPushButton::clicked, this, &MainWindow::applyNowPlayingMetadata);
   connect(m_nowPlayingRatingSpin, qOverload<int>(&QSpinBox::valueChanged), this, [this](int) {
     if (!m_syncingNowPlayingUi) {
@@ -559,6 +718,7 @@ void MainWindow::buildUi() {
 
   connect(applySettingsButton, &QPushButton::clicked, this, &MainWindow::applyProjectMSettingsFromUi);
   connect(m_refreshAudioDevicesButton, &QPushButton::clicked, this, &MainWindow::refreshAudioDeviceList);
+  connect(m_saveCaptureButton, &QPushButton::clicked, this, &MainWindow::saveCaptureHistory);
   connect(m_audioDeviceCombo,
           qOverload<int>(&QComboBox::currentIndexChanged),
           this,
@@ -567,6 +727,21 @@ void MainWindow::buildUi() {
               applySelectedAudioDevice();
             }
           });
+  connect(m_audioLatencyCombo,
+          qOverload<int>(&QComboBox::currentIndexChanged),
+          this,
+          &MainWindow::applySelectedAudioLatency);
+  connect(m_audioBackendCombo,
+          qOverload<int>(&QComboBox::currentIndexChanged),
+          this,
+          &MainWindow::applySelectedAudioBackend);
+  connect(m_mixInputsEdit, &QLineEdit::editingFinished, this, &MainWindow::applyMixInputs);
+  connect(m_openAudioFilesButton, &QPushButton::clicked, this, &MainWindow::openAudioFiles);
+  connect(m_audioFilePlayoutCheck, &QCheckBox::toggled, this, &MainWindow::applyAudioFilePlayout);
+  connect(m_audioFilePositionSlider, &QSlider::sliderReleased, this, &MainWindow::seekAudioFile);
+  for (QLineEdit *edit : {m_captureThreadsEdit, m_renderThreadEdit, m_workerThreadsEdit}) {
+    connect(edit, &QLineEdit::editingFinished, this, &MainWindow::applyThreadPlacementSettings);
+  }
   connect(m_previewDock, &QDockWidget::topLevelChanged, this, [this](bool floating) {
     m_previewFloatButton->setText(floating ? QStringLiteral("Attach Preview")
                                            : QStringLiteral("Float Preview"));
@@ -610,6 +785,18 @@ void MainWindow::buildUi() {
 }
 
 void MainWindow::wireSignals() {
+  const auto invalidateFeatureIndex = [this]() { m_presetFeatureIndexDirty = true; };
+  connect(m_playlistModel, &QAbstractItemModel::rowsInserted, this, invalidateFeatureIndex);
+  connect(m_playlistModel, &QAbstractItemModel::rowsRemoved, this, invalidateFeatureIndex);
+  connect(m_playlistModel, &QAbstractItemModel::rowsMoved, this, invalidateFeatureIndex);
+  connect(m_playlistModel, &QAbstractItemModel::modelReset, this, invalidateFeatureIndex);
+  connect(m_matchAudioCheck, &QCheckBox::toggled, this, [this](bool checked) {
+    if (checked) {
+      refreshPresetFeatureIndex();
+      setStatus(QStringLiteral("Matching audio over %1 described playlist presets.").arg(m_presetFeatureIndex.size()));
+    }
+  });
+
   connect(m_presetSearchEdit, &QLineEdit::textChanged, this, [this](const QString &text) {
     const QRegularExpression filter(QRegularExpression::escape(text),
                                     QRegularExpression::CaseInsensitiveOption);
@@ -643,6 +830,7 @@ void MainWindow::wireSignals() {
             if (!m_settingsManager->savePresetMetadata(path, metadata)) {
               setStatus(QStringLiteral("Failed to persist preset metadata."));
             }
+            m_presetFeatureIndexDirty = true;
             if (path == m_currentPresetPath) {
               QMetaObject::invokeMethod(
                   this,
@@ -668,11 +856,18 @@ void MainWindow::loadInitialState() {
   m_meshXSpin->setValue(projectMSettings.value(QStringLiteral("meshX"), 32).toInt());
   m_meshYSpin->setValue(projectMSettings.value(QStringLiteral("meshY"), 24).toInt());
   m_targetFpsSpin->setValue(projectMSettings.value(QStringLiteral("targetFps"), 60).toInt());
+  m_silenceFloorSpin->setValue(projectMSettings.value(QStringLiteral("silenceFloorDb"), -60).toInt());
+  m_silenceHoldSpin->setValue(projectMSettings.value(QStringLiteral("silenceHoldSeconds"), 10).toInt());
+  m_idleFpsSpin->setValue(projectMSettings.value(QStringLiteral("idleFps"), 5).toInt());
   m_beatSensitivitySpin->setValue(projectMSettings.value(QStringLiteral("beatSensitivity"), 1.0).toDouble());
   m_hardCutEnabledCheck->setChecked(projectMSettings.value(QStringLiteral("hardCutEnabled"), true).toBool());
   m_hardCutDurationSpin->setValue(projectMSettings.value(QStringLiteral("hardCutDuration"), 20).toInt());
+  m_analysisBlockSpin->setValue(projectMSettings.value(QStringLiteral("analysisBlockFrames"), 1024).toInt());
+  m_analysisHopSpin->setValue(projectMSettings.value(QStringLiteral("analysisHopFrames"), 512).toInt());
   m_renderScaleSpin->setValue(projectMSettings.value(QStringLiteral("renderScalePercent"), 77).toInt());
   m_upscaleSharpnessSpin->setValue(projectMSettings.value(QStringLiteral("upscalerSharpness"), 0.2).toDouble());
+  m_captureHistorySpin->setValue(projectMSettings.value(QStringLiteral("captureHistorySeconds"), 30).toInt());
+  m_previewMonoDownmixCheck->setChecked(projectMSettings.value(QStringLiteral("previewMonoDownmix"), false).toBool());
   QString upscalerPreset = projectMSettings.value(QStringLiteral("upscalerPreset"), QStringLiteral("balanced"))
                                .toString()
                                .trimmed()
@@ -696,6 +891,42 @@ void MainWindow::loadInitialState() {
   m_gpuPreferenceCombo->setCurrentIndex(gpuPreferenceIndex >= 0 ? gpuPreferenceIndex : 1);
   m_appliedGpuPreference = m_gpuPreferenceCombo->currentData().toString();
   m_preferredAudioDeviceId = projectMSettings.value(QStringLiteral("audioDeviceId")).toString().trimmed();
+  m_preferredAudioLatencyFrames = qMax(0, projectMSettings.value(QStringLiteral("audioLatencyFrames"), 0).toInt());
+  m_preferredMixInputs = projectMSettings.value(QStringLiteral("audioMixInputs")).toString().trimmed();
+  m_audioFileTracks = projectMSettings.value(QStringLiteral("audioFileTracks")).toStringList();
+  {
+    const QSignalBlocker blocker(m_audioFilePlayoutCheck);
+    m_audioFilePlayoutCheck->setChecked(projectMSettings.value(QStringLiteral("audioFilePlayout"), false).toBool());
+  }
+  {
+    const QSignalBlocker blocker(m_audioBackendCombo);
+    const QString savedBackend =
+        projectMSettings.value(QStringLiteral("audioBackend"), QStringLiteral("auto")).toString().trimmed().toLower();
+    const int backendIndex = m_audioBackendCombo->findData(savedBackend);
+    if (backendIndex < 0) {
+      setStatus(QStringLiteral("Audio backend \"%1\" is not available in this build; using Automatic.").arg(savedBackend));
+    }
+    m_audioBackendCombo->setCurrentIndex(backendIndex >= 0 ? backendIndex : 0);
+  }
+  {
+    const QSignalBlocker blocker(m_mixInputsEdit);
+    m_mixInputsEdit->setText(m_preferredMixInputs);
+  }
+  m_captureThreadsEdit->setText(projectMSettings.value(QStringLiteral("captureThreadPlacement")).toString());
+  m_renderThreadEdit->setText(projectMSettings.value(QStringLiteral("renderThreadPlacement")).toString());
+  m_workerThreadsEdit->setText(projectMSettings.value(QStringLiteral("workerThreadPlacement")).toString());
+  applyThreadPlacementPolicies();
+  {
+    const QSignalBlocker blocker(m_audioLatencyCombo);
+    const int latencyIndex = m_audioLatencyCombo->findData(m_preferredAudioLatencyFrames);
+    if (latencyIndex >= 0) {
+      m_audioLatencyCombo->setCurrentIndex(latencyIndex);
+    } else {
+      m_audioLatencyCombo->addItem(QStringLiteral("%1 frames").arg(m_preferredAudioLatencyFrames),
+                                   m_preferredAudioLatencyFrames);
+      m_audioLatencyCombo->setCurrentIndex(m_audioLatencyCombo->count() - 1);
+    }
+  }
 
   applyProjectMSettingsFromUi();
   updateNowPlayingPanel(QString());
@@ -715,7 +946,9 @@ void MainWindow::refreshPlaylistNames() {
 void MainWindow::updatePresetDirectory(const QString &path) {
   m_presetDirectoryEdit->setText(path);
   m_presetModel->setPresetDirectory(path);
+  saveLearnedFeatures();
   m_presetModel->applyMetadata(m_settingsManager->loadPresetMetadata());
+  m_presetFeatureIndexDirty = true;
 
   m_projectMEngine->setPresetDirectory(path);
 
@@ -731,20 +964,23 @@ QModelIndex MainWindow::selectedPresetSourceIndex() const {
   return m_presetProxyModel->mapToSource(proxyIndex.siblingAtColumn(0));
 }
 
-bool MainWindow::loadPlaylistRow(int row) {
+bool MainWindow::loadPlaylistRow(int row, qint64 audioTimeNs) {
   const QVector<PlaylistItem> items = m_playlistModel->items();
   if (row < 0 || row >= items.size()) {
     return false;
   }
 
   const PlaylistItem &item = items.at(row);
-  if (!m_projectMEngine->loadPreset(item.presetPath)) {
+  const bool loaded = audioTimeNs > 0 ? m_projectMEngine->loadPresetAt(item.presetPath, audioTimeNs)
+                                      : m_projectMEngine->loadPreset(item.presetPath);
+  if (!loaded) {
     return false;
   }
 
   m_playlistTable->selectRow(row);
   m_trackElapsed.restart();
   m_beatsSinceSwitch = 0;
+  m_switchAudioTimeNs = audioTimeNs > 0 ? audioTimeNs : monotonicTimeNs();
   return true;
 }
 
@@ -969,7 +1205,11 @@ void MainWindow::importPresetMetadata() {
     return;
   }
 
+  // Pending learned features go first, or the file written from the model
+  // below would already hold them and the batch would count them twice.
+  saveLearnedFeatures();
   m_presetModel->applyMetadata(metadata);
+  m_presetFeatureIndexDirty = true;
   if (!m_settingsManager->savePresetMetadataMap(m_presetModel->metadataMap())) {
     QMessageBox::warning(this,
                          QStringLiteral("Save failed"),
@@ -1015,19 +1255,42 @@ void MainWindow::applyProjectMSettingsFromUi() {
   map.insert(QStringLiteral("meshX"), m_meshXSpin->value());
   map.insert(QStringLiteral("meshY"), m_meshYSpin->value());
   map.insert(QStringLiteral("targetFps"), m_targetFpsSpin->value());
+  map.insert(QStringLiteral("silenceFloorDb"), m_silenceFloorSpin->value());
+  map.insert(QStringLiteral("silenceHoldSeconds"), m_silenceHoldSpin->value());
+  map.insert(QStringLiteral("idleFps"), m_idleFpsSpin->value());
   map.insert(QStringLiteral("beatSensitivity"), m_beatSensitivitySpin->value());
   map.insert(QStringLiteral("hardCutEnabled"), m_hardCutEnabledCheck->isChecked());
   map.insert(QStringLiteral("hardCutDuration"), m_hardCutDurationSpin->value());
+  map.insert(QStringLiteral("analysisBlockFrames"), m_analysisBlockSpin->value());
+  map.insert(QStringLiteral("analysisHopFrames"), qMin(m_analysisHopSpin->value(), m_analysisBlockSpin->value()));
   map.insert(QStringLiteral("upscalerPreset"), upscalerPreset);
   map.insert(QStringLiteral("renderScalePercent"), m_renderScaleSpin->value());
   map.insert(QStringLiteral("upscalerSharpness"), m_upscaleSharpnessSpin->value());
+  map.insert(QStringLiteral("previewMonoDownmix"), m_previewMonoDownmixCheck->isChecked());
   map.insert(QStringLiteral("gpuPreference"), gpuPreference);
   map.insert(QStringLiteral("audioDeviceId"), m_preferredAudioDeviceId);
+  map.insert(QStringLiteral("audioLatencyFrames"), m_preferredAudioLatencyFrames);
+  map.insert(QStringLiteral("audioMixInputs"), m_preferredMixInputs);
+  map.insert(QStringLiteral("audioBackend"), m_audioBackendCombo->currentData().toString());
+  map.insert(QStringLiteral("audioFileTracks"), m_audioFileTracks);
+  map.insert(QStringLiteral("audioFilePlayout"), m_audioFilePlayoutCheck->isChecked());
+  map.insert(QStringLiteral("captureThreadPlacement"), m_captureThreadsEdit->text().trimmed());
+  map.insert(QStringLiteral("renderThreadPlacement"), m_renderThreadEdit->text().trimmed());
+  map.insert(QStringLiteral("workerThreadPlacement"), m_workerThreadsEdit->text().trimmed());
+  map.insert(QStringLiteral("captureHistorySeconds"), m_captureHistorySpin->value());
+
+  if (m_audioSource != nullptr) {
+    m_audioSource->setCaptureHistorySeconds(m_captureHistorySpin->value());
+    m_audioSource->setSilenceFloor(dbfsToAmplitude(m_silenceFloorSpin->value()));
+  }
 
   if (m_visualizerWidget != nullptr) {
     m_visualizerWidget->setRenderScalePercent(m_renderScaleSpin->value());
     m_visualizerWidget->setUpscaleSharpness(m_upscaleSharpnessSpin->value());
+    m_visualizerWidget->setPreviewMonoDownmix(m_previewMonoDownmixCheck->isChecked());
+    m_visualizerWidget->setIdleFps(m_idleFpsSpin->value());
   }
+  updateRenderIdleState();
 
   const bool gpuPreferenceChanged = (m_appliedGpuPreference != gpuPreference);
   m_appliedGpuPreference = gpuPreference;
@@ -1048,6 +1311,7 @@ void MainWindow::togglePlaylistPlayback() {
   if (!m_playlistPlaying) {
     m_playPauseButton->setText(QStringLiteral("Play"));
     m_playbackTimer->stop();
+    m_projectMEngine->cancelScheduledPreset();
     return;
   }
 
@@ -1077,15 +1341,21 @@ void MainWindow::togglePlaylistPlayback() {
   m_playbackTimer->start();
 }
 
-void MainWindow::playNextPlaylistItem() {
+int MainWindow::nextPlaylistRow() {
   const int rows = m_playlistModel->rowCount();
   if (rows == 0) {
-    return;
+    return -1;
   }
 
   const int current = m_playlistTable->currentIndex().isValid() ? m_playlistTable->currentIndex().row() : -1;
   int next = 0;
 
+  if (m_matchAudioCheck->isChecked() && rows > 1) {
+    next = matchedPlaylistRow(current);
+    if (next >= 0 && next < rows) {
+      return next;
+    }
+  }
   if (m_shuffleCheck->isChecked() && rows > 1) {
     do {
       next = QRandomGenerator::global()->bounded(rows);
@@ -1093,10 +1363,94 @@ void MainWindow::playNextPlaylistItem() {
   } else {
     next = (current + 1 + rows) % rows;
   }
+  return next;
+}
+
+// Picks among the few presets nearest to the input rather than always the
+// nearest, so a steady song does not bounce between the same two. -1 leaves
+// the choice to shuffle or playlist order.
+int MainWindow::matchedPlaylistRow(int currentRow) {
+  constexpr int kMatchCandidates = 4;
+
+  const AudioFeatures features = m_onsetAnalyzer->features();
+  if (!features.valid || m_presetFeatureIndex.size() == 0) {
+    return -1;
+  }
+  const QVector<int> candidates = m_presetFeatureIndex.nearestRows(features, kMatchCandidates, currentRow);
+  if (candidates.isEmpty()) {
+    return -1;
+  }
+  return candidates.at(QRandomGenerator::global()->bounded(static_cast<int>(candidates.size())));
+}
+
+// Called once a second: averages the input heard under the preset on
+// screen and folds it into that preset's metadata once it is replaced.
+void MainWindow::learnPresetFeatures() {
+  if (m_currentPresetPath != m_learningPresetPath) {
+    flushLearnedFeatures();
+    m_learningPresetPath = m_currentPresetPath;
+  }
+
+  const AudioFeatures features = m_onsetAnalyzer->features();
+  if (m_learningPresetPath.isEmpty() || !features.valid) {
+    return;
+  }
+  for (int axis = 0; axis < AudioFeatures::AxisCount; ++axis) {
+    m_learnedFeatureSums[axis] += features.values[axis];
+  }
+  ++m_learnedFeatureSeconds;
+}
+
+void MainWindow::flushLearnedFeatures() {
+  // Too short a look (a skipped preset) says little about what it suits.
+  constexpr int kMinLearnSeconds = 5;
+
+  if (m_learnedFeatureSeconds >= kMinLearnSeconds) {
+    AudioFeatures mean;
+    for (int axis = 0; axis < AudioFeatures::AxisCount; ++axis) {
+      mean.values[axis] = m_learnedFeatureSums[axis] / static_cast<float>(m_learnedFeatureSeconds);
+    }
+    mean.valid = true;
+    // The model is the index's source and is updated at once; the file
+    // follows in the next batch.
+    if (m_presetModel->addLearnedFeatures(m_learningPresetPath, mean, m_learnedFeatureSeconds) &&
+        !m_presetFeatureIndexDirty) {
+      const int row = m_presetModel->rowForPresetPath(m_learningPresetPath);
+      m_presetFeatureIndex.updatePreset(
+          m_playlistModel->items(), m_learningPresetPath, m_presetModel->presetMetadataForRow(row));
+    }
+    m_pendingLearnedFeatures.push_back({m_learningPresetPath, mean, m_learnedFeatureSeconds});
+    if (!m_learnedFeaturesSaveTimer->isActive()) {
+      m_learnedFeaturesSaveTimer->start();
+    }
+  }
+  m_learnedFeatureSums.fill(0.0f);
+  m_learnedFeatureSeconds = 0;
+}
+
+void MainWindow::saveLearnedFeatures() {
+  if (m_pendingLearnedFeatures.isEmpty()) {
+    return;
+  }
+  m_learnedFeaturesSaveTimer->stop();
+  if (!m_settingsManager->addLearnedFeatures(m_pendingLearnedFeatures)) {
+    setStatus(QStringLiteral("Failed to persist learned preset features."));
+  }
+  m_pendingLearnedFeatures.clear();
+}
 
-  loadPlaylistRow(next);
+// Rebuilt from the in-memory library on the status timer, so playlist edits
+// in a burst cost one rebuild.
+void MainWindow::refreshPresetFeatureIndex() {
+  if (!m_presetFeatureIndexDirty || m_matchAudioCheck == nullptr || !m_matchAudioCheck->isChecked()) {
+    return;
+  }
+  m_presetFeatureIndex.rebuild(m_playlistModel->items(), m_presetModel->metadataMap());
+  m_presetFeatureIndexDirty = false;
 }
 
+void MainWindow::playNextPlaylistItem() { loadPlaylistRow(nextPlaylistRow()); }
+
 void MainWindow::playPreviousPlaylistItem() {
   const int rows = m_playlistModel->rowCount();
   if (rows == 0) {
@@ -1118,34 +1472,46 @@ void MainWindow::onPlaybackTimerTick() {
     if (m_trackElapsed.elapsed() >= maxMs) {
       playNextPlaylistItem();
     }
+  } else if (m_autoAdvanceModeCombo->currentIndex() == 2) {
+    scheduleBeatSwitch();
   }
 }
 
-void MainWindow::onAudioFrameForPlayback(const QVector<float> &monoFrame) {
-  if (!m_playlistPlaying || m_autoAdvanceModeCombo->currentIndex() != 2 || monoFrame.isEmpty()) {
-    return;
+// With a confident tempo, counts beats on the tracker's grid and hands the
+// switch to the engine for the first downbeat once the count is reached.
+// False without one; onsets are then counted as they arrive instead.
+bool MainWindow::scheduleBeatSwitch() {
+  constexpr float kMinTempoConfidence = 0.3f;
+  // Predict no further ahead than needed to catch the downbeat between ticks.
+  constexpr qint64 kScheduleAheadNs = 500000000LL;
+
+  const TempoEstimate tempo = m_onsetAnalyzer->tempo();
+  if (!tempo.isValid() || tempo.confidence < kMinTempoConfidence) {
+    return false;
   }
 
-  const int sampleCount = qMin(monoFrame.size(), 1024);
-  float energy = 0.0f;
-  for (int i = 0; i < sampleCount; ++i) {
-    energy += qAbs(monoFrame.at(i));
+  const qint64 nowNs = monotonicTimeNs();
+  if (m_switchAudioTimeNs > nowNs) {
+    return true;
+  }
+  const qint64 dueNs = m_switchAudioTimeNs + m_autoBeatCountSpin->value() * tempo.beatPeriodNs;
+  const qint64 downbeatNs = tempo.nextDownbeatNs(qMax(dueNs - tempo.beatPeriodNs / 2, nowNs));
+  if (downbeatNs - nowNs <= kScheduleAheadNs) {
+    loadPlaylistRow(nextPlaylistRow(), downbeatNs);
   }
-  energy /= static_cast<float>(sampleCount);
+  return true;
+}
 
-  const float threshold = static_cast<float>(m_autoBeatThresholdSpin->value());
-  const bool high = energy >= threshold;
-  if (high && !m_lastBeatHigh) {
-    ++m_beatsSinceSwitch;
-    if (m_beatsSinceSwitch >= m_autoBeatCountSpin->value()) {
-      playNextPlaylistItem();
-    }
+void MainWindow::onOnsetDetected(qint64 captureTimeNs, float strength) {
+  Q_UNUSED(captureTimeNs);
+  Q_UNUSED(strength);
+  if (!m_playlistPlaying || m_autoAdvanceModeCombo->currentIndex() != 2 || scheduleBeatSwitch()) {
+    return;
   }
 
-  if (high) {
-    m_lastBeatHigh = true;
-  } else if (energy < threshold * 0.6f) {
-    m_lastBeatHigh = false;
+  ++m_beatsSinceSwitch;
+  if (m_beatsSinceSwitch >= m_autoBeatCountSpin->value()) {
+    playNextPlaylistItem();
   }
 }
 
@@ -1187,6 +1553,7 @@ void MainWindow::applyNowPlayingMetadata() {
     setStatus(QStringLiteral("Failed to persist now playing metadata."));
     return;
   }
+  m_presetFeatureIndexDirty = true;
 
   setStatus(QStringLiteral("Updated metadata for now playing preset."));
 }
@@ -1288,10 +1655,35 @@ void MainWindow::bindAudioSource(AudioSource *audioSource) {
 
   m_audioSource = audioSource;
   m_audioSource->setSelectedDeviceId(m_preferredAudioDeviceId);
+  m_audioSource->setRequestedLatencyFrames(m_preferredAudioLatencyFrames);
+  m_audioSource->setMixInputs(parseAudioInputList(m_preferredMixInputs));
+  if (auto *fileSource = qobject_cast<FileAudioSource *>(m_audioSource)) {
+    fileSource->setTracks(m_audioFileTracks);
+    fileSource->setSelectedDeviceId(m_preferredAudioDeviceId);
+    fileSource->setPlayout(m_audioFilePlayoutCheck != nullptr && m_audioFilePlayoutCheck->isChecked());
+  }
+  if (m_captureHistorySpin != nullptr) {
+    m_audioSource->setCaptureHistorySeconds(m_captureHistorySpin->value());
+  }
+  if (m_silenceFloorSpin != nullptr) {
+    m_audioSource->setSilenceFloor(dbfsToAmplitude(m_silenceFloorSpin->value()));
+  }
+  m_audioSourceBoundNs = monotonicTimeNs();
   connect(m_audioSource, &AudioSource::pcmFrameReady, m_projectMEngine, &ProjectMEngine::submitAudioFrame);
-  connect(m_audioSource, &AudioSource::pcmFrameReady, this, &MainWindow::onAudioFrameForPlayback);
+  connect(m_audioSource, &AudioSource::pcmFrameReady, this, &MainWindow::updateRenderIdleState);
+  connect(m_audioSource, &AudioSource::pcmFrameReady, m_onsetAnalyzer, &OnsetAnalyzer::submitAudioFrame);
   connect(m_audioSource, &AudioSource::statusMessage, this, &MainWindow::setStatus);
   connect(m_audioSource, &AudioSource::errorMessage, this, &MainWindow::onAudioSourceError);
+  connect(m_audioSource, &AudioSource::devicesChanged, this, &MainWindow::refreshAudioDeviceList);
+  connect(m_audioSource, &AudioSource::defaultDeviceChanged, this, &MainWindow::refreshAudioDeviceList);
+  connect(m_audioSource, &AudioSource::deviceAdded, this, [this](const AudioDeviceInfo &device) {
+    setStatus(QStringLiteral("Audio device added: %1").arg(device.name));
+  });
+  connect(m_audioSource, &AudioSource::deviceRemoved, this, [this](const QString &deviceId) {
+    if (deviceId == m_preferredAudioDeviceId) {
+      setStatus(QStringLiteral("Selected audio device was removed: %1").arg(deviceId));
+    }
+  });
 }
 
 void MainWindow::replaceAudioSource(AudioSource *audioSource) {
@@ -1322,6 +1714,105 @@ void MainWindow::updateAudioDeviceDebugPanel(const QVector<AudioDeviceInfo> &dev
       m_preferredAudioDeviceId.isEmpty() ? QStringLiteral("<default>") : m_preferredAudioDeviceId;
   lines << QStringLiteral("Backend: %1").arg(backend);
   lines << QStringLiteral("Selected device id: %1").arg(selectedId);
+  const QString defaultId = (m_audioSource != nullptr) ? m_audioSource->defaultDeviceId() : QString();
+  lines << QStringLiteral("Default sink: %1").arg(defaultId.isEmpty() ? QStringLiteral("<unknown>") : defaultId);
+  if (m_audioSource != nullptr) {
+    const AudioLatencyInfo latency = m_audioSource->latencyInfo();
+    lines << QStringLiteral("Requested quantum: %1")
+                 .arg(latency.requestedFrames > 0 ? QString::number(latency.requestedFrames)
+                                                  : QStringLiteral("<graph default>"));
+    if (latency.quantumFrames > 0 && latency.sampleRate > 0) {
+      lines << QStringLiteral("Negotiated quantum: %1 frames @ %2 Hz (%3 ms)")
+                   .arg(latency.quantumFrames)
+                   .arg(latency.sampleRate)
+                   .arg(latency.quantumFrames * 1000.0 / latency.sampleRate, 0, 'f', 2);
+      lines << QStringLiteral("Graph delay: %1 ms").arg(latency.graphDelayMs, 0, 'f', 2);
+    }
+    const AudioCaptureStats stats = m_audioSource->captureStats();
+    lines << QStringLiteral("Capture: %1 callbacks, %2 frames, %3 empty, %4 short, %5 stride mismatches")
+                 .arg(stats.callbacks)
+                 .arg(stats.capturedFrames)
+                 .arg(stats.emptyBuffers)
+                 .arg(stats.shortChunks)
+                 .arg(stats.strideMismatches);
+    const double queueDepthMs =
+        latency.sampleRate > 0 ? stats.maxQueueDepthFrames * 1000.0 / latency.sampleRate : 0.0;
+    lines << QStringLiteral("Drops: %1 xruns, %2 frames overwritten before drain, max queue %3 frames (%4 ms)")
+                 .arg(stats.xruns)
+                 .arg(stats.consumerDrops)
+                 .arg(stats.maxQueueDepthFrames)
+                 .arg(queueDepthMs, 0, 'f', 1);
+    if (stats.reconnects > 0) {
+      lines << QStringLiteral("Reconnects: %1, last outage %2 ms")
+                   .arg(stats.reconnects)
+                   .arg(stats.lastReconnectMs, 0, 'f', 0);
+    }
+    if (latency.targetDelayMs > 0.0) {
+      lines << QStringLiteral("Jitter buffer: target %1 ms, network jitter %2 ms, %3 late packets, "
+                              "%4 frames concealed, %5 skipped")
+                   .arg(latency.targetDelayMs, 0, 'f', 1)
+                   .arg(latency.jitterMs, 0, 'f', 2)
+                   .arg(stats.latePackets)
+                   .arg(stats.concealedFrames)
+                   .arg(stats.skippedFrames);
+    }
+    if (rtSafetyChecksEnabled()) {
+      const RtSafetyCounts rt = rtSafetyCounts();
+      lines << QStringLiteral("RT checks: %1 allocations, %2 frees, %3 mutex locks (%4 try-locks) on the process thread")
+                   .arg(rt.allocations)
+                   .arg(rt.frees)
+                   .arg(rt.mutexLocks)
+                   .arg(rt.mutexTryLocks);
+    }
+    for (const ThreadPlacementReport &thread : threadPlacementReports()) {
+      lines << QStringLiteral("Thread %1 (%2, tid %3): CPUs %4, %5%6, nice %7%8")
+                   .arg(thread.name, threadRoleName(thread.role))
+                   .arg(thread.tid)
+                   .arg(thread.cpus.isEmpty() ? QStringLiteral("?") : thread.cpus, thread.policy)
+                   .arg(thread.priority > 0 ? QStringLiteral(" %1").arg(thread.priority) : QString())
+                   .arg(thread.nice)
+                   .arg(thread.note.isEmpty() ? QString() : QStringLiteral(" [%1]").arg(thread.note));
+    }
+    const QVector<AudioInputStats> inputs = m_audioSource->inputStats();
+    for (int i = 0; inputs.size() > 1 && i < inputs.size(); ++i) {
+      const AudioInputStats &input = inputs.at(i);
+      const auto dbfs = [](float level) {
+        return level > 0.0f ? QString::number(20.0 * std::log10(level), 'f', 1) : QStringLiteral("-inf");
+      };
+      lines << QStringLiteral("Input %1: %2 (gain %3, %4)")
+                   .arg(i + 1)
+                   .arg(input.deviceId.isEmpty() ? QStringLiteral("<default>") : input.deviceId)
+                   .arg(input.gain, 0, 'f', 2)
+                   .arg(input.active ? QStringLiteral("streaming") : QStringLiteral("idle"));
+      lines << QStringLiteral("   level: %1 dBFS peak, %2 dBFS RMS, offset %3 ms")
+                   .arg(dbfs(input.peak), dbfs(input.rms))
+                   .arg(input.offsetMs, 0, 'f', 2);
+      lines << QStringLiteral("   xruns: %1, aligned away: %2 frames, overrun: %3 frames")
+                   .arg(input.xruns)
+                   .arg(input.alignedFrames)
+                   .arg(input.droppedFrames);
+    }
+  }
+  if (m_visualizerWidget != nullptr) {
+    lines << QStringLiteral("Audio-to-photon: %1 ms").arg(m_visualizerWidget->audioToPhotonMs(), 0, 'f', 1);
+  }
+  const TempoEstimate tempo = m_onsetAnalyzer->tempo();
+  if (tempo.isValid()) {
+    const qint64 nowNs = monotonicTimeNs();
+    lines << QStringLiteral("Tempo: %1 BPM (confidence %2), next beat in %3 ms, next downbeat in %4 ms")
+                 .arg(tempo.bpm, 0, 'f', 1)
+                 .arg(tempo.confidence, 0, 'f', 2)
+                 .arg((tempo.nextBeatNs(nowNs) - nowNs) / 1000000)
+                 .arg((tempo.nextDownbeatNs(nowNs) - nowNs) / 1000000);
+  }
+  const AudioFeatures features = m_onsetAnalyzer->features();
+  if (features.valid) {
+    lines << QStringLiteral("Audio features: energy %1, brightness %2, onset density %3, tempo %4")
+                 .arg(features.values[AudioFeatures::Energy], 0, 'f', 2)
+                 .arg(features.values[AudioFeatures::Brightness], 0, 'f', 2)
+                 .arg(features.values[AudioFeatures::OnsetDensity], 0, 'f', 2)
+                 .arg(features.values[AudioFeatures::Tempo], 0, 'f', 2);
+  }
   if (m_upscalePresetCombo != nullptr) {
     lines << QStringLiteral("Upscaler preset: %1").arg(m_upscalePresetCombo->currentText());
   }
@@ -1364,8 +1855,8 @@ bool MainWindow::startCurrentAudioSourceWithFallback() {
     return true;
   }
 
-  setStatus(QStringLiteral("PipeWire unavailable, falling back to dummy audio backend."));
-  replaceAudioSource(new DummyAudioSource(this));
+  setStatus(QStringLiteral("%1 unavailable, falling back to the signal generator.").arg(m_audioSource->backendName()));
+  replaceAudioSource(new SignalGeneratorAudioSource(this));
   if (m_audioSource != nullptr && m_audioSource->start()) {
     m_audioFallbackApplied = true;
     updateAudioBackendIndicator();
@@ -1389,6 +1880,7 @@ void MainWindow::refreshAudioDeviceList() {
 
   if (m_audioSource != nullptr) {
     devices = m_audioSource->availableDevices();
+    const QString defaultId = m_audioSource->defaultDeviceId();
     for (const AudioDeviceInfo &device : devices) {
       const QString name = device.name.isEmpty() ? QStringLiteral("Unnamed Device") : device.name;
       m_audioDeviceCombo->addItem(name, device.id);
@@ -1396,6 +1888,9 @@ void MainWindow::refreshAudioDeviceList() {
         const int idx = m_audioDeviceCombo->count() - 1;
         m_audioDeviceCombo->setItemData(idx, device.description, Qt::ToolTipRole);
       }
+      if (!defaultId.isEmpty() && device.id == defaultId) {
+        m_audioDeviceCombo->setItemText(0, QStringLiteral("Default (%1)").arg(name));
+      }
     }
   }
 
@@ -1431,7 +1926,13 @@ void MainWindow::applySelectedAudioDevice() {
     return;
   }
 
-  replaceAudioSource(createAudioSource(this));
+  if (m_audioSource->retargetDevice(m_preferredAudioDeviceId)) {
+    updateAudioDeviceDebugPanel(m_audioSource->availableDevices());
+    setStatus(QStringLiteral("Switching audio input device: %1").arg(m_audioDeviceCombo->currentText()));
+    return;
+  }
+
+  replaceAudioSource(createAudioSource(this, m_audioBackendCombo->currentData().toString()));
   if (!startCurrentAudioSourceWithFallback()) {
     setStatus(QStringLiteral("Failed to apply audio device; backend restart failed."));
     return;
@@ -1444,6 +1945,221 @@ void MainWindow::applySelectedAudioDevice() {
   }
 }
 
+void MainWindow::applySelectedAudioLatency() {
+  if (m_audioLatencyCombo == nullptr) {
+    return;
+  }
+
+  const int frames = m_audioLatencyCombo->currentData().toInt();
+  if (frames == m_preferredAudioLatencyFrames) {
+    return;
+  }
+  m_preferredAudioLatencyFrames = frames;
+
+  QVariantMap settings = m_settingsManager->loadProjectMSettings();
+  settings.insert(QStringLiteral("audioLatencyFrames"), m_preferredAudioLatencyFrames);
+  m_settingsManager->saveProjectMSettings(settings);
+
+  if (m_audioSource != nullptr) {
+    m_audioSource->setRequestedLatencyFrames(m_preferredAudioLatencyFrames);
+  }
+  setStatus(QStringLiteral("Requested capture latency: %1").arg(m_audioLatencyCombo->currentText()));
+}
+
+void MainWindow::applySelectedAudioBackend() {
+  const QString backend = m_audioBackendCombo->currentData().toString();
+  QVariantMap settings = m_settingsManager->loadProjectMSettings();
+  settings.insert(QStringLiteral("audioBackend"), backend);
+  m_settingsManager->saveProjectMSettings(settings);
+
+  replaceAudioSource(createAudioSource(this, backend));
+  startCurrentAudioSourceWithFallback();
+  updateAudioBackendIndicator();
+}
+
+void MainWindow::applyMixInputs() {
+  if (m_mixInputsEdit == nullptr) {
+    return;
+  }
+
+  const QString text = m_mixInputsEdit->text().trimmed();
+  if (text == m_preferredMixInputs) {
+    return;
+  }
+  m_preferredMixInputs = text;
+
+  QVariantMap settings = m_settingsManager->loadProjectMSettings();
+  settings.insert(QStringLiteral("audioMixInputs"), m_preferredMixInputs);
+  m_settingsManager->saveProjectMSettings(settings);
+
+  const QVector<AudioInputConfig> inputs = parseAudioInputList(m_preferredMixInputs);
+  if (m_audioSource != nullptr) {
+    m_audioSource->setMixInputs(inputs);
+  }
+  setStatus(inputs.isEmpty() ? QStringLiteral("Capturing the selected audio input only.")
+                             : QStringLiteral("Mixing %1 audio inputs.").arg(inputs.size()));
+}
+
+void MainWindow::openAudioFiles() {
+  const QStringList filePaths = QFileDialog::getOpenFileNames(
+      this,
+      QStringLiteral("Open audio files"),
+      m_audioFileTracks.isEmpty() ? QString() : QFileInfo(m_audioFileTracks.constFirst()).absolutePath(),
+      QStringLiteral("Audio files (*.flac *.ogg *.oga *.opus *.mp3 *.wav);;All files (*)"));
+  if (filePaths.isEmpty()) {
+    return;
+  }
+  m_audioFileTracks = filePaths;
+
+  QVariantMap settings = m_settingsManager->loadProjectMSettings();
+  settings.insert(QStringLiteral("audioFileTracks"), m_audioFileTracks);
+  m_settingsManager->saveProjectMSettings(settings);
+
+  auto *fileSource = qobject_cast<FileAudioSource *>(m_audioSource);
+  if (fileSource != nullptr && fileSource->isRunning()) {
+    fileSource->setTracks(m_audioFileTracks);
+    fileSource->retargetDevice(m_audioFileTracks.constFirst());
+  } else {
+    const QSignalBlocker blocker(m_audioBackendCombo);
+    m_audioBackendCombo->setCurrentIndex(qMax(0, m_audioBackendCombo->findData(QStringLiteral("file"))));
+    applySelectedAudioBackend();
+  }
+  setStatus(QStringLiteral("Playing %1 audio file(s).").arg(m_audioFileTracks.size()));
+}
+
+void MainWindow::applyAudioFilePlayout() {
+  QVariantMap settings = m_settingsManager->loadProjectMSettings();
+  settings.insert(QStringLiteral("audioFilePlayout"), m_audioFilePlayoutCheck->isChecked());
+  m_settingsManager->saveProjectMSettings(settings);
+
+  // The output stage is chosen at start, so a running file source restarts.
+  auto *fileSource = qobject_cast<FileAudioSource *>(m_audioSource);
+  if (fileSource != nullptr && fileSource->isRunning()) {
+    fileSource->stop();
+    fileSource->setPlayout(m_audioFilePlayoutCheck->isChecked());
+    startCurrentAudioSourceWithFallback();
+  }
+}
+
+void MainWindow::seekAudioFile() {
+  if (auto *fileSource = qobject_cast<FileAudioSource *>(m_audioSource)) {
+    fileSource->seek(m_audioFilePositionSlider->value());
+  }
+}
+
+void MainWindow::updateAudioFilePosition() {
+  if (m_audioFilePositionSlider == nullptr || m_audioFilePositionSlider->isSliderDown()) {
+    return;
+  }
+
+  const auto *fileSource = qobject_cast<const FileAudioSource *>(m_audioSource);
+  const bool active = fileSource != nullptr && fileSource->isRunning();
+  m_audioFilePositionSlider->setEnabled(active);
+  if (!active) {
+    m_audioFilePositionSlider->setValue(0);
+    m_audioFilePositionLabel->setText(QStringLiteral("--:-- / --:--"));
+    return;
+  }
+
+  const int position = static_cast<int>(fileSource->positionSeconds());
+  const int duration = static_cast<int>(fileSource->durationSeconds());
+  m_audioFilePositionSlider->setRange(0, qMax(0, duration));
+  m_audioFilePositionSlider->setValue(position);
+  const auto clock = [](int seconds) {
+    return QStringLiteral("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QLatin1Char('0'));
+  };
+  m_audioFilePositionLabel->setText(QStringLiteral("%1 / %2").arg(clock(position), clock(duration)));
+}
+
+void MainWindow::updateLevelMeter() {
+  if (m_levelMeter == nullptr || !m_levelMeter->isVisible()) {
+    return;
+  }
+
+  constexpr int64_t kStaleLevelsNs = 500000000LL;
+  AudioLevels levels = m_audioSource != nullptr ? m_audioSource->levels() : AudioLevels{};
+  if (monotonicTimeNs() - levels.updatedNs > kStaleLevelsNs) {
+    levels = AudioLevels{};
+  }
+  m_levelMeter->setLevels(levels);
+  m_levelMeter->setMarker(static_cast<float>(m_onsetGateSpin->value()));
+}
+
+// Runs per delivered block so rendering resumes on the first loud block, and
+// from the status timer so a source that stops delivering still goes idle.
+void MainWindow::updateRenderIdleState() {
+  if (m_visualizerWidget == nullptr || m_silenceHoldSpin == nullptr) {
+    return;
+  }
+
+  const qint64 lastSignalNs = m_audioSource != nullptr
+                                 ? qMax<qint64>(m_audioSource->levels().lastSignalNs, m_audioSourceBoundNs)
+                                 : m_audioSourceBoundNs;
+  const bool idle = monotonicTimeNs() - lastSignalNs > m_silenceHoldSpin->value() * 1000000000LL;
+  if (idle == m_renderIdle) {
+    return;
+  }
+
+  m_renderIdle = idle;
+  m_visualizerWidget->setIdleRendering(idle);
+  if (!idle) {
+    setStatus(QStringLiteral("Input signal returned; rendering at full rate."));
+  } else if (m_idleFpsSpin->value() > 0) {
+    setStatus(QStringLiteral("Input silent; rendering at %1 fps.").arg(m_idleFpsSpin->value()));
+  } else {
+    setStatus(QStringLiteral("Input silent; holding the last frame."));
+  }
+}
+
+void MainWindow::applyThreadPlacementSettings() {
+  QVariantMap settings = m_settingsManager->loadProjectMSettings();
+  settings.insert(QStringLiteral("captureThreadPlacement"), m_captureThreadsEdit->text().trimmed());
+  settings.insert(QStringLiteral("renderThreadPlacement"), m_renderThreadEdit->text().trimmed());
+  settings.insert(QStringLiteral("workerThreadPlacement"), m_workerThreadsEdit->text().trimmed());
+  m_settingsManager->saveProjectMSettings(settings);
+  applyThreadPlacementPolicies();
+}
+
+void MainWindow::applyThreadPlacementPolicies() {
+  const std::pair<ThreadRole, QLineEdit *> roles[] = {{ThreadRole::Capture, m_captureThreadsEdit},
+                                                      {ThreadRole::Render, m_renderThreadEdit},
+                                                      {ThreadRole::Worker, m_workerThreadsEdit}};
+  for (const auto &[role, edit] : roles) {
+    // Environment overrides win over the saved setting for this launch.
+    const QString environmentSpec = threadPlacementOverride(role);
+    const QString spec = environmentSpec.isEmpty() ? edit->text().trimmed() : environmentSpec;
+    ThreadPlacementPolicy policy;
+    QString error;
+    if (!parseThreadPlacement(spec, &policy, &error)) {
+      setStatus(QStringLiteral("Ignoring %1 thread placement: %2").arg(threadRoleName(role), error));
+      continue;
+    }
+    setThreadPlacementPolicy(role, policy);
+  }
+}
+
+void MainWindow::saveCaptureHistory() {
+  if (m_audioSource == nullptr) {
+    return;
+  }
+
+  const QString defaultName =
+      QDir::homePath() + QStringLiteral("/qt6mplayer-capture-%1.wav")
+                             .arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss")));
+  const QString filePath = QFileDialog::getSaveFileName(
+      this, QStringLiteral("Save Capture History"), defaultName, QStringLiteral("WAV audio (*.wav)"));
+  if (filePath.isEmpty()) {
+    return;
+  }
+
+  QString error;
+  if (!m_audioSource->saveCaptureHistory(filePath, &error)) {
+    setStatus(QStringLiteral("Could not save capture history: %1").arg(error));
+    return;
+  }
+  setStatus(QStringLiteral("Saved capture history to %1 (replay it with the Capture replay backend).").arg(filePath));
+}
+
 void MainWindow::updateAudioBackendIndicator() {
   if (m_audioBackendLabel == nullptr) {
     return;
@@ -1455,6 +2171,15 @@ void MainWindow::updateAudioBackendIndicator() {
   }
 
   const QString state = m_audioSource->isRunning() ? QStringLiteral("running") : QStringLiteral("stopped");
+  const AudioLatencyInfo latency = m_audioSource->latencyInfo();
+  if (latency.quantumFrames > 0 && latency.sampleRate > 0) {
+    m_audioBackendLabel->setText(QStringLiteral("Audio: %1 (%2, %3/%4, %5 ms)")
+                                     .arg(m_audioSource->backendName(), state)
+                                     .arg(latency.quantumFrames)
+                                     .arg(latency.sampleRate)
+                                     .arg(latency.graphDelayMs, 0, 'f', 1));
+    return;
+  }
   m_audioBackendLabel->setText(
       QStringLiteral("Audio: %1 (%2)").arg(m_audioSource->backendName(), state));
 }
@@ -1476,16 +2201,18 @@ void MainWindow::onAudioSourceError(const QString &message) {
     return;
   }
 
-  if (m_audioSource->backendName() != QStringLiteral("PipeWire") || m_audioSource->isRunning()) {
+  const QString failedBackend = m_audioSource->backendName();
+  const bool liveBackend = failedBackend == QStringLiteral("PipeWire") || failedBackend == QStringLiteral("JACK");
+  if (!liveBackend || m_audioSource->isRunning()) {
     return;
   }
 
   m_audioFallbackApplied = true;
-  replaceAudioSource(new DummyAudioSource(this));
+  replaceAudioSource(new SignalGeneratorAudioSource(this));
   if (m_audioSource != nullptr && m_audioSource->start()) {
-    setStatus(QStringLiteral("PipeWire failed; switched to dummy audio backend."));
+    setStatus(QStringLiteral("%1 failed; switched to the signal generator.").arg(failedBackend));
   } else {
-    setStatus(QStringLiteral("Audio backend failed and dummy fallback could not start."));
+    setStatus(QStringLiteral("Audio backend failed and the signal generator fallback could not start."));
   }
   updateAudioBackendIndicator();
   refreshAudioDeviceList();
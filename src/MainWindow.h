@@ -1,12 +1,16 @@
 #pragma once
 
+#include "PresetFeatureIndex.h"
 #include "PresetMetadata.h"
 
 #include <QElapsedTimer>
 #include <QMainWindow>
+#include <QStringList>
 
 class AudioSource;
 struct AudioDeviceInfo;
+class LevelMeterWidget;
+class OnsetAnalyzer;
 class PlaylistModel;
 class PresetFilterProxyModel;
 class PresetLibraryModel;
@@ -20,6 +24,7 @@ class QLineEdit;
 class QModelIndex;
 class QPlainTextEdit;
 class QPushButton;
+class QSlider;
 class QSpinBox;
 class QTableView;
 class QTimer;
@@ -55,7 +60,7 @@ private Q_SLOTS:
   void playNextPlaylistItem();
   void playPreviousPlaylistItem();
   void onPlaybackTimerTick();
-  void onAudioFrameForPlayback(const QVector<float> &monoFrame);
+  void onOnsetDetected(qint64 captureTimeNs, float strength);
   void onPresetActivated(const QString &presetPath);
   void applyNowPlayingMetadata();
   void togglePreviewFloating();
@@ -63,6 +68,14 @@ private Q_SLOTS:
 
   void refreshAudioDeviceList();
   void applySelectedAudioDevice();
+  void applySelectedAudioBackend();
+  void applySelectedAudioLatency();
+  void applyMixInputs();
+  void applyThreadPlacementSettings();
+  void openAudioFiles();
+  void applyAudioFilePlayout();
+  void seekAudioFile();
+  void saveCaptureHistory();
   void onAudioSourceError(const QString &message);
   void onProjectMStatusMessage(const QString &message);
   void setStatus(const QString &message);
@@ -73,7 +86,11 @@ private:
   void updateAudioDeviceDebugPanel(const QVector<AudioDeviceInfo> &devices);
   void updateAudioBackendIndicator();
   void updateRenderBackendIndicator();
+  void updateAudioFilePosition();
+  void updateLevelMeter();
+  void updateRenderIdleState();
   bool startCurrentAudioSourceWithFallback();
+  void applyThreadPlacementPolicies();
   void buildUi();
   void wireSignals();
   void loadInitialState();
@@ -81,7 +98,15 @@ private:
   void updatePresetDirectory(const QString &path);
   QModelIndex selectedPresetSourceIndex() const;
   void playNextPresetInBrowser();
-  bool loadPlaylistRow(int row);
+  int nextPlaylistRow();
+  int matchedPlaylistRow(int currentRow);
+  void learnPresetFeatures();
+  void flushLearnedFeatures();
+  void saveLearnedFeatures();
+  void refreshPresetFeatureIndex();
+  // audioTimeNs > 0 defers the switch to that capture time (see ProjectMEngine::loadPresetAt).
+  bool loadPlaylistRow(int row, qint64 audioTimeNs = 0);
+  bool scheduleBeatSwitch();
   void updateNowPlayingPanel(const QString &presetPath);
   PresetMetadata currentNowPlayingMetadata() const;
 
@@ -90,6 +115,7 @@ private:
   PresetFilterProxyModel *m_presetProxyModel = nullptr;
   SettingsManager *m_settingsManager = nullptr;
   ProjectMEngine *m_projectMEngine = nullptr;
+  OnsetAnalyzer *m_onsetAnalyzer = nullptr;
   AudioSource *m_audioSource = nullptr;
 
   QLineEdit *m_presetSearchEdit = nullptr;
@@ -104,21 +130,36 @@ private:
   QSpinBox *m_nowPlayingRatingSpin = nullptr;
   QCheckBox *m_nowPlayingFavoriteCheck = nullptr;
   QLineEdit *m_nowPlayingTagsEdit = nullptr;
+  QComboBox *m_audioBackendCombo = nullptr;
   QComboBox *m_audioDeviceCombo = nullptr;
   QPushButton *m_refreshAudioDevicesButton = nullptr;
+  LevelMeterWidget *m_levelMeter = nullptr;
+  QComboBox *m_audioLatencyCombo = nullptr;
+  QLineEdit *m_mixInputsEdit = nullptr;
+  QLineEdit *m_captureThreadsEdit = nullptr;
+  QLineEdit *m_renderThreadEdit = nullptr;
+  QLineEdit *m_workerThreadsEdit = nullptr;
+  QSpinBox *m_captureHistorySpin = nullptr;
+  QPushButton *m_saveCaptureButton = nullptr;
+  QPushButton *m_openAudioFilesButton = nullptr;
+  QCheckBox *m_audioFilePlayoutCheck = nullptr;
+  QSlider *m_audioFilePositionSlider = nullptr;
+  QLabel *m_audioFilePositionLabel = nullptr;
   QPlainTextEdit *m_audioDeviceDebugText = nullptr;
   QLabel *m_audioBackendLabel = nullptr;
   QLabel *m_renderBackendLabel = nullptr;
 
   QCheckBox *m_shuffleCheck = nullptr;
+  QCheckBox *m_matchAudioCheck = nullptr;
   QComboBox *m_autoAdvanceModeCombo = nullptr;
   QSpinBox *m_autoDurationSecondsSpin = nullptr;
   QSpinBox *m_autoBeatCountSpin = nullptr;
-  QDoubleSpinBox *m_autoBeatThresholdSpin = nullptr;
+  QDoubleSpinBox *m_onsetGateSpin = nullptr;
   QPushButton *m_playPauseButton = nullptr;
   QPushButton *m_previewFloatButton = nullptr;
   QPushButton *m_previewFullscreenButton = nullptr;
   QCheckBox *m_showFpsCheck = nullptr;
+  QCheckBox *m_previewMonoDownmixCheck = nullptr;
 
   VisualizerWidget *m_visualizerWidget = nullptr;
   QWidget *m_visualizerContainer = nullptr;
@@ -127,18 +168,35 @@ private:
   QSpinBox *m_meshXSpin = nullptr;
   QSpinBox *m_meshYSpin = nullptr;
   QSpinBox *m_targetFpsSpin = nullptr;
+  QSpinBox *m_silenceFloorSpin = nullptr;
+  QSpinBox *m_silenceHoldSpin = nullptr;
+  QSpinBox *m_idleFpsSpin = nullptr;
   QDoubleSpinBox *m_beatSensitivitySpin = nullptr;
   QCheckBox *m_hardCutEnabledCheck = nullptr;
   QSpinBox *m_hardCutDurationSpin = nullptr;
+  QSpinBox *m_analysisBlockSpin = nullptr;
+  QSpinBox *m_analysisHopSpin = nullptr;
   QComboBox *m_upscalePresetCombo = nullptr;
   QSpinBox *m_renderScaleSpin = nullptr;
   QDoubleSpinBox *m_upscaleSharpnessSpin = nullptr;
   QComboBox *m_gpuPreferenceCombo = nullptr;
 
   QTimer *m_playbackTimer = nullptr;
+  QTimer *m_audioStatusTimer = nullptr;
+  QTimer *m_levelMeterTimer = nullptr;
+  QTimer *m_learnedFeaturesSaveTimer = nullptr;
   QElapsedTimer m_trackElapsed;
   int m_beatsSinceSwitch = 0;
-  bool m_lastBeatHigh = false;
+  qint64 m_switchAudioTimeNs = 0;
+  PresetFeatureIndex m_presetFeatureIndex;
+  bool m_presetFeatureIndexDirty = true;
+  QString m_learningPresetPath;
+  std::array<float, AudioFeatures::AxisCount> m_learnedFeatureSums = {};
+  int m_learnedFeatureSeconds = 0;
+  // Folded into the model already; written to the metadata file in batches.
+  QVector<LearnedFeatures> m_pendingLearnedFeatures;
+  qint64 m_audioSourceBoundNs = 0;
+  bool m_renderIdle = false;
   bool m_playlistPlaying = false;
   bool m_syncingNowPlayingUi = false;
   QString m_currentPresetPath;
@@ -148,5 +206,8 @@ private:
   bool m_syncingAudioDeviceUi = false;
   bool m_syncingUpscalerPresetUi = false;
   QString m_preferredAudioDeviceId;
+  int m_preferredAudioLatencyFrames = 0;
+  QString m_preferredMixInputs;
+  QStringList m_audioFileTracks;
   QString m_appliedGpuPreference;
 };
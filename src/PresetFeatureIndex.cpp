@@ -0,0 +1,146 @@
+#include "PresetFeatureIndex.h"
+
+#include <QLatin1String>
+
+#include <algorithm>
+
+namespace {
+// A few songs' worth of listening before a learned descriptor beats the tags.
+constexpr int kMinLearnedSeconds = 10;
+// Charged for each axis a descriptor leaves open, about an average mismatch.
+constexpr float kUnknownAxisDistance = 0.25f;
+constexpr int kMaxResults = 16;
+
+struct TagHint {
+  const char *tag;
+  AudioFeatures::Axis axis;
+  float value;
+};
+
+constexpr TagHint kTagHints[] = {
+    {"quiet", AudioFeatures::Energy, 0.15f},     {"ambient", AudioFeatures::Energy, 0.15f},
+    {"ambient", AudioFeatures::OnsetDensity, 0.1f}, {"calm", AudioFeatures::Energy, 0.25f},
+    {"chill", AudioFeatures::Energy, 0.3f},      {"energetic", AudioFeatures::Energy, 0.8f},
+    {"intense", AudioFeatures::Energy, 0.9f},    {"aggressive", AudioFeatures::Energy, 0.9f},
+    {"loud", AudioFeatures::Energy, 0.9f},       {"dark", AudioFeatures::Brightness, 0.2f},
+    {"warm", AudioFeatures::Brightness, 0.35f},  {"bright", AudioFeatures::Brightness, 0.8f},
+    {"sparse", AudioFeatures::OnsetDensity, 0.15f}, {"busy", AudioFeatures::OnsetDensity, 0.75f},
+    {"glitchy", AudioFeatures::OnsetDensity, 0.9f}, {"slow", AudioFeatures::Tempo, 0.3f},
+    {"fast", AudioFeatures::Tempo, 0.9f},
+};
+
+bool describe(const PresetMetadata &metadata, float *values, float *known) {
+  if (metadata.learnedSeconds >= kMinLearnedSeconds) {
+    for (int axis = 0; axis < AudioFeatures::AxisCount; ++axis) {
+      values[axis] = metadata.learnedFeatures[axis];
+      known[axis] = 1.0f;
+    }
+    return true;
+  }
+
+  float sums[AudioFeatures::AxisCount] = {};
+  int counts[AudioFeatures::AxisCount] = {};
+  for (const QString &tag : metadata.tags) {
+    for (const TagHint &hint : kTagHints) {
+      if (tag.compare(QLatin1String(hint.tag), Qt::CaseInsensitive) == 0) {
+        sums[hint.axis] += hint.value;
+        ++counts[hint.axis];
+      }
+    }
+  }
+
+  bool described = false;
+  for (int axis = 0; axis < AudioFeatures::AxisCount; ++axis) {
+    values[axis] = counts[axis] > 0 ? sums[axis] / static_cast<float>(counts[axis]) : 0.0f;
+    known[axis] = counts[axis] > 0 ? 1.0f : 0.0f;
+    described = described || counts[axis] > 0;
+  }
+  return described;
+}
+} // namespace
+
+void PresetFeatureIndex::rebuild(const QVector<PlaylistItem> &items, const QHash<QString, PresetMetadata> &metadata) {
+  m_rows.clear();
+  m_values.clear();
+  m_known.clear();
+  m_rows.reserve(items.size());
+  m_values.reserve(static_cast<size_t>(items.size()) * kAxes);
+  m_known.reserve(static_cast<size_t>(items.size()) * kAxes);
+
+  for (int row = 0; row < items.size(); ++row) {
+    const auto found = metadata.constFind(items.at(row).presetPath);
+    if (found == metadata.constEnd()) {
+      continue;
+    }
+    float values[kAxes];
+    float known[kAxes];
+    if (!describe(*found, values, known)) {
+      continue;
+    }
+    m_rows.push_back(row);
+    m_values.insert(m_values.end(), values, values + kAxes);
+    m_known.insert(m_known.end(), known, known + kAxes);
+  }
+}
+
+void PresetFeatureIndex::updatePreset(const QVector<PlaylistItem> &items,
+                                      const QString &presetPath,
+                                      const PresetMetadata &metadata) {
+  float values[kAxes];
+  float known[kAxes];
+  const bool described = describe(metadata, values, known);
+  for (int row = 0; row < items.size(); ++row) {
+    if (items.at(row).presetPath != presetPath) {
+      continue;
+    }
+    const auto slot = std::lower_bound(m_rows.begin(), m_rows.end(), row);
+    const auto offset = (slot - m_rows.begin()) * kAxes;
+    const bool indexed = slot != m_rows.end() && *slot == row;
+    if (indexed && described) {
+      std::copy(values, values + kAxes, m_values.begin() + offset);
+      std::copy(known, known + kAxes, m_known.begin() + offset);
+    } else if (indexed) {
+      m_rows.erase(slot);
+      m_values.erase(m_values.begin() + offset, m_values.begin() + offset + kAxes);
+      m_known.erase(m_known.begin() + offset, m_known.begin() + offset + kAxes);
+    } else if (described) {
+      m_rows.insert(slot, row);
+      m_values.insert(m_values.begin() + offset, values, values + kAxes);
+      m_known.insert(m_known.begin() + offset, known, known + kAxes);
+    }
+  }
+}
+
+int PresetFeatureIndex::size() const { return static_cast<int>(m_rows.size()); }
+
+QVector<int> PresetFeatureIndex::nearestRows(const AudioFeatures &features, int maxRows, int excludeRow) const {
+  const int wanted = std::clamp(maxRows, 0, kMaxResults);
+  float bestDistance[kMaxResults];
+  int bestRow[kMaxResults];
+  int found = 0;
+
+  constexpr float unknownPenalty = kUnknownAxisDistance * kUnknownAxisDistance;
+  const float *values = m_values.data();
+  const float *known = m_known.data();
+  for (size_t i = 0; i < m_rows.size(); ++i, values += kAxes, known += kAxes) {
+    float distance = 0.0f;
+    for (int axis = 0; axis < kAxes; ++axis) {
+      const float delta = values[axis] - features.values[axis];
+      distance += known[axis] * delta * delta + (1.0f - known[axis]) * unknownPenalty;
+    }
+    if ((found == wanted && (wanted == 0 || distance >= bestDistance[found - 1])) || m_rows[i] == excludeRow) {
+      continue;
+    }
+
+    int slot = found < wanted ? found++ : found - 1;
+    while (slot > 0 && bestDistance[slot - 1] > distance) {
+      bestDistance[slot] = bestDistance[slot - 1];
+      bestRow[slot] = bestRow[slot - 1];
+      --slot;
+    }
+    bestDistance[slot] = distance;
+    bestRow[slot] = m_rows[i];
+  }
+
+  return QVector<int>(bestRow, bestRow + found);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "PlaylistModel.h"
+#include "PresetMetadata.h"
+
+#include <QHash>
+#include <QVector>
+
+#include <vector>
+
+// Playlist rows packed as fixed-size descriptors for nearest-neighbour
+// lookup against the live AudioFeatures. A row's descriptor is what the
+// preset learned while playing or, failing that, what its mood tags say
+// (calm, energetic, dark, bright, busy, sparse, slow, fast, ...); rows with
+// neither are left out. Lookup is a linear scan over contiguous floats,
+// tens of microseconds for 10k presets, so it needs no tree to stay cheap.
+class PresetFeatureIndex {
+public:
+  void rebuild(const QVector<PlaylistItem> &items, const QHash<QString, PresetMetadata> &metadata);
+  // Redescribes only the rows playing presetPath; items must be what the
+  // index was last rebuilt from.
+  void updatePreset(const QVector<PlaylistItem> &items, const QString &presetPath, const PresetMetadata &metadata);
+  int size() const;
+  // Up to maxRows rows nearest to features, nearest first, never excludeRow.
+  QVector<int> nearestRows(const AudioFeatures &features, int maxRows, int excludeRow) const;
+
+private:
+  static constexpr int kAxes = AudioFeatures::AxisCount;
+
+  std::vector<int> m_rows;
+  // kAxes values per row; m_known is 1 where the descriptor sets that axis.
+  std::vector<float> m_values;
+  std::vector<float> m_known;
+};
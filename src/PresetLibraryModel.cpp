@@ -173,6 +173,11 @@ void PresetLibraryModel::applyMetadata(const QHash<QString, PresetMetadata> &met
       entry.metadata.rating = std::clamp(info.rating, 1, 5);
       entry.metadata.favorite = info.favorite;
       entry.metadata.tags = info.tags;
+      // Imports from before learning existed carry none; keep what was learned here.
+      if (info.learnedSeconds > 0) {
+        entry.metadata.learnedFeatures = info.learnedFeatures;
+        entry.metadata.learnedSeconds = info.learnedSeconds;
+      }
     }
   }
 
@@ -223,6 +228,8 @@ bool PresetLibraryModel::updateMetadataForPath(const QString &presetPath, const
       .rating = std::clamp(metadata.rating, 1, 5),
       .favorite = metadata.favorite,
       .tags = metadata.tags,
+      .learnedFeatures = metadata.learnedSeconds > 0 ? metadata.learnedFeatures : entry.metadata.learnedFeatures,
+      .learnedSeconds = metadata.learnedSeconds > 0 ? metadata.learnedSeconds : entry.metadata.learnedSeconds,
   };
 
   if (entry.metadata.rating == normalized.rating && entry.metadata.favorite == normalized.favorite &&
@@ -241,6 +248,15 @@ bool PresetLibraryModel::updateMetadataForPath(const QString &presetPath, const
   return true;
 }
 
+bool PresetLibraryModel::addLearnedFeatures(const QString &presetPath, const AudioFeatures &mean, int seconds) {
+  const int row = rowForPresetPath(presetPath);
+  if (row < 0) {
+    return false;
+  }
+  ::addLearnedFeatures(m_presets[row].metadata, mean, seconds);
+  return true;
+}
+
 QHash<QString, PresetMetadata> PresetLibraryModel::metadataMap() const {
   QHash<QString, PresetMetadata> map;
   map.reserve(m_presets.size());
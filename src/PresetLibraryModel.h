@@ -34,6 +34,8 @@ public:
   PresetMetadata presetMetadataForRow(int row) const;
   int rowForPresetPath(const QString &presetPath) const;
   bool updateMetadataForPath(const QString &presetPath, const PresetMetadata &metadata);
+  // Learned features are not shown, so this emits no change signals.
+  bool addLearnedFeatures(const QString &presetPath, const AudioFeatures &mean, int seconds);
   QHash<QString, PresetMetadata> metadataMap() const;
   const QVector<PresetEntry> &presets() const;
 
@@ -1,9 +1,44 @@
 #pragma once
 
+#include "audio/AudioFeatureTracker.h"
+
+#include <QString>
 #include <QStringList>
 
+#include <algorithm>
+#include <array>
+
 struct PresetMetadata {
   int rating = 3;
   bool favorite = false;
   QStringList tags;
+  // Mean AudioFeatures heard while the preset was on screen, over
+  // learnedSeconds of audible input; 0 until it has been learned.
+  std::array<float, AudioFeatures::AxisCount> learnedFeatures = {};
+  int learnedSeconds = 0;
+};
+
+// Mean AudioFeatures heard over seconds of input while presetPath played.
+struct LearnedFeatures {
+  QString presetPath;
+  AudioFeatures mean;
+  int seconds = 0;
 };
+
+// Folds seconds of input with the given mean into the learned descriptor.
+// The history's weight is capped so a preset keeps adapting to what it is
+// played with.
+inline void addLearnedFeatures(PresetMetadata &metadata, const AudioFeatures &mean, int seconds) {
+  constexpr int kMaxLearnedSeconds = 600;
+
+  if (seconds <= 0) {
+    return;
+  }
+  const int keptSeconds = std::max(0, std::min(metadata.learnedSeconds, kMaxLearnedSeconds - seconds));
+  const int totalSeconds = keptSeconds + seconds;
+  for (int axis = 0; axis < AudioFeatures::AxisCount; ++axis) {
+    metadata.learnedFeatures[axis] =
+        (metadata.learnedFeatures[axis] * keptSeconds + mean.values[axis] * seconds) / totalSeconds;
+  }
+  metadata.learnedSeconds = totalSeconds;
+}
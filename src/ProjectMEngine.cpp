@@ -6,6 +6,8 @@
 #include <QRegularExpression>
 #include <QStringList>
 
+#include <algorithm>
+
 #ifdef HAVE_PROJECTM
 #include <projectM-4/audio.h>
 #include <projectM-4/callbacks.h>
@@ -14,6 +16,10 @@
 #endif
 
 namespace {
+// Without rendering (hidden preview, no GL) a scheduled preset still loads
+// once audio this far past its time has arrived.
+constexpr int64_t kScheduledPresetGraceNs = 100000000LL;
+
 int parseMajorVersion(const QString &versionText) {
   const QString trimmed = versionText.trimmed();
   const QStringList parts = trimmed.split(QRegularExpression(QStringLiteral("[^0-9]+")),
@@ -70,6 +76,7 @@ bool ProjectMEngine::loadPreset(const QString &presetPath) {
     return false;
   }
 
+  m_scheduledPreset.clear();
   m_activePreset = presetPath;
   m_pendingPresetToLoad = presetPath;
   Q_EMIT presetChanged(m_activePreset);
@@ -77,10 +84,30 @@ bool ProjectMEngine::loadPreset(const QString &presetPath) {
   return true;
 }
 
+bool ProjectMEngine::loadPresetAt(const QString &presetPath, int64_t audioTimeNs) {
+  if (presetPath.isEmpty()) {
+    return false;
+  }
+
+  m_scheduledPreset = presetPath;
+  m_scheduledAudioTimeNs = audioTimeNs;
+  return true;
+}
+
+void ProjectMEngine::cancelScheduledPreset() { m_scheduledPreset.clear(); }
+
+void ProjectMEngine::applyScheduledPreset(int64_t lateByNs) {
+  if (!m_scheduledPreset.isEmpty() && m_latestAudioBlock.captureTimeNs >= m_scheduledAudioTimeNs + lateByNs) {
+    loadPreset(m_scheduledPreset);
+  }
+}
+
 QString ProjectMEngine::activePreset() const { return m_activePreset; }
 
 void ProjectMEngine::applySettings(const QVariantMap &settings) {
   m_settings = settings;
+  m_rechunker.configure(settings.value(QStringLiteral("analysisBlockFrames"), 1024).toInt(),
+                        settings.value(QStringLiteral("analysisHopFrames"), 512).toInt());
   m_settingsDirty = true;
   Q_EMIT statusMessage(QStringLiteral("Updated projectM settings."));
 }
@@ -158,6 +185,7 @@ void ProjectMEngine::resizeRenderer(int width, int height) {
 }
 
 bool ProjectMEngine::renderFrame(uint32_t framebufferObject) {
+  applyScheduledPreset(0);
 #ifdef HAVE_PROJECTM
   if (m_projectM == nullptr) {
     return false;
@@ -196,17 +224,33 @@ void ProjectMEngine::resetRenderer() {
   }
 }
 
-void ProjectMEngine::submitAudioFrame(const QVector<float> &monoFrame) {
+PcmBlockInfo ProjectMEngine::latestAudioBlock() const { return m_latestAudioBlock; }
+
+void ProjectMEngine::submitAudioFrame(const QVector<float> &stereoFrame, const PcmBlockInfo &info) {
+  const int blockFrames = m_rechunker.blockFrames();
+  const int hopFrames = m_rechunker.hopFrames();
+  m_rechunker.push(stereoFrame.constData(),
+                   static_cast<int>(stereoFrame.size() / 2),
+                   info,
+                   [this, blockFrames, hopFrames](const float *window, const float *newest, const PcmBlockInfo &windowInfo) {
+                     m_latestAudioBlock = windowInfo;
 #ifdef HAVE_PROJECTM
-  if (m_projectM != nullptr && !monoFrame.isEmpty()) {
-    projectm_pcm_add_float(m_projectM,
-                           monoFrame.constData(),
-                           static_cast<unsigned int>(monoFrame.size()),
-                           PROJECTM_MONO);
-  }
+                     if (m_projectM != nullptr) {
+                       const int maxFrames = static_cast<int>(std::max(1U, projectm_pcm_get_max_samples()));
+                       for (int offset = 0; offset < hopFrames; offset += maxFrames) {
+                         projectm_pcm_add_float(m_projectM,
+                                                newest + 2 * offset,
+                                                static_cast<unsigned int>(std::min(maxFrames, hopFrames - offset)),
+                                                PROJECTM_STEREO);
+                       }
+                     }
+#else
+                     Q_UNUSED(newest);
+                     Q_UNUSED(hopFrames);
 #endif
-
-  Q_EMIT frameReady(monoFrame);
+                     Q_EMIT frameReady(QVector<float>(window, window + 2 * blockFrames), windowInfo);
+                   });
+  applyScheduledPreset(kScheduledPresetGraceNs);
 }
 
 void ProjectMEngine::applySettingsToBackend() {
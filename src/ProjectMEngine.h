@@ -6,6 +6,9 @@
 #include <QVector>
 #include <cstdint>
 
+#include "audio/PcmBlockInfo.h"
+#include "audio/PcmRechunker.h"
+
 #ifdef HAVE_PROJECTM
 #include <projectM-4/projectM.h>
 #endif
@@ -21,6 +24,11 @@ public:
   QString presetDirectory() const;
 
   bool loadPreset(const QString &presetPath);
+  // Loads presetPath on the first frame rendered from audio captured at or
+  // after audioTimeNs (capture clock), so the switch lands on that point in
+  // the music. Any direct loadPreset() call cancels it.
+  bool loadPresetAt(const QString &presetPath, int64_t audioTimeNs);
+  void cancelScheduledPreset();
   QString activePreset() const;
 
   void applySettings(const QVariantMap &settings);
@@ -31,25 +39,33 @@ public:
   bool renderFrame(uint32_t framebufferObject = 0);
   bool hasProjectMBackend() const;
   void resetRenderer();
+  PcmBlockInfo latestAudioBlock() const;
 
 public Q_SLOTS:
-  void submitAudioFrame(const QVector<float> &monoFrame);
+  // Re-chunks into fixed analysis windows; projectM gets each window's new
+  // hop and frameReady carries the whole window.
+  void submitAudioFrame(const QVector<float> &stereoFrame, const PcmBlockInfo &info);
 
 Q_SIGNALS:
   void statusMessage(const QString &message);
   void presetChanged(const QString &presetPath);
-  void frameReady(const QVector<float> &monoFrame);
+  void frameReady(const QVector<float> &stereoFrame, const PcmBlockInfo &info);
 
 private:
   void applySettingsToBackend();
   void applyPendingState();
+  void applyScheduledPreset(int64_t lateByNs);
 
   QString m_presetDirectory;
   QString m_activePreset;
   QVariantMap m_settings;
   QString m_pendingPresetToLoad;
+  QString m_scheduledPreset;
+  int64_t m_scheduledAudioTimeNs = 0;
   QString m_pendingTexturePath;
   bool m_settingsDirty = false;
+  PcmBlockInfo m_latestAudioBlock;
+  PcmRechunker m_rechunker;
 
 #ifdef HAVE_PROJECTM
   projectm_handle m_projectM = nullptr;
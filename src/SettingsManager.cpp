@@ -29,6 +29,14 @@ QJsonObject metadataToJson(const PresetMetadata &metadata) {
     tags.append(tag);
   }
   obj.insert(QStringLiteral("tags"), tags);
+  if (metadata.learnedSeconds > 0) {
+    QJsonArray features;
+    for (const float value : metadata.learnedFeatures) {
+      features.append(static_cast<double>(value));
+    }
+    obj.insert(QStringLiteral("features"), features);
+    obj.insert(QStringLiteral("featureSeconds"), metadata.learnedSeconds);
+  }
   return obj;
 }
 
@@ -51,6 +59,15 @@ PresetMetadata metadataFromJson(const QJsonValue &value) {
     }
   }
   metadata.tags.removeDuplicates();
+
+  const QJsonArray features = obj.value(QStringLiteral("features")).toArray();
+  const int learnedSeconds = obj.value(QStringLiteral("featureSeconds")).toInt(0);
+  if (features.size() == AudioFeatures::AxisCount && learnedSeconds > 0) {
+    for (int axis = 0; axis < AudioFeatures::AxisCount; ++axis) {
+      metadata.learnedFeatures[axis] = static_cast<float>(qBound(0.0, features.at(axis).toDouble(), 1.0));
+    }
+    metadata.learnedSeconds = learnedSeconds;
+  }
   return metadata;
 }
 } // namespace
@@ -70,12 +87,50 @@ bool SettingsManager::savePresetMetadata(const QString &presetPath, const Preset
     map.clear();
   }
 
-  map.insert(presetPath, metadata);
+  // Edits from the UI carry no learned features; keep the stored ones.
+  PresetMetadata merged = metadata;
+  const auto existing = map.constFind(presetPath);
+  if (merged.learnedSeconds <= 0 && existing != map.constEnd()) {
+    merged.learnedFeatures = existing->learnedFeatures;
+    merged.learnedSeconds = existing->learnedSeconds;
+  }
+  map.insert(presetPath, merged);
+  return writeMetadataToPath(metadataPath(), map, nullptr);
+}
+
+bool SettingsManager::addLearnedFeatures(const QVector<LearnedFeatures> &learned) {
+  if (learned.isEmpty()) {
+    return true;
+  }
+  bool ok = false;
+  QHash<QString, PresetMetadata> map = readMetadataFromPath(metadataPath(), &ok, nullptr);
+  if (!ok) {
+    map.clear();
+  }
+
+  for (const LearnedFeatures &entry : learned) {
+    ::addLearnedFeatures(map[entry.presetPath], entry.mean, entry.seconds);
+  }
   return writeMetadataToPath(metadataPath(), map, nullptr);
 }
 
 bool SettingsManager::savePresetMetadataMap(const QHash<QString, PresetMetadata> &metadataMap) {
-  return writeMetadataToPath(metadataPath(), metadataMap, nullptr);
+  bool ok = false;
+  const QHash<QString, PresetMetadata> stored = readMetadataFromPath(metadataPath(), &ok, nullptr);
+  if (!ok) {
+    return writeMetadataToPath(metadataPath(), metadataMap, nullptr);
+  }
+
+  // As in savePresetMetadata: entries without learned features keep the stored ones.
+  QHash<QString, PresetMetadata> merged = metadataMap;
+  for (auto it = merged.begin(); it != merged.end(); ++it) {
+    const auto existing = stored.constFind(it.key());
+    if (it->learnedSeconds <= 0 && existing != stored.constEnd()) {
+      it->learnedFeatures = existing->learnedFeatures;
+      it->learnedSeconds = existing->learnedSeconds;
+    }
+  }
+  return writeMetadataToPath(metadataPath(), merged, nullptr);
 }
 
 bool SettingsManager::exportPresetMetadata(const QString &filePath,
@@ -135,14 +190,29 @@ QVariantMap SettingsManager::loadProjectMSettings() const {
   map.insert(QStringLiteral("meshX"), settings.value(QStringLiteral("meshX"), 32));
   map.insert(QStringLiteral("meshY"), settings.value(QStringLiteral("meshY"), 24));
   map.insert(QStringLiteral("targetFps"), settings.value(QStringLiteral("targetFps"), 60));
+  map.insert(QStringLiteral("silenceFloorDb"), settings.value(QStringLiteral("silenceFloorDb"), -60));
+  map.insert(QStringLiteral("silenceHoldSeconds"), settings.value(QStringLiteral("silenceHoldSeconds"), 10));
+  map.insert(QStringLiteral("idleFps"), settings.value(QStringLiteral("idleFps"), 5));
   map.insert(QStringLiteral("beatSensitivity"), settings.value(QStringLiteral("beatSensitivity"), 1.0));
   map.insert(QStringLiteral("hardCutEnabled"), settings.value(QStringLiteral("hardCutEnabled"), true));
   map.insert(QStringLiteral("hardCutDuration"), settings.value(QStringLiteral("hardCutDuration"), 20));
+  map.insert(QStringLiteral("analysisBlockFrames"), settings.value(QStringLiteral("analysisBlockFrames"), 1024));
+  map.insert(QStringLiteral("analysisHopFrames"), settings.value(QStringLiteral("analysisHopFrames"), 512));
   map.insert(QStringLiteral("upscalerPreset"), settings.value(QStringLiteral("upscalerPreset"), QStringLiteral("balanced")));
   map.insert(QStringLiteral("renderScalePercent"), settings.value(QStringLiteral("renderScalePercent"), 77));
   map.insert(QStringLiteral("upscalerSharpness"), settings.value(QStringLiteral("upscalerSharpness"), 0.2));
+  map.insert(QStringLiteral("previewMonoDownmix"), settings.value(QStringLiteral("previewMonoDownmix"), false));
   map.insert(QStringLiteral("gpuPreference"), settings.value(QStringLiteral("gpuPreference"), QStringLiteral("dgpu")));
   map.insert(QStringLiteral("audioDeviceId"), settings.value(QStringLiteral("audioDeviceId"), QString()));
+  map.insert(QStringLiteral("audioLatencyFrames"), settings.value(QStringLiteral("audioLatencyFrames"), 0));
+  map.insert(QStringLiteral("audioBackend"), settings.value(QStringLiteral("audioBackend"), QStringLiteral("auto")));
+  map.insert(QStringLiteral("audioMixInputs"), settings.value(QStringLiteral("audioMixInputs"), QString()));
+  map.insert(QStringLiteral("audioFileTracks"), settings.value(QStringLiteral("audioFileTracks"), QStringList()));
+  map.insert(QStringLiteral("audioFilePlayout"), settings.value(QStringLiteral("audioFilePlayout"), false));
+  map.insert(QStringLiteral("captureThreadPlacement"), settings.value(QStringLiteral("captureThreadPlacement"), QString()));
+  map.insert(QStringLiteral("renderThreadPlacement"), settings.value(QStringLiteral("renderThreadPlacement"), QString()));
+  map.insert(QStringLiteral("workerThreadPlacement"), settings.value(QStringLiteral("workerThreadPlacement"), QString()));
+  map.insert(QStringLiteral("captureHistorySeconds"), settings.value(QStringLiteral("captureHistorySeconds"), 30));
 
   settings.endGroup();
   return map;
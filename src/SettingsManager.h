@@ -17,6 +17,8 @@ public:
   QHash<QString, PresetMetadata> loadPresetMetadata() const;
   bool savePresetMetadata(const QString &presetPath, const PresetMetadata &metadata);
   bool savePresetMetadataMap(const QHash<QString, PresetMetadata> &metadataMap);
+  // Folds each entry, in order, into its preset's stored learned descriptor.
+  bool addLearnedFeatures(const QVector<LearnedFeatures> &learned);
 
   bool exportPresetMetadata(const QString &filePath,
                             const QHash<QString, PresetMetadata> &metadataMap) const;
@@ -14,6 +14,9 @@
 #include <cmath>
 
 namespace {
+constexpr int kRefreshIntervalMs = 16;
+constexpr int kMaxIdleFps = 30;
+
 constexpr const char *kUpscaleVertexShader = R"(#version 330 core
 out vec2 vUv;
 
@@ -97,18 +100,38 @@ VisualizerWidget::VisualizerWidget(ProjectMEngine *engine, QWindow *parent)
   setMinimumSize(QSize(240, 135));
 
   m_refreshTimer = new QTimer(this);
-  m_refreshTimer->setInterval(16);
+  m_refreshTimer->setInterval(kRefreshIntervalMs);
   connect(m_refreshTimer, &QTimer::timeout, this, qOverload<>(&VisualizerWidget::update));
   m_refreshTimer->start();
   m_fpsTimer.start();
+  connect(this, &QOpenGLWindow::frameSwapped, this, &VisualizerWidget::onFrameSwapped);
 }
 
 VisualizerWidget::~VisualizerWidget() { cleanupGlResources(); }
 
-void VisualizerWidget::consumeFrame(const QVector<float> &monoFrame) { m_lastFrame = monoFrame; }
+void VisualizerWidget::consumeFrame(const QVector<float> &stereoFrame) { m_lastFrame = stereoFrame; }
 
 void VisualizerWidget::setFpsDisplayEnabled(bool enabled) { m_showFps = enabled; }
 
+double VisualizerWidget::audioToPhotonMs() const { return m_audioToPhotonMs; }
+
+void VisualizerWidget::onFrameSwapped() {
+  if (m_renderedAudioTimeNs <= 0) {
+    return;
+  }
+
+  const double ageMs = static_cast<double>(monotonicTimeNs() - m_renderedAudioTimeNs) / 1.0e6;
+  m_audioToPhotonMs = m_audioToPhotonMs > 0.0 ? (0.9 * m_audioToPhotonMs + 0.1 * ageMs) : ageMs;
+}
+
+void VisualizerWidget::setPreviewMonoDownmix(bool enabled) {
+  if (m_previewMonoDownmix == enabled) {
+    return;
+  }
+  m_previewMonoDownmix = enabled;
+  update();
+}
+
 void VisualizerWidget::setRenderScalePercent(int percent) {
   const int clamped = qBound(50, percent, 100);
   if (clamped == m_renderScalePercent) {
@@ -142,6 +165,34 @@ void VisualizerWidget::setUpscaleSharpness(double amount) {
   update();
 }
 
+void VisualizerWidget::setIdleRendering(bool idle) {
+  if (m_idleRendering == idle) {
+    return;
+  }
+  m_idleRendering = idle;
+  applyRefreshInterval();
+  if (!idle) {
+    update();
+  }
+}
+
+void VisualizerWidget::setIdleFps(int fps) {
+  m_idleFps = qBound(0, fps, kMaxIdleFps);
+  applyRefreshInterval();
+}
+
+void VisualizerWidget::applyRefreshInterval() {
+  if (!m_idleRendering) {
+    m_refreshTimer->setInterval(kRefreshIntervalMs);
+    m_refreshTimer->start();
+  } else if (m_idleFps <= 0) {
+    m_refreshTimer->stop();
+  } else {
+    m_refreshTimer->setInterval(1000 / m_idleFps);
+    m_refreshTimer->start();
+  }
+}
+
 void VisualizerWidget::showPresetOverlay(const QString &presetPath) {
   QString displayName = QFileInfo(presetPath).completeBaseName();
   if (displayName.isEmpty()) {
@@ -262,6 +313,10 @@ void VisualizerWidget::paintGL() {
     }
   }
 
+  if (m_engine != nullptr) {
+    m_renderedAudioTimeNs = m_engine->latestAudioBlock().captureTimeNs;
+  }
+
   QPainter painter(this);
   painter.setRenderHint(QPainter::Antialiasing, false);
 
@@ -269,7 +324,7 @@ void VisualizerWidget::paintGL() {
     painter.setPen(QPen(QColor(60, 170, 245), 2));
     painter.drawText(12, 22, QStringLiteral("Preview fallback (projectM backend unavailable in this build)"));
 
-    if (m_lastFrame.isEmpty()) {
+    if (m_lastFrame.size() < 2) {
       painter.setPen(QColor(190, 190, 190));
       painter.drawText(12, 46, QStringLiteral("Waiting for audio frames..."));
     } else {
@@ -282,12 +337,22 @@ void VisualizerWidget::paintGL() {
       painter.setBrush(QColor(65, 180, 255));
       painter.setPen(Qt::NoPen);
 
+      const int frameCount = m_lastFrame.size() / 2;
       for (int i = 0; i < bars; ++i) {
-        const int sampleIndex = (i * m_lastFrame.size()) / bars;
-        const float value = qAbs(m_lastFrame.value(sampleIndex));
-        const int amplitude = qMin(h / 2, static_cast<int>(value * h * 0.8f));
+        const int frameIndex = (i * frameCount) / bars;
+        const float left = qAbs(m_lastFrame.at(frameIndex * 2));
+        const float right = qAbs(m_lastFrame.at(frameIndex * 2 + 1));
         const int x = 12 + i * barW;
-        painter.drawRect(x, centerY - amplitude, barW - 1, amplitude * 2);
+        if (m_previewMonoDownmix) {
+          const float value = 0.5f * (left + right);
+          const int amplitude = qMin(h / 2, static_cast<int>(value * h * 0.8f));
+          painter.drawRect(x, centerY - amplitude, barW - 1, amplitude * 2);
+        } else {
+          const int leftAmplitude = qMin(h / 2, static_cast<int>(left * h * 0.8f));
+          const int rightAmplitude = qMin(h / 2, static_cast<int>(right * h * 0.8f));
+          painter.drawRect(x, centerY - leftAmplitude, barW - 1, leftAmplitude);
+          painter.drawRect(x, centerY, barW - 1, rightAmplitude);
+        }
       }
     }
   }
@@ -304,7 +369,8 @@ void VisualizerWidget::paintGL() {
     const QRect drawRect(0, 0, width(), height());
     painter.setPen(QColor(235, 235, 235));
     painter.drawText(drawRect.adjusted(0, 8, -10, 0), Qt::AlignTop | Qt::AlignRight,
-                     QStringLiteral("FPS: %1").arg(QString::number(m_fpsValue, 'f', 1)));
+                     QStringLiteral("FPS: %1  A/V: %2 ms")
+                         .arg(QString::number(m_fpsValue, 'f', 1), QString::number(m_audioToPhotonMs, 'f', 1)));
   }
 
   if (!m_presetOverlayText.isEmpty() && m_presetOverlayTimer.isValid() &&
@@ -7,6 +7,7 @@
 #include <QResizeEvent>
 #include <QSize>
 #include <QVector>
+#include <cstdint>
 
 class ProjectMEngine;
 class QTimer;
@@ -18,11 +19,18 @@ public:
   explicit VisualizerWidget(ProjectMEngine *engine, QWindow *parent = nullptr);
   ~VisualizerWidget() override;
 
+  // Smoothed time from capture of the newest rendered audio to buffer swap.
+  double audioToPhotonMs() const;
+
 public Q_SLOTS:
-  void consumeFrame(const QVector<float> &monoFrame);
+  void consumeFrame(const QVector<float> &stereoFrame);
   void setFpsDisplayEnabled(bool enabled);
+  void setPreviewMonoDownmix(bool enabled);
   void setRenderScalePercent(int percent);
   void setUpscaleSharpness(double amount);
+  // Idle drops the refresh timer to the idle rate; 0 fps holds the last frame.
+  void setIdleRendering(bool idle);
+  void setIdleFps(int fps);
   void showPresetOverlay(const QString &presetPath);
 
 protected:
@@ -40,15 +48,22 @@ private:
   bool ensureUpscaleProgram();
   void releaseUpscaleProgram();
   bool drawUpscaledScene(int outputWidth, int outputHeight);
+  void onFrameSwapped();
+  void applyRefreshInterval();
 
   ProjectMEngine *m_engine = nullptr;
   QVector<float> m_lastFrame;
   QTimer *m_refreshTimer = nullptr;
+  bool m_idleRendering = false;
+  int m_idleFps = 5;
   bool m_glCleanupDone = false;
   bool m_showFps = false;
+  bool m_previewMonoDownmix = false;
   QElapsedTimer m_fpsTimer;
   int m_fpsFrameCount = 0;
   float m_fpsValue = 0.0f;
+  int64_t m_renderedAudioTimeNs = 0;
+  double m_audioToPhotonMs = 0.0;
   int m_renderScalePercent = 77;
   float m_upscaleSharpness = 0.2f;
   bool m_upscaleProgramFailed = false;
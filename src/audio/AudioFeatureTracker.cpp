@@ -0,0 +1,70 @@
+#include "AudioFeatureTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kSmoothingSeconds = 4.0;
+constexpr float kFloorDb = -60.0f;
+constexpr float kMinCentroidHz = 200.0f;
+constexpr float kMaxCentroidHz = 8000.0f;
+constexpr float kMaxOnsetsPerSecond = 8.0f;
+constexpr double kMinBpm = 60.0;
+constexpr double kMaxBpm = 180.0;
+constexpr float kMinTempoConfidence = 0.3f;
+// Lowest value a confident tempo maps to, so a slow beat stays apart from none.
+constexpr float kSlowestTempoValue = 0.2f;
+// Sparse kicks leave most hops below the gate; silence leaves all of them.
+constexpr float kMinAudibleFraction = 0.1f;
+} // namespace
+
+void AudioFeatureTracker::configure(double hopSeconds) {
+  m_hopSeconds = hopSeconds > 0.0 ? hopSeconds : 0.01;
+  m_smoothing = static_cast<float>(1.0 - std::exp(-m_hopSeconds / kSmoothingSeconds));
+  m_warmupHops = static_cast<int>(std::ceil(kSmoothingSeconds / m_hopSeconds));
+  reset();
+}
+
+void AudioFeatureTracker::reset() {
+  m_hops = 0;
+  m_meanSquare = 0.0f;
+  m_logCentroid = std::log2(kMinCentroidHz);
+  m_onsetRate = 0.0f;
+  m_audible = 0.0f;
+  m_tempo = 0.0f;
+}
+
+void AudioFeatureTracker::push(float rms, float centroidHz, bool onset) {
+  const bool audible = centroidHz > 0.0f;
+  m_meanSquare += m_smoothing * (rms * rms - m_meanSquare);
+  m_audible += m_smoothing * ((audible ? 1.0f : 0.0f) - m_audible);
+  const float onsetsPerSecond = onset ? static_cast<float>(1.0 / m_hopSeconds) : 0.0f;
+  m_onsetRate += m_smoothing * (onsetsPerSecond - m_onsetRate);
+  // Silence has no meaningful centroid; hold the last one instead.
+  if (audible) {
+    const float logCentroid = std::log2(std::clamp(centroidHz, kMinCentroidHz, kMaxCentroidHz));
+    m_logCentroid += m_smoothing * (logCentroid - m_logCentroid);
+  }
+  ++m_hops;
+}
+
+void AudioFeatureTracker::setTempo(const TempoEstimate &tempo) {
+  if (!tempo.isValid() || tempo.confidence < kMinTempoConfidence) {
+    m_tempo = 0.0f;
+    return;
+  }
+  const double position = std::clamp((tempo.bpm - kMinBpm) / (kMaxBpm - kMinBpm), 0.0, 1.0);
+  m_tempo = kSlowestTempoValue + (1.0f - kSlowestTempoValue) * static_cast<float>(position);
+}
+
+AudioFeatures AudioFeatureTracker::features() const {
+  AudioFeatures features;
+  const float db = m_meanSquare > 0.0f ? 10.0f * std::log10(m_meanSquare) : kFloorDb;
+  features.values[AudioFeatures::Energy] = std::clamp(1.0f - db / kFloorDb, 0.0f, 1.0f);
+  features.values[AudioFeatures::Brightness] =
+      std::clamp((m_logCentroid - std::log2(kMinCentroidHz)) / std::log2(kMaxCentroidHz / kMinCentroidHz), 0.0f, 1.0f);
+  features.values[AudioFeatures::OnsetDensity] = std::clamp(m_onsetRate / kMaxOnsetsPerSecond, 0.0f, 1.0f);
+  features.values[AudioFeatures::Tempo] = m_tempo;
+  features.valid = m_hops >= m_warmupHops && m_audible >= kMinAudibleFraction;
+  return features;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "TempoTracker.h"
+
+#include <array>
+
+// Rolling description of the input with every axis mapped to 0..1, so a
+// distance along one axis weighs the same as along another.
+struct AudioFeatures {
+  enum Axis { Energy, Brightness, OnsetDensity, Tempo, AxisCount };
+
+  std::array<float, AxisCount> values = {};
+  // False until a few seconds of input have been seen, and again once
+  // nearly all of the recent input was below the gate.
+  bool valid = false;
+};
+
+// Smooths per-hop measurements from OnsetDetector into AudioFeatures over a
+// few seconds: RMS level (-60..0 dBFS), spectral centroid (200 Hz..8 kHz on
+// a log scale), onsets per second (0..8) and tempo (60..180 BPM, 0 without
+// a confident beat). Not thread-safe: the analysis worker owns it.
+class AudioFeatureTracker {
+public:
+  void configure(double hopSeconds);
+  void reset();
+  // centroidHz 0 marks a hop below the gate.
+  void push(float rms, float centroidHz, bool onset);
+  void setTempo(const TempoEstimate &tempo);
+  AudioFeatures features() const;
+
+private:
+  double m_hopSeconds = 0.01;
+  float m_smoothing = 1.0f;
+  int m_warmupHops = 0;
+  int m_hops = 0;
+  float m_meanSquare = 0.0f;
+  float m_logCentroid = 0.0f;
+  float m_onsetRate = 0.0f;
+  float m_audible = 0.0f;
+  float m_tempo = 0.0f;
+};
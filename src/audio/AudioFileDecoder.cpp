@@ -0,0 +1,105 @@
+#include "AudioFileDecoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+AudioFileDecoder::~AudioFileDecoder() { close(); }
+
+bool AudioFileDecoder::open(const QString &filePath, QString *error) {
+  close();
+
+#ifdef HAVE_SNDFILE
+  SF_INFO info = {};
+  m_file = sf_open(filePath.toLocal8Bit().constData(), SFM_READ, &info);
+  if (m_file == nullptr) {
+    if (error != nullptr) {
+      *error = QStringLiteral("%1: %2").arg(filePath, QString::fromUtf8(sf_strerror(nullptr)));
+    }
+    return false;
+  }
+  m_sampleRate = info.samplerate;
+  m_channels = info.channels;
+  m_frameCount = info.frames;
+#else
+  if (!filePath.endsWith(QStringLiteral(".wav"), Qt::CaseInsensitive)) {
+    if (error != nullptr) {
+      *error = QStringLiteral("%1: only WAV files can be played without libsndfile").arg(filePath);
+    }
+    return false;
+  }
+  if (!readWavFile(filePath, &m_wav, error)) {
+    return false;
+  }
+  m_sampleRate = m_wav.sampleRate;
+  m_channels = m_wav.channels;
+  m_frameCount = m_wav.frameCount();
+#endif
+
+  if (m_sampleRate <= 0 || m_channels <= 0) {
+    if (error != nullptr) {
+      *error = QStringLiteral("%1 has no audio stream").arg(filePath);
+    }
+    close();
+    return false;
+  }
+  m_open = true;
+  m_position = 0;
+  return true;
+}
+
+void AudioFileDecoder::close() {
+#ifdef HAVE_SNDFILE
+  if (m_file != nullptr) {
+    sf_close(m_file);
+    m_file = nullptr;
+  }
+#endif
+  m_wav = PcmFileData();
+  m_open = false;
+  m_sampleRate = 0;
+  m_channels = 0;
+  m_frameCount = 0;
+  m_position = 0;
+}
+
+bool AudioFileDecoder::isOpen() const { return m_open; }
+
+int AudioFileDecoder::sampleRate() const { return m_sampleRate; }
+
+int AudioFileDecoder::channels() const { return m_channels; }
+
+int64_t AudioFileDecoder::frameCount() const { return m_frameCount; }
+
+int64_t AudioFileDecoder::position() const { return m_position; }
+
+int AudioFileDecoder::read(float *interleaved, int frames) {
+  if (!m_open || frames <= 0) {
+    return 0;
+  }
+
+#ifdef HAVE_SNDFILE
+  const auto count = static_cast<int>(sf_readf_float(m_file, interleaved, frames));
+#else
+  const auto count = static_cast<int>(std::min<int64_t>(frames, m_frameCount - m_position));
+  std::memcpy(interleaved,
+              m_wav.samples.constData() + m_position * m_channels,
+              static_cast<size_t>(count) * static_cast<size_t>(m_channels) * sizeof(float));
+#endif
+  m_position += std::max(0, count);
+  return std::max(0, count);
+}
+
+bool AudioFileDecoder::seek(int64_t frame) {
+  if (!m_open) {
+    return false;
+  }
+  frame = std::clamp<int64_t>(frame, 0, m_frameCount);
+#ifdef HAVE_SNDFILE
+  if (sf_seek(m_file, frame, SEEK_SET) < 0) {
+    return false;
+  }
+#endif
+  m_position = frame;
+  return true;
+}
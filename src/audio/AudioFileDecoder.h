@@ -0,0 +1,47 @@
+#pragma once
+
+#include "PcmFile.h"
+
+#include <QString>
+
+#ifdef HAVE_SNDFILE
+#include <sndfile.h>
+#endif
+
+#include <cstdint>
+
+// Streams interleaved float frames out of an audio file. Builds with
+// libsndfile (HAVE_SNDFILE) read whatever it was built with: WAV, FLAC,
+// Ogg Vorbis/Opus and, from 1.1, MP3. Without it only WAV is supported,
+// loaded whole through readWavFile().
+class AudioFileDecoder {
+public:
+  AudioFileDecoder() = default;
+  ~AudioFileDecoder();
+  AudioFileDecoder(const AudioFileDecoder &) = delete;
+  AudioFileDecoder &operator=(const AudioFileDecoder &) = delete;
+
+  bool open(const QString &filePath, QString *error = nullptr);
+  void close();
+  bool isOpen() const;
+
+  int sampleRate() const;
+  int channels() const;
+  int64_t frameCount() const;
+  int64_t position() const;
+
+  // Returns the frames read; 0 at the end of the file.
+  int read(float *interleaved, int frames);
+  bool seek(int64_t frame);
+
+private:
+#ifdef HAVE_SNDFILE
+  SNDFILE *m_file = nullptr;
+#endif
+  PcmFileData m_wav;
+  bool m_open = false;
+  int m_sampleRate = 0;
+  int m_channels = 0;
+  int64_t m_frameCount = 0;
+  int64_t m_position = 0;
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "PcmBlockInfo.h"
+
 #include <QObject>
 #include <QString>
 #include <QVector>
@@ -10,6 +12,65 @@ struct AudioDeviceInfo {
   QString description;
 };
 
+struct AudioLatencyInfo {
+  int requestedFrames = 0;
+  int quantumFrames = 0;
+  int sampleRate = 0;
+  double graphDelayMs = 0.0;
+  // Network inputs: interarrival jitter and the jitter buffer's target delay.
+  double jitterMs = 0.0;
+  double targetDelayMs = 0.0;
+};
+
+// One capture input of a mix; an empty deviceId follows the graph default.
+struct AudioInputConfig {
+  QString deviceId;
+  float gain = 1.0f;
+};
+
+// Running totals since start(); every field is read without locking.
+struct AudioCaptureStats {
+  uint64_t callbacks = 0;
+  uint64_t capturedFrames = 0;
+  uint64_t emptyBuffers = 0;
+  uint64_t shortChunks = 0;
+  uint64_t strideMismatches = 0;
+  uint64_t xruns = 0;
+  uint64_t consumerDrops = 0;
+  uint64_t latePackets = 0;
+  uint64_t concealedFrames = 0;
+  uint64_t skippedFrames = 0;
+  uint64_t reconnects = 0;
+  double lastReconnectMs = 0.0;
+  int maxQueueDepthFrames = 0;
+};
+
+// Levels of the captured stereo signal per channel: peak and RMS as linear
+// full scale, loudness K-weighted over the last 3 s (EBU R128 short-term).
+struct AudioLevels {
+  static constexpr float kSilenceLufs = -70.0f;
+
+  float peak[2] = {0.0f, 0.0f};
+  float rms[2] = {0.0f, 0.0f};
+  float shortTermLufs[2] = {kSilenceLufs, kSilenceLufs};
+  // monotonicTimeNs() of the last captured block; 0 before the first one.
+  int64_t updatedNs = 0;
+  // monotonicTimeNs() of the last block whose peak reached the silence floor.
+  int64_t lastSignalNs = 0;
+};
+
+struct AudioInputStats {
+  QString deviceId;
+  float gain = 1.0f;
+  bool active = false;
+  float peak = 0.0f;
+  float rms = 0.0f;
+  double offsetMs = 0.0;
+  uint64_t xruns = 0;
+  uint64_t alignedFrames = 0;
+  uint64_t droppedFrames = 0;
+};
+
 class AudioSource : public QObject {
   Q_OBJECT
 
@@ -24,9 +85,41 @@ public:
   virtual QVector<AudioDeviceInfo> availableDevices() const = 0;
   virtual QString selectedDeviceId() const = 0;
   virtual void setSelectedDeviceId(const QString &deviceId) = 0;
+  virtual QString defaultDeviceId() const { return {}; }
+  // Switches a running source to another device without restarting it.
+  // Returns false when the backend cannot do that; callers then restart it.
+  virtual bool retargetDevice(const QString &deviceId) {
+    Q_UNUSED(deviceId);
+    return false;
+  }
+  // Requested capture quantum in frames; 0 leaves it to the graph.
+  virtual void setRequestedLatencyFrames(int frames) { Q_UNUSED(frames); }
+  virtual AudioLatencyInfo latencyInfo() const { return {}; }
+  // Inputs mixed into one stream; empty captures the selected device alone.
+  virtual void setMixInputs(const QVector<AudioInputConfig> &inputs) { Q_UNUSED(inputs); }
+  virtual QVector<AudioInputStats> inputStats() const { return {}; }
+  virtual AudioCaptureStats captureStats() const { return {}; }
+  // Safe from any thread; producers publish after every captured block.
+  virtual AudioLevels levels() const { return {}; }
+  // Linear block peak below which levels() does not advance lastSignalNs.
+  virtual void setSilenceFloor(float amplitude) { Q_UNUSED(amplitude); }
+  // Rolling record of the last N seconds delivered; 0 turns it off.
+  virtual void setCaptureHistorySeconds(int seconds) { Q_UNUSED(seconds); }
+  virtual bool saveCaptureHistory(const QString &filePath, QString *error) {
+    Q_UNUSED(filePath);
+    if (error != nullptr) {
+      *error = QStringLiteral("%1 does not keep a capture history.").arg(backendName());
+    }
+    return false;
+  }
 
 Q_SIGNALS:
-  void pcmFrameReady(const QVector<float> &monoFrame);
+  void pcmFrameReady(const QVector<float> &stereoFrame, const PcmBlockInfo &info);
+  void devicesChanged();
+  void deviceAdded(const AudioDeviceInfo &device);
+  void deviceRemoved(const QString &deviceId);
+  void deviceChanged(const AudioDeviceInfo &device);
+  void defaultDeviceChanged(const QString &deviceId);
   void statusMessage(const QString &message);
   void errorMessage(const QString &message);
 };
@@ -1,12 +1,137 @@
 #include "AudioSourceFactory.h"
 
-#include "DummyAudioSource.h"
+#include "FileAudioSource.h"
+#include "JackAudioSource.h"
+#include "LocalPcmAudioSource.h"
 #include "PipeWireAudioSource.h"
+#include "ReplayAudioSource.h"
+#include "RtpAudioSource.h"
+#include "SignalGeneratorAudioSource.h"
 
-AudioSource *createAudioSource(QObject *parent) {
-#ifdef HAVE_PIPEWIRE
+#include <QStringList>
+
+namespace {
+AudioSource *createReplaySource(const QString &filePath, QObject *parent) {
+  auto *source = new ReplayAudioSource(parent);
+  source->setFilePath(filePath);
+
+  const QString pacing = qEnvironmentVariable("QT6MPLAYER_REPLAY_PACING").trimmed().toLower();
+  source->setPacing(pacing == QStringLiteral("fast") ? ReplayAudioSource::Pacing::Fast
+                                                     : ReplayAudioSource::Pacing::Realtime);
+  source->setLooping(qEnvironmentVariableIntValue("QT6MPLAYER_REPLAY_LOOP") != 0);
+
+  // Raw captures carry no header: QT6MPLAYER_REPLAY_RAW_FORMAT=<rate>:<channels>.
+  const QStringList rawFormat = qEnvironmentVariable("QT6MPLAYER_REPLAY_RAW_FORMAT").split(QLatin1Char(':'));
+  if (rawFormat.size() == 2) {
+    source->setRawFormat(rawFormat.at(0).toInt(), rawFormat.at(1).toInt());
+  }
+  return source;
+}
+} // namespace
+
+QVector<AudioInputConfig> parseAudioInputList(const QString &text) {
+  QVector<AudioInputConfig> inputs;
+  QString normalized = text;
+  normalized.replace(QLatin1Char(','), QLatin1Char(';'));
+  for (const QString &entry : normalized.split(QLatin1Char(';'))) {
+    const QString trimmed = entry.trimmed();
+    if (trimmed.isEmpty()) {
+      continue;
+    }
+
+    AudioInputConfig input;
+    const qsizetype separator = trimmed.lastIndexOf(QLatin1Char('='));
+    input.deviceId = (separator >= 0 ? trimmed.left(separator) : trimmed).trimmed();
+    if (separator >= 0) {
+      bool ok = false;
+      const float gain = trimmed.mid(separator + 1).trimmed().toFloat(&ok);
+      if (ok && gain >= 0.0f) {
+        input.gain = gain;
+      }
+    }
+    if (input.deviceId == QStringLiteral("default")) {
+      input.deviceId.clear();
+    }
+    inputs.push_back(input);
+  }
+  return inputs;
+}
+
+AudioSource *createAudioSource(QObject *parent, const QString &backend) {
+  const QString replayFile = qEnvironmentVariable("QT6MPLAYER_REPLAY_FILE").trimmed();
+  if (!replayFile.isEmpty()) {
+    return createReplaySource(replayFile, parent);
+  }
+
+  const QString localPcm = qEnvironmentVariable("QT6MPLAYER_LOCAL_PCM").trimmed();
+  if (!localPcm.isEmpty()) {
+    auto *source = new LocalPcmAudioSource(parent);
+    source->setSelectedDeviceId(localPcm);
+    return source;
+  }
+
+  // QT6MPLAYER_GENERATOR=<spec> as in a generator: device id, e.g. "kick,bpm=128,swing=0.33".
+  const QString generator = qEnvironmentVariable("QT6MPLAYER_GENERATOR").trimmed();
+  if (!generator.isEmpty()) {
+    auto *source = new SignalGeneratorAudioSource(parent);
+    source->setSelectedDeviceId(QStringLiteral("generator:") + generator);
+    return source;
+  }
+
+  // QT6MPLAYER_RTP=<spec> as in an rtp: device id, e.g. "5004,format=l24,rate=44100".
+  const QString rtp = qEnvironmentVariable("QT6MPLAYER_RTP").trimmed();
+  if (!rtp.isEmpty()) {
+    auto *source = new RtpAudioSource(parent);
+    source->setSelectedDeviceId(QStringLiteral("rtp:") + rtp);
+    return source;
+  }
+
+  const QString environmentBackend = qEnvironmentVariable("QT6MPLAYER_AUDIO_BACKEND").trimmed().toLower();
+  const QString choice = environmentBackend.isEmpty() ? backend.trimmed().toLower() : environmentBackend;
+  if (choice == QStringLiteral("replay")) {
+    // The file comes from the selected device, or the newest saved capture.
+    return createReplaySource(QString(), parent);
+  }
+  if (choice == QStringLiteral("local-pcm")) {
+    return new LocalPcmAudioSource(parent);
+  }
+  if (choice == QStringLiteral("generator")) {
+    return new SignalGeneratorAudioSource(parent);
+  }
+  if (choice == QStringLiteral("file")) {
+    return new FileAudioSource(parent);
+  }
+  if (choice == QStringLiteral("rtp")) {
+    return new RtpAudioSource(parent);
+  }
+#ifdef HAVE_JACK
+  if (choice == QStringLiteral("jack")) {
+    return new JackAudioSource(parent);
+  }
+#endif
+  if (!choice.isEmpty() && choice != QStringLiteral("auto") && !availableAudioBackends().contains(choice)) {
+    qWarning("[qt6mplayer] Audio backend \"%s\" is unknown or not built in; selecting automatically.",
+             qPrintable(choice));
+  }
+
+#if defined(HAVE_PIPEWIRE)
   return new PipeWireAudioSource(parent);
+#elif defined(HAVE_JACK)
+  return new JackAudioSource(parent);
 #else
-  return new DummyAudioSource(parent);
+  return new SignalGeneratorAudioSource(parent);
+#endif
+}
+
+QStringList availableAudioBackends() {
+  QStringList backends{QStringLiteral("auto")};
+#ifdef HAVE_PIPEWIRE
+  backends << QStringLiteral("pipewire");
+#endif
+#ifdef HAVE_JACK
+  backends << QStringLiteral("jack");
 #endif
+  backends << QStringLiteral("file") << QStringLiteral("rtp") << QStringLiteral("local-pcm") << QStringLiteral("replay")
+           << QStringLiteral("generator");
+  return backends;
 }
@@ -1,6 +1,18 @@
 #pragma once
 
-class AudioSource;
+#include "AudioSource.h"
+
+#include <QStringList>
+
 class QObject;
 
-AudioSource *createAudioSource(QObject *parent = nullptr);
+// backend is "auto", "pipewire", "jack", "file", "rtp", "local-pcm", "replay" or "generator";
+// QT6MPLAYER_AUDIO_BACKEND overrides it, and "auto" picks the first compiled-in live backend.
+// Any other name is logged and treated as "auto".
+AudioSource *createAudioSource(QObject *parent = nullptr, const QString &backend = QString());
+// Backend ids this build can create, "auto" first.
+QStringList availableAudioBackends();
+
+// Parses "node.name=gain; other.node; default=0.5" into mix inputs. A missing
+// gain is 1.0 and "default" follows the graph default.
+QVector<AudioInputConfig> parseAudioInputList(const QString &text);
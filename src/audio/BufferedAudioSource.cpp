@@ -0,0 +1,130 @@
+#include "BufferedAudioSource.h"
+
+#include <algorithm>
+
+namespace {
+constexpr int kDrainIntervalMs = 8;
+} // namespace
+
+BufferedAudioSource::BufferedAudioSource(int ringCapacityFrames, QObject *parent)
+    : AudioSource(parent), m_ring(ringCapacityFrames, 2) {
+  m_drainBuffer.reserve(m_ring.capacityFrames() * m_ring.channels());
+  m_drainTimer.setInterval(kDrainIntervalMs);
+  m_drainTimer.setTimerType(Qt::PreciseTimer);
+  connect(&m_drainTimer, &QTimer::timeout, this, &BufferedAudioSource::drainCapturedFrames);
+}
+
+void BufferedAudioSource::setCaptureHistorySeconds(int seconds) {
+  m_historySeconds = std::max(0, seconds);
+  m_history.configure(m_historySeconds, m_sampleRate.load(), m_ring.channels());
+}
+
+bool BufferedAudioSource::saveCaptureHistory(const QString &filePath, QString *error) {
+  if (!m_history.isEnabled()) {
+    if (error != nullptr) {
+      *error = QStringLiteral("Capture history is disabled.");
+    }
+    return false;
+  }
+  return m_history.saveWav(filePath, error);
+}
+
+AudioCaptureStats BufferedAudioSource::captureStats() const {
+  AudioCaptureStats stats;
+  stats.capturedFrames = m_ring.writtenFrames();
+  stats.consumerDrops = m_ring.droppedFrames();
+  stats.maxQueueDepthFrames = m_maxQueueDepthFrames.load(std::memory_order_relaxed);
+  return stats;
+}
+
+AudioLevels BufferedAudioSource::levels() const { return m_levelMeter.snapshot(); }
+
+void BufferedAudioSource::setSilenceFloor(float amplitude) { m_levelMeter.setSilenceFloor(amplitude); }
+
+void BufferedAudioSource::startDraining() {
+  m_ring.reset();
+  m_levelMeter.reset();
+  m_fillGaps = false;
+  m_gapFrames = 0;
+  m_maxQueueDepthFrames = 0;
+  m_lastDrain.start();
+  m_drainTimer.start();
+}
+
+void BufferedAudioSource::stopDraining() {
+  m_drainTimer.stop();
+  m_fillGaps = false;
+}
+
+void BufferedAudioSource::setFillGaps(bool enabled) { m_fillGaps.store(enabled); }
+
+void BufferedAudioSource::meterCaptured(const float *stereo, int frames) {
+  m_levelMeter.process(stereo, frames, m_sampleRate.load(std::memory_order_relaxed));
+}
+
+void BufferedAudioSource::drainCapturedFrames() {
+  const int available = m_ring.availableFrames();
+  if (available <= 0) {
+    emitGapSilence();
+    return;
+  }
+  if (available > m_maxQueueDepthFrames.load(std::memory_order_relaxed)) {
+    m_maxQueueDepthFrames.store(available, std::memory_order_relaxed);
+  }
+
+  m_drainBuffer.resize(available * m_ring.channels());
+  const int frames = m_ring.read(m_drainBuffer.data(), available);
+  if (frames <= 0) {
+    return;
+  }
+  m_drainBuffer.resize(frames * m_ring.channels());
+  m_lastDrain.restart();
+  recordHistory();
+
+  PcmBlockInfo info;
+  info.sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+  const uint64_t endPosition = m_ring.readPosition();
+  info.samplePosition = endPosition + m_gapFrames - static_cast<uint64_t>(frames);
+  uint64_t anchorPosition = 0;
+  int64_t anchorTimestampNs = 0;
+  if (info.sampleRate > 0 && m_ring.timestampAnchor(&anchorPosition, &anchorTimestampNs) &&
+      anchorPosition >= endPosition) {
+    const auto framesAfterBlock = static_cast<int64_t>(anchorPosition - endPosition);
+    info.captureTimeNs = anchorTimestampNs - framesAfterBlock * 1000000000LL / info.sampleRate;
+  } else {
+    info.captureTimeNs = monotonicTimeNs();
+  }
+  Q_EMIT pcmFrameReady(m_drainBuffer, info);
+}
+
+void BufferedAudioSource::recordHistory() {
+  if (m_historySeconds <= 0) {
+    return;
+  }
+  // A rate change restarts the window so the saved file has a single rate.
+  m_history.configure(m_historySeconds, m_sampleRate.load(std::memory_order_relaxed), m_ring.channels());
+  m_history.append(m_drainBuffer.constData(), m_drainBuffer.size() / m_ring.channels());
+}
+
+void BufferedAudioSource::emitGapSilence() {
+  if (!m_fillGaps || !m_lastDrain.isValid()) {
+    return;
+  }
+
+  const qint64 elapsedMs = m_lastDrain.elapsed();
+  if (elapsedMs < kDrainIntervalMs) {
+    return;
+  }
+
+  const int frames = std::min<int>(static_cast<int>(elapsedMs * m_sampleRate.load() / 1000), m_ring.capacityFrames());
+  m_drainBuffer.fill(0.0f, frames * m_ring.channels());
+  m_lastDrain.restart();
+  recordHistory();
+
+  PcmBlockInfo info;
+  info.captureTimeNs = monotonicTimeNs();
+  info.samplePosition = m_ring.readPosition() + m_gapFrames;
+  m_gapFrames += static_cast<uint64_t>(frames);
+  info.sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+  Q_EMIT pcmFrameReady(m_drainBuffer, info);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "AudioSource.h"
+#include "CaptureHistory.h"
+#include "LevelMeter.h"
+#include "PcmRingBuffer.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include <atomic>
+#include <cstdint>
+
+// Base for sources whose samples arrive on a producer thread. The producer
+// writes stereo frames into m_ring; a GUI-thread timer drains them, dates
+// them and emits pcmFrameReady.
+class BufferedAudioSource : public AudioSource {
+  Q_OBJECT
+
+public:
+  void setCaptureHistorySeconds(int seconds) override;
+  bool saveCaptureHistory(const QString &filePath, QString *error) override;
+  AudioCaptureStats captureStats() const override;
+  AudioLevels levels() const override;
+  void setSilenceFloor(float amplitude) override;
+
+protected:
+  explicit BufferedAudioSource(int ringCapacityFrames, QObject *parent = nullptr);
+
+  void startDraining();
+  void stopDraining();
+  // While set, drain ticks with nothing captured emit silence instead of a gap.
+  void setFillGaps(bool enabled);
+  // Producer thread, next to each write of captured frames to m_ring.
+  void meterCaptured(const float *stereo, int frames);
+
+  PcmRingBuffer m_ring;
+  std::atomic<int> m_sampleRate{48000};
+
+private:
+  void drainCapturedFrames();
+  void emitGapSilence();
+  void recordHistory();
+
+  QVector<float> m_drainBuffer;
+  QTimer m_drainTimer;
+  QElapsedTimer m_lastDrain;
+  CaptureHistory m_history;
+  int m_historySeconds = 0;
+  std::atomic<bool> m_fillGaps{false};
+  // Frames of gap silence delivered so far, added to every ring position so
+  // captured blocks and gap silence read as one contiguous stream downstream.
+  uint64_t m_gapFrames = 0;
+  std::atomic<int> m_maxQueueDepthFrames{0};
+  LevelMeter m_levelMeter;
+};
@@ -0,0 +1,83 @@
+#include "CaptureHistory.h"
+
+#include "PcmFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+void CaptureHistory::configure(int seconds, int sampleRate, int channels) {
+  seconds = std::max(0, seconds);
+  if (seconds == m_seconds && sampleRate == m_sampleRate && channels == m_channels) {
+    return;
+  }
+
+  m_seconds = seconds;
+  m_sampleRate = sampleRate;
+  m_channels = channels;
+  m_capacityFrames = (seconds > 0 && sampleRate > 0 && channels > 0) ? seconds * sampleRate : 0;
+  m_samples.fill(0.0f, m_capacityFrames * std::max(0, channels));
+  m_writeFrame = 0;
+  m_storedFrames = 0;
+}
+
+bool CaptureHistory::isEnabled() const { return m_capacityFrames > 0; }
+
+void CaptureHistory::append(const float *interleaved, int frames) {
+  if (!isEnabled() || interleaved == nullptr || frames <= 0) {
+    return;
+  }
+
+  if (frames > m_capacityFrames) {
+    interleaved += static_cast<size_t>(frames - m_capacityFrames) * static_cast<size_t>(m_channels);
+    frames = m_capacityFrames;
+  }
+
+  const int firstPart = std::min(frames, m_capacityFrames - m_writeFrame);
+  std::memcpy(m_samples.data() + static_cast<size_t>(m_writeFrame) * m_channels,
+              interleaved,
+              static_cast<size_t>(firstPart) * m_channels * sizeof(float));
+  if (firstPart < frames) {
+    std::memcpy(m_samples.data(),
+                interleaved + static_cast<size_t>(firstPart) * m_channels,
+                static_cast<size_t>(frames - firstPart) * m_channels * sizeof(float));
+  }
+  m_writeFrame = (m_writeFrame + frames) % m_capacityFrames;
+  m_storedFrames = std::min(m_capacityFrames, m_storedFrames + frames);
+}
+
+QVector<float> CaptureHistory::snapshot() const {
+  QVector<float> out(m_storedFrames * m_channels);
+  if (m_storedFrames == 0) {
+    return out;
+  }
+
+  const int start = (m_writeFrame - m_storedFrames + m_capacityFrames) % m_capacityFrames;
+  const int firstPart = std::min(m_storedFrames, m_capacityFrames - start);
+  std::memcpy(out.data(),
+              m_samples.constData() + static_cast<size_t>(start) * m_channels,
+              static_cast<size_t>(firstPart) * m_channels * sizeof(float));
+  if (firstPart < m_storedFrames) {
+    std::memcpy(out.data() + static_cast<size_t>(firstPart) * m_channels,
+                m_samples.constData(),
+                static_cast<size_t>(m_storedFrames - firstPart) * m_channels * sizeof(float));
+  }
+  return out;
+}
+
+int CaptureHistory::storedFrames() const { return m_storedFrames; }
+
+int CaptureHistory::sampleRate() const { return m_sampleRate; }
+
+int CaptureHistory::channels() const { return m_channels; }
+
+bool CaptureHistory::saveWav(const QString &filePath, QString *error) const {
+  if (m_storedFrames == 0) {
+    if (error != nullptr) {
+      *error = QStringLiteral("No captured audio to save yet.");
+    }
+    return false;
+  }
+
+  const QVector<float> samples = snapshot();
+  return writeWavFile(filePath, samples.constData(), m_storedFrames, m_channels, m_sampleRate, error);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+// Rolling window of the most recent interleaved PCM a source delivered.
+// Owned and fed on the GUI thread, downstream of the capture ring.
+class CaptureHistory {
+public:
+  void configure(int seconds, int sampleRate, int channels);
+  bool isEnabled() const;
+
+  void append(const float *interleaved, int frames);
+  QVector<float> snapshot() const;
+  int storedFrames() const;
+  int sampleRate() const;
+  int channels() const;
+
+  bool saveWav(const QString &filePath, QString *error = nullptr) const;
+
+private:
+  QVector<float> m_samples;
+  int m_seconds = 0;
+  int m_sampleRate = 0;
+  int m_channels = 0;
+  int m_capacityFrames = 0;
+  int m_writeFrame = 0;
+  int m_storedFrames = 0;
+};
@@ -0,0 +1,568 @@
+#include "FileAudioSource.h"
+
+#include "AudioFileDecoder.h"
+#include "RtSafetyGuard.h"
+#include "SampleKernels.h"
+#include "ThreadPlacement.h"
+
+#ifdef HAVE_PIPEWIRE
+#include <pipewire/keys.h>
+#include <pipewire/pipewire.h>
+#include <spa/param/audio/format-utils.h>
+#include <spa/pod/builder.h>
+#endif
+
+#include <QFileInfo>
+#include <QMetaObject>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace {
+constexpr int kRingCapacityFrames = 65536;
+constexpr int kQueueCapacityFrames = 131072;
+constexpr int kDecodeChunkFrames = 4096;
+constexpr int kOutputBlockFrames = 512;
+constexpr int kIdleSleepMs = 5;
+constexpr int64_t kResyncLateNs = 1000000000LL;
+
+void idleSleep() { std::this_thread::sleep_for(std::chrono::milliseconds(kIdleSleepMs)); }
+} // namespace
+
+FileAudioSource::FileAudioSource(QObject *parent)
+    : BufferedAudioSource(kRingCapacityFrames, parent), m_decoded(kQueueCapacityFrames, 2) {}
+
+FileAudioSource::~FileAudioSource() { stop(); }
+
+bool FileAudioSource::start() {
+  if (m_running) {
+    return true;
+  }
+
+  int startTrack = 0;
+  bool playout = false;
+  {
+    const std::lock_guard<std::mutex> lock(m_tracksMutex);
+    if (m_tracks.isEmpty()) {
+      Q_EMIT errorMessage(QStringLiteral("File playback: no audio files selected."));
+      return false;
+    }
+    startTrack = m_startTrack;
+    playout = m_playout;
+  }
+
+  m_decoded.reset();
+  m_segmentPending = false;
+  m_flushRequested = false;
+  m_finished = false;
+  m_underruns = 0;
+  m_outputRate = 0;
+  m_heardTrack = startTrack;
+  m_heardFrame = 0;
+  m_heardTrackFrames = 0;
+  m_heardRate = 0;
+  m_heardSegment = Segment();
+  m_heardSegment.queueStart = m_decoded.readPosition();
+  m_seekRequest = -1;
+  m_jumpRequest = startTrack;
+#ifdef HAVE_PIPEWIRE
+  m_playoutWanted = playout;
+#else
+  m_playoutWanted = false;
+#endif
+
+  m_running = true;
+  startDraining();
+  m_clockThread = std::thread(&FileAudioSource::runClock, this);
+  m_decoderThread = std::thread(&FileAudioSource::runDecoder, this);
+#ifndef HAVE_PIPEWIRE
+  if (playout) {
+    Q_EMIT statusMessage(QStringLiteral("File playback: built without PipeWire, playing silently."));
+  }
+#endif
+  Q_EMIT statusMessage(QStringLiteral("Audio backend: file playback (%1)%2.")
+                           .arg(QFileInfo(trackAt(startTrack)).fileName(),
+                                m_playoutWanted ? QStringLiteral(" with PipeWire playout") : QString()));
+  return true;
+}
+
+void FileAudioSource::stop() {
+  m_running = false;
+  if (m_decoderThread.joinable()) {
+    m_decoderThread.join();
+  }
+  if (m_clockThread.joinable()) {
+    m_clockThread.join();
+  }
+#ifdef HAVE_PIPEWIRE
+  stopPlayout();
+#endif
+  stopDraining();
+}
+
+bool FileAudioSource::isRunning() const { return m_running.load(); }
+
+QString FileAudioSource::backendName() const { return QStringLiteral("Audio files"); }
+
+QVector<AudioDeviceInfo> FileAudioSource::availableDevices() const {
+  const QStringList paths = tracks();
+  QVector<AudioDeviceInfo> devices;
+  devices.reserve(paths.size());
+  for (qsizetype i = 0; i < paths.size(); ++i) {
+    AudioDeviceInfo device;
+    device.id = paths.at(i);
+    device.name = QStringLiteral("%1. %2").arg(i + 1).arg(QFileInfo(paths.at(i)).fileName());
+    device.description = paths.at(i);
+    devices.push_back(device);
+  }
+  return devices;
+}
+
+QString FileAudioSource::selectedDeviceId() const {
+  if (m_running) {
+    return trackAt(m_heardTrack.load());
+  }
+  const std::lock_guard<std::mutex> lock(m_tracksMutex);
+  return m_tracks.value(m_startTrack);
+}
+
+void FileAudioSource::setSelectedDeviceId(const QString &deviceId) {
+  // Ids saved for live backends are not in the track list and are ignored.
+  const std::lock_guard<std::mutex> lock(m_tracksMutex);
+  const qsizetype index = m_tracks.indexOf(deviceId);
+  if (index >= 0) {
+    m_startTrack = static_cast<int>(index);
+  }
+}
+
+bool FileAudioSource::retargetDevice(const QString &deviceId) {
+  qsizetype index = -1;
+  {
+    const std::lock_guard<std::mutex> lock(m_tracksMutex);
+    index = m_tracks.indexOf(deviceId);
+    if (index >= 0) {
+      m_startTrack = static_cast<int>(index);
+    }
+  }
+  if (index < 0) {
+    return false;
+  }
+  if (m_running) {
+    m_jumpRequest = static_cast<int>(index);
+  }
+  return true;
+}
+
+AudioLatencyInfo FileAudioSource::latencyInfo() const {
+  AudioLatencyInfo info;
+  info.requestedFrames = m_blockFrames.load();
+  info.quantumFrames = info.requestedFrames;
+  info.sampleRate = m_outputRate.load();
+  info.graphDelayMs = static_cast<double>(m_playoutDelayNs.load()) / 1000000.0;
+  return info;
+}
+
+AudioCaptureStats FileAudioSource::captureStats() const {
+  AudioCaptureStats stats = BufferedAudioSource::captureStats();
+  stats.xruns = m_underruns.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void FileAudioSource::setTracks(const QStringList &filePaths) {
+  {
+    const std::lock_guard<std::mutex> lock(m_tracksMutex);
+    const QString current = m_tracks.value(m_startTrack);
+    m_tracks = filePaths;
+    m_startTrack = static_cast<int>(std::max<qsizetype>(0, m_tracks.indexOf(current)));
+  }
+  Q_EMIT devicesChanged();
+}
+
+QStringList FileAudioSource::tracks() const {
+  const std::lock_guard<std::mutex> lock(m_tracksMutex);
+  return m_tracks;
+}
+
+void FileAudioSource::setPlayout(bool enabled) {
+  const std::lock_guard<std::mutex> lock(m_tracksMutex);
+  m_playout = enabled;
+}
+
+bool FileAudioSource::playout() const {
+  const std::lock_guard<std::mutex> lock(m_tracksMutex);
+  return m_playout;
+}
+
+double FileAudioSource::positionSeconds() const {
+  const int rate = m_heardRate.load();
+  return rate > 0 ? static_cast<double>(m_heardFrame.load()) / rate : 0.0;
+}
+
+double FileAudioSource::durationSeconds() const {
+  const int rate = m_heardRate.load();
+  return rate > 0 ? static_cast<double>(m_heardTrackFrames.load()) / rate : 0.0;
+}
+
+void FileAudioSource::seek(double seconds) {
+  const int rate = m_heardRate.load();
+  if (!m_running || rate <= 0) {
+    return;
+  }
+  // The decoder may already be into the next track; the seek targets the one heard.
+  m_seekTrack = m_heardTrack.load();
+  m_seekRequest = static_cast<int64_t>(std::max(0.0, seconds) * rate);
+}
+
+QString FileAudioSource::trackAt(int index) const {
+  const std::lock_guard<std::mutex> lock(m_tracksMutex);
+  return m_tracks.value(index);
+}
+
+bool FileAudioSource::hasPendingRequest() const { return m_jumpRequest.load() >= 0 || m_seekRequest.load() >= 0; }
+
+void FileAudioSource::runDecoder() {
+  const ThreadPlacementScope placement(ThreadRole::Worker, "file-decoder");
+  AudioFileDecoder decoder;
+  std::vector<float> raw;
+  std::vector<float> stereo(static_cast<size_t>(kDecodeChunkFrames) * 2U);
+  int track = -1;
+  bool endReported = true;
+
+  // Opens index, or the first track after it that can be opened.
+  const auto openFrom = [&](int index) {
+    for (QString path = trackAt(index); !path.isEmpty(); path = trackAt(++index)) {
+      QString error;
+      if (decoder.open(path, &error)) {
+        track = index;
+        raw.resize(static_cast<size_t>(kDecodeChunkFrames) * static_cast<size_t>(decoder.channels()));
+        return true;
+      }
+      postError(QStringLiteral("File playback: %1").arg(error));
+    }
+    decoder.close();
+    track = -1;
+    return false;
+  };
+  const auto segmentHere = [&]() {
+    Segment segment;
+    segment.queueStart = m_decoded.writtenFrames();
+    segment.track = track;
+    segment.fileFrame = decoder.position();
+    segment.trackFrames = decoder.frameCount();
+    segment.sampleRate = decoder.sampleRate();
+    return segment;
+  };
+
+  while (m_running) {
+    const int jump = m_jumpRequest.exchange(-1);
+    const int64_t seekFrame = m_seekRequest.exchange(-1);
+    if (jump >= 0 || seekFrame >= 0) {
+      const int target = jump >= 0 ? jump : m_seekTrack.load();
+      const bool reuse = jump < 0 && decoder.isOpen() && target == track;
+      if (!reuse && !openFrom(target)) {
+        m_finished = true;
+        endReported = false;
+        continue;
+      }
+      if (jump < 0) {
+        decoder.seek(seekFrame);
+      }
+      m_finished = false;
+      endReported = false;
+      flushQueue(segmentHere());
+      continue;
+    }
+
+    if (!decoder.isOpen()) {
+      if (!endReported && m_decoded.availableFrames() == 0) {
+        endReported = true;
+        postStatus(QStringLiteral("File playback: reached the end of the track list."));
+      }
+      idleSleep();
+      continue;
+    }
+    if (m_decoded.capacityFrames() - m_decoded.availableFrames() < kDecodeChunkFrames) {
+      idleSleep();
+      continue;
+    }
+
+    const int frames = decoder.read(raw.data(), kDecodeChunkFrames);
+    if (frames > 0) {
+      if (decoder.channels() == 2) {
+        m_decoded.write(raw.data(), frames);
+      } else {
+        sampleKernels().interleavedToStereo(raw.data(), stereo.data(), frames, decoder.channels());
+        m_decoded.write(stereo.data(), frames);
+      }
+      continue;
+    }
+
+    // End of a track: queue the next one straight behind it.
+    const int previousRate = decoder.sampleRate();
+    if (!openFrom(track + 1)) {
+      m_finished = true;
+      continue;
+    }
+    // The queue holds one rate at a time, so a rate change waits for the
+    // previous track to play out and costs one output restart.
+    const bool rateChanges = decoder.sampleRate() != previousRate;
+    while (m_running && !hasPendingRequest() &&
+           (m_segmentPending.load(std::memory_order_acquire) || (rateChanges && m_decoded.availableFrames() > 0))) {
+      idleSleep();
+    }
+    if (!m_running || hasPendingRequest()) {
+      continue;
+    }
+    if (rateChanges) {
+      flushQueue(segmentHere());
+    } else {
+      m_pendingSegment = segmentHere();
+      m_segmentPending.store(true, std::memory_order_release);
+    }
+  }
+}
+
+// Discards everything queued and makes segment current at the output.
+void FileAudioSource::flushQueue(const Segment &segment) {
+  if (segment.sampleRate != m_outputRate.load()) {
+    changeOutputRate(segment.sampleRate);
+  }
+  m_flushSegment = segment;
+  m_flushRequested.store(true, std::memory_order_release);
+  while (m_running && m_flushRequested.load(std::memory_order_acquire)) {
+    idleSleep();
+  }
+}
+
+void FileAudioSource::changeOutputRate(int sampleRate) {
+  m_sampleRate = sampleRate;
+#ifdef HAVE_PIPEWIRE
+  if (m_playoutWanted) {
+    bool connected = false;
+    if (m_playoutLoop == nullptr) {
+      connected = startPlayout(sampleRate);
+    } else {
+      pw_thread_loop_lock(m_playoutLoop);
+      pw_stream_disconnect(m_playoutStream);
+      connected = connectPlayout(sampleRate) >= 0;
+      pw_thread_loop_unlock(m_playoutLoop);
+    }
+    if (connected) {
+      m_outputRate = sampleRate;
+      return;
+    }
+    m_playoutWanted = false;
+    stopPlayout();
+    postError(QStringLiteral("File playback: PipeWire playout failed, continuing without output."));
+  }
+#endif
+  m_outputRate = sampleRate;
+}
+
+void FileAudioSource::runClock() {
+  const ThreadPlacementScope placement(ThreadRole::Capture, "file-clock");
+  std::vector<float> block(static_cast<size_t>(kOutputBlockFrames) * 2U);
+  int64_t startNs = 0;
+  uint64_t played = 0;
+  uint64_t rate = 0;
+
+  while (m_running) {
+    const int outputRate = m_outputRate.load();
+    if (outputRate <= 0 || m_playoutActive.load()) {
+      rate = 0;
+      idleSleep();
+      continue;
+    }
+    if (static_cast<uint64_t>(outputRate) != rate) {
+      rate = static_cast<uint64_t>(outputRate);
+      startNs = monotonicTimeNs();
+      played = 0;
+      m_blockFrames = kOutputBlockFrames;
+      m_playoutDelayNs = 0;
+    }
+
+    played += kOutputBlockFrames;
+    int64_t dueNs = startNs + static_cast<int64_t>((played / rate) * 1000000000ULL + (played % rate) * 1000000000ULL / rate);
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(dueNs)));
+    const int64_t lateNs = monotonicTimeNs() - dueNs;
+    if (lateNs > kResyncLateNs) {
+      startNs += lateNs;
+      dueNs += lateNs;
+    }
+    pullFrames(block.data(), kOutputBlockFrames, dueNs - static_cast<int64_t>(1000000000ULL / rate));
+  }
+}
+
+// Output side of the queue, on the clock thread or the PipeWire data
+// thread: fills stereo from the decoder, pads underflow with silence and
+// passes the same frames on to the capture ring.
+int FileAudioSource::pullFrames(float *stereo, int frames, int64_t lastFrameTimeNs) {
+  if (m_flushRequested.load(std::memory_order_acquire)) {
+    m_decoded.reset();
+    m_segmentPending.store(false, std::memory_order_relaxed);
+    m_heardSegment = m_flushSegment;
+    m_heardSegment.queueStart = m_decoded.readPosition();
+    m_heardTrack = m_heardSegment.track;
+    m_heardTrackFrames = m_heardSegment.trackFrames;
+    m_heardRate = m_heardSegment.sampleRate;
+    m_flushRequested.store(false, std::memory_order_release);
+  }
+
+  const int got = m_decoded.read(stereo, frames);
+  const uint64_t readPosition = m_decoded.readPosition();
+  if (m_segmentPending.load(std::memory_order_acquire) && readPosition >= m_pendingSegment.queueStart) {
+    m_heardSegment = m_pendingSegment;
+    m_heardTrack = m_heardSegment.track;
+    m_heardTrackFrames = m_heardSegment.trackFrames;
+    m_heardRate = m_heardSegment.sampleRate;
+    m_segmentPending.store(false, std::memory_order_release);
+  }
+  m_heardFrame = m_heardSegment.fileFrame + static_cast<int64_t>(readPosition - m_heardSegment.queueStart);
+
+  if (got < frames) {
+    std::memset(stereo + 2 * got, 0, static_cast<size_t>(frames - got) * 2U * sizeof(float));
+    if (!m_finished.load(std::memory_order_relaxed)) {
+      m_underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  m_ring.write(stereo, frames);
+  meterCaptured(stereo, frames);
+  m_ring.markTimestamp(lastFrameTimeNs);
+  return got;
+}
+
+void FileAudioSource::postStatus(const QString &message) {
+  QMetaObject::invokeMethod(this, [this, message]() { Q_EMIT statusMessage(message); }, Qt::QueuedConnection);
+}
+
+void FileAudioSource::postError(const QString &message) {
+  QMetaObject::invokeMethod(this, [this, message]() { Q_EMIT errorMessage(message); }, Qt::QueuedConnection);
+}
+
+#ifdef HAVE_PIPEWIRE
+void FileAudioSource::onPlayoutProcess(void *userdata) {
+  auto *self = static_cast<FileAudioSource *>(userdata);
+  const RtSection section;
+  if (self->m_outputThreadId.load(std::memory_order_relaxed) == 0) {
+    self->m_outputThreadId = currentThreadId();
+    registerThread(self->m_outputThreadId, ThreadRole::Capture, "file-playout");
+  }
+
+  pw_buffer *buffer = pw_stream_dequeue_buffer(self->m_playoutStream);
+  if (buffer == nullptr || buffer->buffer == nullptr || buffer->buffer->n_datas == 0) {
+    return;
+  }
+  spa_data &data = buffer->buffer->datas[0];
+  if (data.data == nullptr || data.chunk == nullptr) {
+    pw_stream_queue_buffer(self->m_playoutStream, buffer);
+    return;
+  }
+
+  constexpr int kStride = 2 * sizeof(float);
+  int frames = static_cast<int>(data.maxsize / kStride);
+  if (buffer->requested > 0) {
+    frames = std::min<int>(frames, static_cast<int>(buffer->requested));
+  }
+
+  // These frames reach the speaker once the graph delay queued ahead of
+  // them has played, which is when the visuals should show them.
+  const int sampleRate = self->m_outputRate.load(std::memory_order_relaxed);
+  int64_t lastFrameTimeNs = monotonicTimeNs();
+  pw_time time = {};
+  if (pw_stream_get_time_n(self->m_playoutStream, &time, sizeof(time)) == 0 && time.rate.denom > 0) {
+    int64_t delayNs = time.delay * SPA_NSEC_PER_SEC * time.rate.num / time.rate.denom;
+    if (sampleRate > 0) {
+      delayNs += static_cast<int64_t>(time.buffered) * SPA_NSEC_PER_SEC / sampleRate;
+    }
+    self->m_playoutDelayNs.store(delayNs, std::memory_order_relaxed);
+    if (time.now > 0) {
+      lastFrameTimeNs = time.now + delayNs;
+    }
+  }
+  if (sampleRate > 0 && frames > 0) {
+    lastFrameTimeNs += static_cast<int64_t>(frames - 1) * SPA_NSEC_PER_SEC / sampleRate;
+  }
+
+  self->pullFrames(static_cast<float *>(data.data), frames, lastFrameTimeNs);
+  data.chunk->offset = 0;
+  data.chunk->stride = kStride;
+  data.chunk->size = static_cast<uint32_t>(frames * kStride);
+  pw_stream_queue_buffer(self->m_playoutStream, buffer);
+}
+
+bool FileAudioSource::startPlayout(int sampleRate) {
+  pw_init(nullptr, nullptr);
+  m_playoutLoop = pw_thread_loop_new("qt6mplayer-playout", nullptr);
+  if (m_playoutLoop == nullptr) {
+    pw_deinit();
+    return false;
+  }
+
+  static const pw_stream_events streamEvents = [] {
+    pw_stream_events events = {};
+    events.version = PW_VERSION_STREAM_EVENTS;
+    events.process = &FileAudioSource::onPlayoutProcess;
+    return events;
+  }();
+
+  // The output owns the queue from here on; the clock thread stands down.
+  m_playoutActive = true;
+  pw_thread_loop_lock(m_playoutLoop);
+  m_playoutStream = pw_stream_new_simple(pw_thread_loop_get_loop(m_playoutLoop),
+                                         "qt6mplayer-playout",
+                                         pw_properties_new(PW_KEY_MEDIA_TYPE,
+                                                           "Audio",
+                                                           PW_KEY_MEDIA_CATEGORY,
+                                                           "Playback",
+                                                           PW_KEY_MEDIA_ROLE,
+                                                           "Music",
+                                                           PW_KEY_APP_NAME,
+                                                           "qt6mplayer",
+                                                           nullptr),
+                                         &streamEvents,
+                                         this);
+  const bool connected = m_playoutStream != nullptr && connectPlayout(sampleRate) >= 0;
+  pw_thread_loop_unlock(m_playoutLoop);
+  return connected && pw_thread_loop_start(m_playoutLoop) >= 0;
+}
+
+int FileAudioSource::connectPlayout(int sampleRate) {
+  uint8_t paramsBuffer[512];
+  spa_pod_builder builder = SPA_POD_BUILDER_INIT(paramsBuffer, sizeof(paramsBuffer));
+  spa_audio_info_raw format = {};
+  format.format = SPA_AUDIO_FORMAT_F32;
+  format.rate = static_cast<uint32_t>(sampleRate);
+  format.channels = 2;
+  format.position[0] = SPA_AUDIO_CHANNEL_FL;
+  format.position[1] = SPA_AUDIO_CHANNEL_FR;
+  const spa_pod *params[1] = {spa_format_audio_raw_build(&builder, SPA_PARAM_EnumFormat, &format)};
+
+  return pw_stream_connect(
+      m_playoutStream,
+      PW_DIRECTION_OUTPUT,
+      PW_ID_ANY,
+      static_cast<pw_stream_flags>(PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_MAP_BUFFERS |
+                                   PW_STREAM_FLAG_RT_PROCESS),
+      params,
+      1);
+}
+
+void FileAudioSource::stopPlayout() {
+  if (m_playoutLoop == nullptr) {
+    return;
+  }
+  pw_thread_loop_stop(m_playoutLoop);
+  if (m_playoutStream != nullptr) {
+    pw_stream_destroy(m_playoutStream);
+    m_playoutStream = nullptr;
+  }
+  pw_thread_loop_destroy(m_playoutLoop);
+  m_playoutLoop = nullptr;
+  unregisterThread(m_outputThreadId.exchange(0));
+  m_playoutDelayNs = 0;
+  m_playoutActive = false;
+  pw_deinit();
+}
+#endif
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "BufferedAudioSource.h"
+#include "PcmRingBuffer.h"
+
+#ifdef HAVE_PIPEWIRE
+#include <pipewire/stream.h>
+#include <pipewire/thread-loop.h>
+#endif
+
+#include <QStringList>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Plays a list of audio files into the visualizer. A decoder thread reads
+// ahead into a bounded queue of stereo frames; an output stage takes one
+// block per period from it, either paced by its own clock or pulled by a
+// PipeWire playback stream when playout is on, and hands the same frames
+// to the capture ring dated by when they are heard. Tracks follow each
+// other without a gap unless the sample rate changes. Device ids are the
+// file paths of the track list.
+class FileAudioSource : public BufferedAudioSource {
+  Q_OBJECT
+
+public:
+  explicit FileAudioSource(QObject *parent = nullptr);
+  ~FileAudioSource() override;
+
+  bool start() override;
+  void stop() override;
+  bool isRunning() const override;
+  QString backendName() const override;
+  QVector<AudioDeviceInfo> availableDevices() const override;
+  QString selectedDeviceId() const override;
+  void setSelectedDeviceId(const QString &deviceId) override;
+  bool retargetDevice(const QString &deviceId) override;
+  AudioLatencyInfo latencyInfo() const override;
+  AudioCaptureStats captureStats() const override;
+
+  void setTracks(const QStringList &filePaths);
+  QStringList tracks() const;
+  // Takes effect on the next start().
+  void setPlayout(bool enabled);
+  bool playout() const;
+
+  // Position of the frames last handed to the output, not of the decoder.
+  double positionSeconds() const;
+  double durationSeconds() const;
+  void seek(double seconds);
+
+private:
+  // Where a run of frames from one track starts in m_decoded.
+  struct Segment {
+    uint64_t queueStart = 0;
+    int track = 0;
+    int64_t fileFrame = 0;
+    int64_t trackFrames = 0;
+    int sampleRate = 0;
+  };
+
+  void runDecoder();
+  void runClock();
+  QString trackAt(int index) const;
+  bool hasPendingRequest() const;
+  void flushQueue(const Segment &segment);
+  void changeOutputRate(int sampleRate);
+  int pullFrames(float *stereo, int frames, int64_t lastFrameTimeNs);
+  void postStatus(const QString &message);
+  void postError(const QString &message);
+
+#ifdef HAVE_PIPEWIRE
+  static void onPlayoutProcess(void *userdata);
+  bool startPlayout(int sampleRate);
+  int connectPlayout(int sampleRate);
+  void stopPlayout();
+
+  pw_thread_loop *m_playoutLoop = nullptr;
+  pw_stream *m_playoutStream = nullptr;
+#endif
+
+  mutable std::mutex m_tracksMutex;
+  QStringList m_tracks;
+  int m_startTrack = 0;
+  bool m_playout = false;
+
+  std::atomic<bool> m_running{false};
+  std::thread m_decoderThread;
+  std::thread m_clockThread;
+  std::atomic<bool> m_playoutWanted{false};
+  std::atomic<bool> m_playoutActive{false};
+  std::atomic<int> m_outputRate{0};
+  std::atomic<int> m_blockFrames{512};
+  std::atomic<int64_t> m_playoutDelayNs{0};
+  std::atomic<int> m_outputThreadId{0};
+
+  // Decoder to output handoff. m_decoded only ever holds frames of one
+  // sample rate; the decoder drains it before switching.
+  PcmRingBuffer m_decoded;
+  Segment m_pendingSegment;
+  std::atomic<bool> m_segmentPending{false};
+  std::atomic<bool> m_flushRequested{false};
+  Segment m_flushSegment;
+  std::atomic<bool> m_finished{false};
+  std::atomic<uint64_t> m_underruns{0};
+
+  std::atomic<int> m_jumpRequest{-1};
+  std::atomic<int> m_seekTrack{0};
+  std::atomic<int64_t> m_seekRequest{-1};
+
+  // What the output is playing, for the GUI.
+  std::atomic<int> m_heardTrack{0};
+  std::atomic<int64_t> m_heardFrame{0};
+  std::atomic<int64_t> m_heardTrackFrames{0};
+  std::atomic<int> m_heardRate{0};
+  Segment m_heardSegment;
+};
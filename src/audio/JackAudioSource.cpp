@@ -0,0 +1,339 @@
+#include "JackAudioSource.h"
+
+#include "RtSafetyGuard.h"
+#include "ThreadPlacement.h"
+
+#include <QMap>
+#include <QMetaObject>
+#include <QPair>
+
+#include <algorithm>
+
+namespace {
+constexpr int kRingCapacityFrames = 65536;
+constexpr int kMaxPeriodFrames = 8192;
+constexpr char kClientName[] = "qt6mplayer";
+} // namespace
+
+JackAudioSource::JackAudioSource(QObject *parent) : BufferedAudioSource(kRingCapacityFrames, parent) {
+  m_interleaved.assign(static_cast<size_t>(kMaxPeriodFrames) * 2U, 0.0f);
+}
+
+JackAudioSource::~JackAudioSource() { stop(); }
+
+bool JackAudioSource::start() {
+#ifdef HAVE_JACK
+  if (m_running) {
+    return true;
+  }
+
+  jack_status_t status = {};
+  m_client = jack_client_open(kClientName, JackNoStartServer, &status);
+  if (m_client == nullptr) {
+    Q_EMIT errorMessage(
+        QStringLiteral("JACK server not reachable (status 0x%1).").arg(static_cast<unsigned>(status), 0, 16));
+    return false;
+  }
+
+  m_ports[0] = jack_port_register(m_client, "in_l", JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0);
+  m_ports[1] = jack_port_register(m_client, "in_r", JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0);
+  if (m_ports[0] == nullptr || m_ports[1] == nullptr) {
+    closeClient();
+    Q_EMIT errorMessage(QStringLiteral("Failed to register JACK input ports."));
+    return false;
+  }
+
+  jack_set_process_callback(m_client, &JackAudioSource::onProcess, this);
+  jack_set_xrun_callback(m_client, &JackAudioSource::onXrun, this);
+  jack_set_buffer_size_callback(m_client, &JackAudioSource::onBufferSize, this);
+  jack_set_sample_rate_callback(m_client, &JackAudioSource::onSampleRate, this);
+  jack_set_latency_callback(m_client, &JackAudioSource::onLatency, this);
+  jack_set_port_registration_callback(m_client, &JackAudioSource::onPortRegistration, this);
+  jack_on_shutdown(m_client, &JackAudioSource::onShutdown, this);
+
+  m_sampleRate = static_cast<int>(jack_get_sample_rate(m_client));
+  m_bufferFrames = static_cast<int>(jack_get_buffer_size(m_client));
+  m_callbackCount = 0;
+  m_emptyBufferCount = 0;
+  m_xrunCount = 0;
+  m_devicesDirty = true;
+
+  startDraining();
+  if (jack_activate(m_client) != 0) {
+    stopDraining();
+    closeClient();
+    Q_EMIT errorMessage(QStringLiteral("Failed to activate the JACK client."));
+    return false;
+  }
+  m_running = true;
+
+  const int requestedFrames = m_requestedLatencyFrames.load();
+  if (requestedFrames > 0 && requestedFrames != m_bufferFrames.load()) {
+    jack_set_buffer_size(m_client, static_cast<jack_nframes_t>(requestedFrames));
+  }
+  const int connected = connectCapturePorts(selectedDeviceId());
+  Q_EMIT statusMessage(QStringLiteral("Audio backend: JACK (%1 frames @ %2 Hz, %3 ports connected).")
+                           .arg(m_bufferFrames.load())
+                           .arg(m_sampleRate.load())
+                           .arg(connected));
+  return true;
+#else
+  Q_EMIT errorMessage(QStringLiteral("JACK backend was not compiled in."));
+  return false;
+#endif
+}
+
+void JackAudioSource::stop() {
+  m_running = false;
+#ifdef HAVE_JACK
+  if (m_client != nullptr) {
+    jack_deactivate(m_client);
+    closeClient();
+  }
+#endif
+  stopDraining();
+}
+
+bool JackAudioSource::isRunning() const { return m_running.load(); }
+
+QString JackAudioSource::backendName() const { return QStringLiteral("JACK"); }
+
+QVector<AudioDeviceInfo> JackAudioSource::availableDevices() const {
+  std::lock_guard<std::mutex> lock(m_deviceMutex);
+#ifdef HAVE_JACK
+  if (m_client == nullptr || !m_devicesDirty.exchange(false)) {
+    return m_deviceSnapshot;
+  }
+
+  // One entry per client that has audio outputs; its ports are connected in order.
+  QMap<QString, QPair<int, bool>> clients;
+  const char **ports = jack_get_ports(m_client, nullptr, JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput);
+  for (int i = 0; ports != nullptr && ports[i] != nullptr; ++i) {
+    const QString portName = QString::fromUtf8(ports[i]);
+    const QString clientName = portName.section(QLatin1Char(':'), 0, 0);
+    jack_port_t *port = jack_port_by_name(m_client, ports[i]);
+    const bool physical = port != nullptr && (jack_port_flags(port) & JackPortIsPhysical) != 0;
+    QPair<int, bool> &entry = clients[clientName];
+    entry.first += 1;
+    entry.second = entry.second || physical;
+  }
+  if (ports != nullptr) {
+    jack_free(ports);
+  }
+
+  m_deviceSnapshot.clear();
+  for (auto it = clients.cbegin(); it != clients.cend(); ++it) {
+    AudioDeviceInfo device;
+    device.id = it.key();
+    device.name = it.key();
+    device.description = QStringLiteral("JACK client, %1 audio output%2%3")
+                             .arg(it.value().first)
+                             .arg(it.value().first == 1 ? QString() : QStringLiteral("s"))
+                             .arg(it.value().second ? QStringLiteral(" (physical)") : QString());
+    m_deviceSnapshot.push_back(device);
+  }
+#endif
+  return m_deviceSnapshot;
+}
+
+QString JackAudioSource::selectedDeviceId() const {
+  std::lock_guard<std::mutex> lock(m_deviceMutex);
+  return m_selectedDeviceId;
+}
+
+void JackAudioSource::setSelectedDeviceId(const QString &deviceId) {
+  std::lock_guard<std::mutex> lock(m_deviceMutex);
+  m_selectedDeviceId = deviceId.trimmed();
+}
+
+bool JackAudioSource::retargetDevice(const QString &deviceId) {
+#ifdef HAVE_JACK
+  if (!m_running || m_client == nullptr) {
+    return false;
+  }
+  setSelectedDeviceId(deviceId);
+  connectCapturePorts(selectedDeviceId());
+  return true;
+#else
+  Q_UNUSED(deviceId);
+  return false;
+#endif
+}
+
+void JackAudioSource::setRequestedLatencyFrames(int frames) {
+  frames = std::max(0, frames);
+  if (m_requestedLatencyFrames.exchange(frames) == frames) {
+    return;
+  }
+#ifdef HAVE_JACK
+  if (m_running && m_client != nullptr && frames > 0) {
+    if (jack_set_buffer_size(m_client, static_cast<jack_nframes_t>(frames)) == 0) {
+      Q_EMIT statusMessage(QStringLiteral("JACK period set to %1 frames for the whole server.").arg(frames));
+    } else {
+      Q_EMIT statusMessage(QStringLiteral("JACK server refused a %1 frame period.").arg(frames));
+    }
+  }
+#endif
+}
+
+AudioLatencyInfo JackAudioSource::latencyInfo() const {
+  AudioLatencyInfo info;
+  info.requestedFrames = m_requestedLatencyFrames.load();
+  info.quantumFrames = m_bufferFrames.load(std::memory_order_relaxed);
+  info.sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+  if (info.sampleRate > 0) {
+    info.graphDelayMs = m_captureLatencyFrames.load(std::memory_order_relaxed) * 1000.0 / info.sampleRate;
+  }
+  return info;
+}
+
+AudioCaptureStats JackAudioSource::captureStats() const {
+  AudioCaptureStats stats = BufferedAudioSource::captureStats();
+  stats.callbacks = m_callbackCount.load(std::memory_order_relaxed);
+  stats.emptyBuffers = m_emptyBufferCount.load(std::memory_order_relaxed);
+  stats.xruns = m_xrunCount.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void JackAudioSource::handleServerShutdown() {
+  if (!m_running) {
+    return;
+  }
+  m_running = false;
+#ifdef HAVE_JACK
+  closeClient();
+#endif
+  stopDraining();
+  Q_EMIT errorMessage(QStringLiteral("JACK server shut down."));
+}
+
+#ifdef HAVE_JACK
+int JackAudioSource::onProcess(jack_nframes_t frames, void *userdata) {
+  auto *self = static_cast<JackAudioSource *>(userdata);
+  const RtSection section;
+  self->m_callbackCount.fetch_add(1, std::memory_order_relaxed);
+  if (self->m_processThreadId.load(std::memory_order_relaxed) == 0) {
+    self->m_processThreadId = currentThreadId();
+    registerThread(self->m_processThreadId, ThreadRole::Capture, "jack-process");
+  }
+
+  const auto *left = static_cast<const float *>(jack_port_get_buffer(self->m_ports[0], frames));
+  const auto *right = static_cast<const float *>(jack_port_get_buffer(self->m_ports[1], frames));
+  if (left == nullptr || right == nullptr || frames == 0) {
+    self->m_emptyBufferCount.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+  }
+
+  // The period was complete at the start of this cycle and reached our
+  // ports one capture latency after it entered the hardware.
+  const int sampleRate = self->m_sampleRate.load(std::memory_order_relaxed);
+  int64_t captureTimeNs = monotonicTimeNs();
+  if (sampleRate > 0) {
+    const int64_t lateFrames = static_cast<int64_t>(jack_frames_since_cycle_start(self->m_client)) +
+                               self->m_captureLatencyFrames.load(std::memory_order_relaxed);
+    captureTimeNs -= lateFrames * 1000000000LL / sampleRate;
+  }
+
+  float *interleaved = self->m_interleaved.data();
+  for (jack_nframes_t done = 0; done < frames;) {
+    const int chunk = static_cast<int>(std::min<jack_nframes_t>(frames - done, kMaxPeriodFrames));
+    for (int i = 0; i < chunk; ++i) {
+      interleaved[2 * i] = left[done + i];
+      interleaved[2 * i + 1] = right[done + i];
+    }
+    self->m_ring.write(interleaved, chunk);
+    self->meterCaptured(interleaved, chunk);
+    done += static_cast<jack_nframes_t>(chunk);
+  }
+  self->m_ring.markTimestamp(captureTimeNs);
+  return 0;
+}
+
+int JackAudioSource::onXrun(void *userdata) {
+  static_cast<JackAudioSource *>(userdata)->m_xrunCount.fetch_add(1, std::memory_order_relaxed);
+  return 0;
+}
+
+int JackAudioSource::onBufferSize(jack_nframes_t frames, void *userdata) {
+  static_cast<JackAudioSource *>(userdata)->m_bufferFrames.store(static_cast<int>(frames), std::memory_order_relaxed);
+  return 0;
+}
+
+int JackAudioSource::onSampleRate(jack_nframes_t rate, void *userdata) {
+  static_cast<JackAudioSource *>(userdata)->m_sampleRate.store(static_cast<int>(rate), std::memory_order_relaxed);
+  return 0;
+}
+
+void JackAudioSource::onLatency(jack_latency_callback_mode_t mode, void *userdata) {
+  auto *self = static_cast<JackAudioSource *>(userdata);
+  if (mode != JackCaptureLatency || self->m_ports[0] == nullptr) {
+    return;
+  }
+  jack_latency_range_t range = {};
+  jack_port_get_latency_range(self->m_ports[0], JackCaptureLatency, &range);
+  self->m_captureLatencyFrames.store(static_cast<int>(range.max), std::memory_order_relaxed);
+}
+
+void JackAudioSource::onPortRegistration(jack_port_id_t port, int registered, void *userdata) {
+  Q_UNUSED(port);
+  Q_UNUSED(registered);
+  auto *self = static_cast<JackAudioSource *>(userdata);
+  self->m_devicesDirty = true;
+  QMetaObject::invokeMethod(self, [self]() { Q_EMIT self->devicesChanged(); }, Qt::QueuedConnection);
+}
+
+void JackAudioSource::onShutdown(void *userdata) {
+  auto *self = static_cast<JackAudioSource *>(userdata);
+  QMetaObject::invokeMethod(self, [self]() { self->handleServerShutdown(); }, Qt::QueuedConnection);
+}
+
+// Runs on the GUI thread; JACK makes the connections from its own threads.
+int JackAudioSource::connectCapturePorts(const QString &deviceId) {
+  if (m_client == nullptr) {
+    return 0;
+  }
+  jack_port_disconnect(m_client, m_ports[0]);
+  jack_port_disconnect(m_client, m_ports[1]);
+
+  const unsigned long flags = deviceId.isEmpty() ? (JackPortIsOutput | JackPortIsPhysical) : JackPortIsOutput;
+  const char **ports = jack_get_ports(m_client, nullptr, JACK_DEFAULT_AUDIO_TYPE, flags);
+  QVector<QByteArray> sources;
+  const QString clientPrefix = deviceId + QLatin1Char(':');
+  for (int i = 0; ports != nullptr && ports[i] != nullptr && sources.size() < 2; ++i) {
+    const QString portName = QString::fromUtf8(ports[i]);
+    if (deviceId.isEmpty() || portName == deviceId || portName.startsWith(clientPrefix)) {
+      sources.push_back(QByteArray(ports[i]));
+    }
+  }
+  if (ports != nullptr) {
+    jack_free(ports);
+  }
+
+  if (sources.isEmpty() && !deviceId.isEmpty()) {
+    // Ids saved for other backends land here too; capture the hardware instead.
+    Q_EMIT statusMessage(QStringLiteral("No JACK audio outputs match \"%1\"; using physical capture ports.").arg(deviceId));
+    return connectCapturePorts(QString());
+  }
+  if (sources.isEmpty()) {
+    Q_EMIT statusMessage(QStringLiteral("JACK has no physical capture ports; inputs left unconnected."));
+    return 0;
+  }
+  // A mono source feeds both channels.
+  for (int channel = 0; channel < 2; ++channel) {
+    const QByteArray &source = sources.at(std::min<qsizetype>(channel, sources.size() - 1));
+    jack_connect(m_client, source.constData(), jack_port_name(m_ports[channel]));
+  }
+  return static_cast<int>(sources.size());
+}
+
+void JackAudioSource::closeClient() {
+  if (m_client != nullptr) {
+    jack_client_close(m_client);
+  }
+  m_client = nullptr;
+  unregisterThread(m_processThreadId.exchange(0));
+  m_ports[0] = nullptr;
+  m_ports[1] = nullptr;
+  m_devicesDirty = true;
+}
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "BufferedAudioSource.h"
+
+#ifdef HAVE_JACK
+#include <jack/jack.h>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Captures through a JACK client with two input ports. A device id is
+// either a JACK client name, whose first two audio outputs are connected,
+// or a single full port name; empty connects the physical capture ports.
+// The process callback interleaves into preallocated scratch and hands
+// the block to the ring like the PipeWire path.
+class JackAudioSource : public BufferedAudioSource {
+  Q_OBJECT
+
+public:
+  explicit JackAudioSource(QObject *parent = nullptr);
+  ~JackAudioSource() override;
+
+  bool start() override;
+  void stop() override;
+  bool isRunning() const override;
+  QString backendName() const override;
+  QVector<AudioDeviceInfo> availableDevices() const override;
+  QString selectedDeviceId() const override;
+  void setSelectedDeviceId(const QString &deviceId) override;
+  bool retargetDevice(const QString &deviceId) override;
+  // JACK periods are server-wide, so a request resizes the whole graph.
+  void setRequestedLatencyFrames(int frames) override;
+  AudioLatencyInfo latencyInfo() const override;
+  AudioCaptureStats captureStats() const override;
+
+private:
+#ifdef HAVE_JACK
+  static int onProcess(jack_nframes_t frames, void *userdata);
+  static int onXrun(void *userdata);
+  static int onBufferSize(jack_nframes_t frames, void *userdata);
+  static int onSampleRate(jack_nframes_t rate, void *userdata);
+  static void onLatency(jack_latency_callback_mode_t mode, void *userdata);
+  static void onPortRegistration(jack_port_id_t port, int registered, void *userdata);
+  static void onShutdown(void *userdata);
+  int connectCapturePorts(const QString &deviceId);
+  void closeClient();
+
+  jack_client_t *m_client = nullptr;
+  jack_port_t *m_ports[2] = {nullptr, nullptr};
+#endif
+  void handleServerShutdown();
+
+  std::atomic<bool> m_running{false};
+  mutable std::mutex m_deviceMutex;
+  QString m_selectedDeviceId;
+  mutable QVector<AudioDeviceInfo> m_deviceSnapshot;
+  mutable std::atomic<bool> m_devicesDirty{true};
+
+  std::vector<float> m_interleaved;
+  std::atomic<int> m_requestedLatencyFrames{0};
+  std::atomic<int> m_bufferFrames{0};
+  std::atomic<int> m_captureLatencyFrames{0};
+  std::atomic<uint64_t> m_callbackCount{0};
+  std::atomic<uint64_t> m_emptyBufferCount{0};
+  std::atomic<uint64_t> m_xrunCount{0};
+  std::atomic<int> m_processThreadId{0};
+};
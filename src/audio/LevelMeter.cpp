@@ -0,0 +1,177 @@
+#include "LevelMeter.h"
+
+#include "SampleKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kBallisticsSeconds = 0.3;
+constexpr int kBinsPerSecond = 10;
+constexpr double kPi = 3.14159265358979323846;
+
+float loudnessFromMeanSquare(double meanSquare) {
+  if (meanSquare <= 0.0) {
+    return AudioLevels::kSilenceLufs;
+  }
+  return std::max(AudioLevels::kSilenceLufs, static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare)));
+}
+} // namespace
+
+LevelMeter::LevelMeter() : m_kernels(&sampleKernels()) { reset(); }
+
+void LevelMeter::reset() {
+  m_sampleRate = 0;
+  std::fill(&m_filterState[0][0], &m_filterState[0][0] + 8, 0.0);
+  std::fill(&m_bins[0][0], &m_bins[0][0] + 2 * kLoudnessBins, 0.0);
+  for (int channel = 0; channel < 2; ++channel) {
+    m_peak[channel] = 0.0f;
+    m_meanSquare[channel] = 0.0;
+    m_binEnergy[channel] = 0.0;
+  }
+  m_binFrames = 0;
+  m_binIndex = 0;
+  m_filledBins = 0;
+  m_lastSignalNs = 0;
+  publish(0);
+}
+
+void LevelMeter::process(const float *stereo, int frames, int sampleRate) {
+  if (stereo == nullptr || frames <= 0 || sampleRate <= 0) {
+    return;
+  }
+  if (sampleRate != m_sampleRate) {
+    configure(sampleRate);
+  }
+
+  float peaks[2];
+  float sumSquares[2];
+  m_kernels->stereoLevels(stereo, frames, peaks, sumSquares);
+  const double decay = std::exp(-static_cast<double>(frames) / (sampleRate * kBallisticsSeconds));
+  for (int channel = 0; channel < 2; ++channel) {
+    m_peak[channel] = std::max(peaks[channel], static_cast<float>(m_peak[channel] * decay));
+    const double meanSquare = static_cast<double>(sumSquares[channel]) / frames;
+    m_meanSquare[channel] = meanSquare + decay * (m_meanSquare[channel] - meanSquare);
+  }
+
+  weighAndBin(stereo, frames);
+  const int64_t nowNs = monotonicTimeNs();
+  if (std::max(peaks[0], peaks[1]) >= m_silenceFloor.load(std::memory_order_relaxed)) {
+    m_lastSignalNs = nowNs;
+  }
+  publish(nowNs);
+}
+
+void LevelMeter::setSilenceFloor(float amplitude) {
+  m_silenceFloor.store(std::max(0.0f, amplitude), std::memory_order_relaxed);
+}
+
+AudioLevels LevelMeter::snapshot() const {
+  AudioLevels levels;
+  for (;;) {
+    const uint32_t before = m_sequence.load(std::memory_order_acquire);
+    if ((before & 1U) != 0U) {
+      continue;
+    }
+    for (int channel = 0; channel < 2; ++channel) {
+      levels.peak[channel] = m_publishedPeak[channel].load(std::memory_order_relaxed);
+      levels.rms[channel] = m_publishedRms[channel].load(std::memory_order_relaxed);
+      levels.shortTermLufs[channel] = m_publishedLufs[channel].load(std::memory_order_relaxed);
+    }
+    levels.updatedNs = m_publishedNs.load(std::memory_order_relaxed);
+    levels.lastSignalNs = m_publishedSignalNs.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_sequence.load(std::memory_order_relaxed) == before) {
+      return levels;
+    }
+  }
+}
+
+// K-weighting pre-filter and RLB high-pass from ITU-R BS.1770, designed for
+// the actual rate rather than using the published 48 kHz coefficients.
+void LevelMeter::configure(int sampleRate) {
+  m_sampleRate = sampleRate;
+
+  double k = std::tan(kPi * 1681.974450955533 / sampleRate);
+  const double q = 0.7071752369554196;
+  const double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+  const double vb = std::pow(vh, 0.4996667741545416);
+  double a0 = 1.0 + k / q + k * k;
+  m_shelf.b0 = (vh + vb * k / q + k * k) / a0;
+  m_shelf.b1 = 2.0 * (k * k - vh) / a0;
+  m_shelf.b2 = (vh - vb * k / q + k * k) / a0;
+  m_shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+  m_shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+  k = std::tan(kPi * 38.13547087602444 / sampleRate);
+  const double highPassQ = 0.5003270373238773;
+  a0 = 1.0 + k / highPassQ + k * k;
+  m_highPass.b0 = 1.0;
+  m_highPass.b1 = -2.0;
+  m_highPass.b2 = 1.0;
+  m_highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+  m_highPass.a2 = (1.0 - k / highPassQ + k * k) / a0;
+
+  std::fill(&m_filterState[0][0], &m_filterState[0][0] + 8, 0.0);
+  std::fill(&m_bins[0][0], &m_bins[0][0] + 2 * kLoudnessBins, 0.0);
+  m_binEnergy[0] = 0.0;
+  m_binEnergy[1] = 0.0;
+  m_binLength = std::max(1, sampleRate / kBinsPerSecond);
+  m_binFrames = 0;
+  m_binIndex = 0;
+  m_filledBins = 0;
+}
+
+// The filters are recursive, so this stays a scalar per-sample loop; both
+// channels run in the same pass.
+void LevelMeter::weighAndBin(const float *stereo, int frames) {
+  for (int i = 0; i < frames; ++i) {
+    for (int channel = 0; channel < 2; ++channel) {
+      double *state = m_filterState[channel];
+      const double x = stereo[2 * i + channel];
+      const double shelved = m_shelf.b0 * x + state[0];
+      state[0] = m_shelf.b1 * x - m_shelf.a1 * shelved + state[1];
+      state[1] = m_shelf.b2 * x - m_shelf.a2 * shelved;
+      const double weighted = m_highPass.b0 * shelved + state[2];
+      state[2] = m_highPass.b1 * shelved - m_highPass.a1 * weighted + state[3];
+      state[3] = m_highPass.b2 * shelved - m_highPass.a2 * weighted;
+      m_binEnergy[channel] += weighted * weighted;
+    }
+
+    if (++m_binFrames == m_binLength) {
+      m_bins[m_binIndex][0] = m_binEnergy[0];
+      m_bins[m_binIndex][1] = m_binEnergy[1];
+      m_binIndex = (m_binIndex + 1) % kLoudnessBins;
+      m_filledBins = std::min(m_filledBins + 1, kLoudnessBins);
+      m_binEnergy[0] = 0.0;
+      m_binEnergy[1] = 0.0;
+      m_binFrames = 0;
+    }
+  }
+}
+
+void LevelMeter::publish(int64_t updatedNs) {
+  float loudness[2] = {AudioLevels::kSilenceLufs, AudioLevels::kSilenceLufs};
+  if (m_filledBins > 0) {
+    for (int channel = 0; channel < 2; ++channel) {
+      double energy = 0.0;
+      for (int bin = 0; bin < m_filledBins; ++bin) {
+        energy += m_bins[bin][channel];
+      }
+      loudness[channel] = loudnessFromMeanSquare(energy / (static_cast<double>(m_filledBins) * m_binLength));
+    }
+  }
+
+  const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+  m_sequence.store(sequence + 1U, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (int channel = 0; channel < 2; ++channel) {
+    m_publishedPeak[channel].store(m_peak[channel], std::memory_order_relaxed);
+    m_publishedRms[channel].store(static_cast<float>(std::sqrt(std::max(0.0, m_meanSquare[channel]))),
+                                  std::memory_order_relaxed);
+    m_publishedLufs[channel].store(loudness[channel], std::memory_order_relaxed);
+  }
+  m_publishedNs.store(updatedNs, std::memory_order_relaxed);
+  m_publishedSignalNs.store(m_lastSignalNs, std::memory_order_relaxed);
+  m_sequence.store(sequence + 2U, std::memory_order_release);
+}
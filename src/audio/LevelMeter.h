@@ -0,0 +1,65 @@
+#pragma once
+
+#include "AudioSource.h"
+
+#include <atomic>
+#include <cstdint>
+
+struct SampleKernels;
+
+// Meters interleaved stereo on the producer thread. process() neither locks
+// nor allocates, so it can run in a realtime callback; the result is
+// published as a seqlock snapshot that snapshot() reads from any thread.
+// Peak and RMS fall back with a ~300 ms time constant; loudness sums
+// K-weighted energy in 100 ms bins over the last 3 s.
+class LevelMeter {
+public:
+  LevelMeter();
+
+  // Only while no producer is running.
+  void reset();
+  void process(const float *stereo, int frames, int sampleRate);
+  AudioLevels snapshot() const;
+  // Safe while processing; takes effect from the next block.
+  void setSilenceFloor(float amplitude);
+
+private:
+  static constexpr int kLoudnessBins = 30;
+
+  struct Biquad {
+    double b0 = 1.0;
+    double b1 = 0.0;
+    double b2 = 0.0;
+    double a1 = 0.0;
+    double a2 = 0.0;
+  };
+
+  void configure(int sampleRate);
+  void weighAndBin(const float *stereo, int frames);
+  void publish(int64_t updatedNs);
+
+  const SampleKernels *m_kernels = nullptr;
+  int m_sampleRate = 0;
+  Biquad m_shelf;
+  Biquad m_highPass;
+  // Per channel: shelf z1, z2, then high-pass z1, z2 (transposed direct form II).
+  double m_filterState[2][4] = {};
+
+  float m_peak[2] = {};
+  double m_meanSquare[2] = {};
+  double m_bins[kLoudnessBins][2] = {};
+  double m_binEnergy[2] = {};
+  int m_binFrames = 0;
+  int m_binLength = 4800;
+  int m_binIndex = 0;
+  int m_filledBins = 0;
+  int64_t m_lastSignalNs = 0;
+  std::atomic<float> m_silenceFloor{0.001f};
+
+  std::atomic<uint32_t> m_sequence{0};
+  std::atomic<float> m_publishedPeak[2];
+  std::atomic<float> m_publishedRms[2];
+  std::atomic<float> m_publishedLufs[2];
+  std::atomic<int64_t> m_publishedNs{0};
+  std::atomic<int64_t> m_publishedSignalNs{0};
+};
@@ -0,0 +1,350 @@
+#include "LocalPcmAudioSource.h"
+
+#include "LocalPcmProtocol.h"
+#include "SampleKernels.h"
+#include "ThreadPlacement.h"
+
+#include <QDir>
+#include <QMetaObject>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr int kRingCapacityFrames = 65536;
+constexpr int kReadChunkFrames = 1024;
+constexpr int kMaxLocalChannels = 64;
+constexpr int kPollTimeoutMs = 100;
+constexpr auto kIdleSleep = std::chrono::microseconds(500);
+
+const QString kFifoPrefix = QStringLiteral("fifo:");
+const QString kSharedMemoryPrefix = QStringLiteral("shm:");
+
+bool validFormat(uint32_t sampleRate, uint32_t channels) {
+  return sampleRate >= 1000 && sampleRate <= 768000 && channels >= 1 && channels <= kMaxLocalChannels;
+}
+} // namespace
+
+LocalPcmAudioSource::LocalPcmAudioSource(QObject *parent) : BufferedAudioSource(kRingCapacityFrames, parent) {
+  m_readScratch.assign(static_cast<size_t>(kReadChunkFrames) * kMaxLocalChannels, 0.0f);
+  m_stereoScratch.assign(static_cast<size_t>(kReadChunkFrames) * 2U, 0.0f);
+}
+
+LocalPcmAudioSource::~LocalPcmAudioSource() { stop(); }
+
+bool LocalPcmAudioSource::start() {
+  if (m_running) {
+    return true;
+  }
+
+  QString deviceId = selectedDeviceId();
+  if (deviceId.isEmpty()) {
+    deviceId = defaultDeviceId();
+    setSelectedDeviceId(deviceId);
+  }
+  const bool isFifo = deviceId.startsWith(kFifoPrefix);
+  const bool isSharedMemory = deviceId.startsWith(kSharedMemoryPrefix);
+  if (!isFifo && !isSharedMemory) {
+    Q_EMIT errorMessage(QStringLiteral("Local PCM input needs a fifo:<path> or shm:<path> device, got \"%1\".")
+                            .arg(deviceId));
+    return false;
+  }
+
+  const QByteArray path = deviceId.mid(isFifo ? kFifoPrefix.size() : kSharedMemoryPrefix.size()).toLocal8Bit();
+  m_running = true;
+  startDraining();
+  setFillGaps(true);
+  m_readerThread = isFifo ? std::thread(&LocalPcmAudioSource::runFifoReader, this, path)
+                          : std::thread(&LocalPcmAudioSource::runSharedMemoryReader, this, path);
+  Q_EMIT statusMessage(QStringLiteral("Audio backend: local PCM (%1).").arg(deviceId));
+  return true;
+}
+
+void LocalPcmAudioSource::stop() {
+  m_running = false;
+  if (m_readerThread.joinable()) {
+    m_readerThread.join();
+  }
+  stopDraining();
+}
+
+bool LocalPcmAudioSource::isRunning() const { return m_running.load(); }
+
+QString LocalPcmAudioSource::backendName() const { return QStringLiteral("Local PCM"); }
+
+QVector<AudioDeviceInfo> LocalPcmAudioSource::availableDevices() const {
+  QVector<AudioDeviceInfo> devices;
+  const auto addDevice = [&devices](const QString &id) {
+    for (const AudioDeviceInfo &device : devices) {
+      if (device.id == id) {
+        return;
+      }
+    }
+    AudioDeviceInfo device;
+    device.id = id;
+    device.name = id;
+    device.description = id.startsWith(kFifoPrefix) ? QStringLiteral("Named pipe PCM input")
+                                                    : QStringLiteral("Shared-memory PCM ring");
+    devices.push_back(device);
+  };
+
+  const QString deviceId = selectedDeviceId();
+  if (!deviceId.isEmpty()) {
+    addDevice(deviceId);
+  }
+  addDevice(defaultDeviceId());
+  addDevice(kSharedMemoryPrefix + QStringLiteral("/dev/shm/qt6mplayer"));
+  return devices;
+}
+
+QString LocalPcmAudioSource::defaultDeviceId() const {
+  return kFifoPrefix + QDir::tempPath() + QStringLiteral("/qt6mplayer.pcm");
+}
+
+QString LocalPcmAudioSource::selectedDeviceId() const {
+  std::lock_guard<std::mutex> lock(m_deviceMutex);
+  return m_deviceId;
+}
+
+void LocalPcmAudioSource::setSelectedDeviceId(const QString &deviceId) {
+  const QString trimmed = deviceId.trimmed();
+  // Live-device ids from settings do not name a local endpoint; keep ours.
+  if (!trimmed.startsWith(kFifoPrefix) && !trimmed.startsWith(kSharedMemoryPrefix)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_deviceMutex);
+  m_deviceId = trimmed;
+}
+
+void LocalPcmAudioSource::runFifoReader(const QByteArray &path) {
+  const ThreadPlacementScope placement(ThreadRole::Capture, "local-pcm");
+  struct stat info = {};
+  if (::stat(path.constData(), &info) != 0) {
+    if (::mkfifo(path.constData(), 0600) != 0) {
+      postError(QStringLiteral("Could not create FIFO %1: %2")
+                    .arg(QString::fromLocal8Bit(path), QString::fromLocal8Bit(std::strerror(errno))));
+      m_running = false;
+      return;
+    }
+  } else if (!S_ISFIFO(info.st_mode)) {
+    postError(QStringLiteral("%1 is not a FIFO.").arg(QString::fromLocal8Bit(path)));
+    m_running = false;
+    return;
+  }
+
+  while (m_running) {
+    const int fd = ::open(path.constData(), O_RDONLY | O_NONBLOCK);
+    if (fd < 0) {
+      postError(QStringLiteral("Could not open FIFO %1: %2")
+                    .arg(QString::fromLocal8Bit(path), QString::fromLocal8Bit(std::strerror(errno))));
+      m_running = false;
+      return;
+    }
+
+    LocalPcmStreamHeader header = {};
+    size_t headerBytes = 0;
+    size_t pendingBytes = 0;
+    int channels = 0;
+    bool writerSeen = false;
+
+    while (m_running) {
+      pollfd descriptor = {fd, POLLIN, 0};
+      const int ready = ::poll(&descriptor, 1, kPollTimeoutMs);
+      if (ready < 0 && errno != EINTR) {
+        break;
+      }
+      if (ready <= 0) {
+        continue;
+      }
+
+      if (channels == 0) {
+        const ssize_t count =
+            ::read(fd, reinterpret_cast<char *>(&header) + headerBytes, sizeof(header) - headerBytes);
+        if (count == 0 && (descriptor.revents & POLLHUP) != 0) {
+          // No writer yet (or it left before sending a header): wait for one.
+          if (writerSeen) {
+            break;
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(kPollTimeoutMs));
+          continue;
+        }
+        if (count <= 0) {
+          continue;
+        }
+        writerSeen = true;
+        headerBytes += static_cast<size_t>(count);
+        if (headerBytes < sizeof(header)) {
+          continue;
+        }
+        if (std::memcmp(header.magic, kLocalPcmStreamMagic, sizeof(header.magic)) != 0 ||
+            header.version != kLocalPcmVersion || !validFormat(header.sampleRate, header.channels)) {
+          postError(QStringLiteral("FIFO writer sent an invalid local PCM header; waiting for a new writer."));
+          break;
+        }
+        channels = static_cast<int>(header.channels);
+        m_sampleRate.store(static_cast<int>(header.sampleRate));
+        setFillGaps(false);
+        postStatus(QStringLiteral("Local PCM writer connected (%1 Hz, %2 channels).")
+                       .arg(header.sampleRate)
+                       .arg(header.channels));
+        continue;
+      }
+
+      if (!waitForRingSpace(kReadChunkFrames)) {
+        break;
+      }
+
+      const size_t frameBytes = static_cast<size_t>(channels) * sizeof(float);
+      auto *buffer = reinterpret_cast<char *>(m_readScratch.data());
+      const ssize_t count =
+          ::read(fd, buffer + pendingBytes, static_cast<size_t>(kReadChunkFrames) * frameBytes - pendingBytes);
+      if (count == 0) {
+        break;
+      }
+      if (count < 0) {
+        if (errno == EAGAIN || errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+
+      const size_t totalBytes = pendingBytes + static_cast<size_t>(count);
+      const int frames = static_cast<int>(totalBytes / frameBytes);
+      pushFrames(m_readScratch.data(), frames, channels);
+      pendingBytes = totalBytes - static_cast<size_t>(frames) * frameBytes;
+      if (pendingBytes > 0) {
+        std::memmove(buffer, buffer + static_cast<size_t>(frames) * frameBytes, pendingBytes);
+      }
+    }
+
+    ::close(fd);
+    if (channels > 0 && m_running) {
+      setFillGaps(true);
+      postStatus(QStringLiteral("Local PCM writer disconnected; waiting for a new one."));
+    }
+  }
+}
+
+void LocalPcmAudioSource::runSharedMemoryReader(const QByteArray &path) {
+  const ThreadPlacementScope placement(ThreadRole::Capture, "local-pcm");
+  const int fd = ::open(path.constData(), O_RDWR);
+  if (fd < 0) {
+    postError(QStringLiteral("Could not open shared PCM ring %1: %2")
+                  .arg(QString::fromLocal8Bit(path), QString::fromLocal8Bit(std::strerror(errno))));
+    m_running = false;
+    return;
+  }
+
+  struct stat info = {};
+  if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < kLocalPcmSharedDataOffset) {
+    postError(QStringLiteral("Shared PCM ring %1 is too small.").arg(QString::fromLocal8Bit(path)));
+    ::close(fd);
+    m_running = false;
+    return;
+  }
+
+  const auto mappedSize = static_cast<size_t>(info.st_size);
+  void *mapping = ::mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    postError(QStringLiteral("Could not map shared PCM ring %1: %2")
+                  .arg(QString::fromLocal8Bit(path), QString::fromLocal8Bit(std::strerror(errno))));
+    m_running = false;
+    return;
+  }
+
+  auto *header = static_cast<LocalPcmSharedHeader *>(mapping);
+  const uint64_t capacity = header->capacityFrames;
+  const uint64_t channels = header->channels;
+  const bool layoutValid = std::memcmp(header->magic, kLocalPcmSharedMagic, sizeof(header->magic)) == 0 &&
+                           header->version == kLocalPcmVersion && validFormat(header->sampleRate, header->channels) &&
+                           capacity > 0 &&
+                           kLocalPcmSharedDataOffset + capacity * channels * sizeof(float) <= mappedSize;
+  if (!layoutValid) {
+    postError(QStringLiteral("%1 does not hold a valid shared PCM ring.").arg(QString::fromLocal8Bit(path)));
+    ::munmap(mapping, mappedSize);
+    m_running = false;
+    return;
+  }
+
+  const auto *samples = reinterpret_cast<const float *>(static_cast<const char *>(mapping) + kLocalPcmSharedDataOffset);
+  m_sampleRate.store(static_cast<int>(header->sampleRate));
+  setFillGaps(false);
+  postStatus(QStringLiteral("Local PCM shared ring attached (%1 Hz, %2 channels, %3 frames).")
+                 .arg(header->sampleRate)
+                 .arg(header->channels)
+                 .arg(capacity));
+
+  // Start at the writer's current position rather than replaying stale data.
+  uint64_t readFrames = header->writeFrames.load(std::memory_order_acquire);
+  header->readFrames.store(readFrames, std::memory_order_release);
+
+  while (m_running) {
+    const uint64_t writeFrames = header->writeFrames.load(std::memory_order_acquire);
+    if (writeFrames - readFrames > capacity) {
+      readFrames = writeFrames - capacity;
+    }
+    if (writeFrames == readFrames) {
+      std::this_thread::sleep_for(kIdleSleep);
+      continue;
+    }
+    if (!waitForRingSpace(kReadChunkFrames)) {
+      break;
+    }
+
+    const int frames = static_cast<int>(std::min<uint64_t>(writeFrames - readFrames, kReadChunkFrames));
+    const uint64_t start = readFrames % capacity;
+    const auto firstPart = static_cast<int>(std::min<uint64_t>(static_cast<uint64_t>(frames), capacity - start));
+    std::memcpy(m_readScratch.data(), samples + start * channels, static_cast<size_t>(firstPart) * channels * sizeof(float));
+    if (firstPart < frames) {
+      std::memcpy(m_readScratch.data() + static_cast<size_t>(firstPart) * channels,
+                  samples,
+                  static_cast<size_t>(frames - firstPart) * channels * sizeof(float));
+    }
+    pushFrames(m_readScratch.data(), frames, static_cast<int>(channels));
+    readFrames += static_cast<uint64_t>(frames);
+    header->readFrames.store(readFrames, std::memory_order_release);
+  }
+
+  ::munmap(mapping, mappedSize);
+}
+
+bool LocalPcmAudioSource::waitForRingSpace(int frames) {
+  while (m_running) {
+    if (m_ring.capacityFrames() - m_ring.availableFrames() >= frames) {
+      return true;
+    }
+    std::this_thread::sleep_for(kIdleSleep);
+  }
+  return false;
+}
+
+void LocalPcmAudioSource::pushFrames(const float *interleaved, int frames, int channels) {
+  if (frames <= 0) {
+    return;
+  }
+  const float *stereo = interleaved;
+  if (channels != 2) {
+    sampleKernels().interleavedToStereo(interleaved, m_stereoScratch.data(), frames, channels);
+    stereo = m_stereoScratch.data();
+  }
+  m_ring.write(stereo, frames);
+  meterCaptured(stereo, frames);
+  m_ring.markTimestamp(monotonicTimeNs());
+}
+
+void LocalPcmAudioSource::postStatus(const QString &message) {
+  QMetaObject::invokeMethod(this, [this, message]() { Q_EMIT statusMessage(message); }, Qt::QueuedConnection);
+}
+
+void LocalPcmAudioSource::postError(const QString &message) {
+  QMetaObject::invokeMethod(this, [this, message]() { Q_EMIT errorMessage(message); }, Qt::QueuedConnection);
+}
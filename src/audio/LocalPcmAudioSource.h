@@ -0,0 +1,48 @@
+#pragma once
+
+#include "BufferedAudioSource.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct LocalPcmSharedHeader;
+
+// Reads interleaved float PCM written by another local process, either
+// through a named pipe ("fifo:<path>") or a shared-memory ring
+// ("shm:<path>"). See LocalPcmProtocol.h for both layouts. A reader
+// thread copies into the capture ring only while it has room, so a writer
+// running faster than realtime is throttled rather than dropped.
+class LocalPcmAudioSource : public BufferedAudioSource {
+  Q_OBJECT
+
+public:
+  explicit LocalPcmAudioSource(QObject *parent = nullptr);
+  ~LocalPcmAudioSource() override;
+
+  bool start() override;
+  void stop() override;
+  bool isRunning() const override;
+  QString backendName() const override;
+  QVector<AudioDeviceInfo> availableDevices() const override;
+  QString selectedDeviceId() const override;
+  void setSelectedDeviceId(const QString &deviceId) override;
+  // A named pipe in the temporary directory, used until another is selected.
+  QString defaultDeviceId() const override;
+
+private:
+  void runFifoReader(const QByteArray &path);
+  void runSharedMemoryReader(const QByteArray &path);
+  bool waitForRingSpace(int frames);
+  void pushFrames(const float *interleaved, int frames, int channels);
+  void postStatus(const QString &message);
+  void postError(const QString &message);
+
+  std::atomic<bool> m_running{false};
+  std::thread m_readerThread;
+  mutable std::mutex m_deviceMutex;
+  QString m_deviceId;
+  std::vector<float> m_readScratch;
+  std::vector<float> m_stereoScratch;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Wire formats for LocalPcmAudioSource. Both carry native-endian float32
+// interleaved frames from a process on the same machine.
+//
+// FIFO: the writer sends one LocalPcmStreamHeader, then frames until it
+// closes the pipe. A new writer starts again with a header.
+//
+// Shared memory: a file (memfd via /proc/<pid>/fd/<n>, or /dev/shm) laid
+// out as LocalPcmSharedHeader followed, at kLocalPcmSharedDataOffset, by a
+// ring of capacityFrames frames. The writer advances writeFrames after
+// filling frames; the reader publishes readFrames so a writer running
+// faster than realtime can wait for space instead of overwriting.
+
+inline constexpr char kLocalPcmStreamMagic[4] = {'Q', 'P', 'C', 'M'};
+inline constexpr char kLocalPcmSharedMagic[4] = {'Q', 'P', 'S', 'H'};
+inline constexpr uint32_t kLocalPcmVersion = 1;
+inline constexpr uint64_t kLocalPcmSharedDataOffset = 256;
+
+struct LocalPcmStreamHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t sampleRate;
+  uint32_t channels;
+};
+
+struct LocalPcmSharedHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t sampleRate;
+  uint32_t channels;
+  uint32_t capacityFrames;
+  uint32_t reserved;
+  alignas(64) std::atomic<uint64_t> writeFrames;
+  alignas(64) std::atomic<uint64_t> readFrames;
+};
+
+static_assert(sizeof(LocalPcmStreamHeader) == 16, "LocalPcmStreamHeader layout is part of the protocol");
+static_assert(sizeof(LocalPcmSharedHeader) <= kLocalPcmSharedDataOffset, "shared header overlaps sample data");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared counters must be lock-free");
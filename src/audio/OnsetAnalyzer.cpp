@@ -0,0 +1,129 @@
+#include "OnsetAnalyzer.h"
+
+#include "OnsetDetector.h"
+#include "SampleKernels.h"
+#include "ThreadPlacement.h"
+
+#include <QMetaObject>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+constexpr int kQueueCapacityFrames = 32768;
+constexpr int kIdleSleepMs = 5;
+} // namespace
+
+OnsetAnalyzer::OnsetAnalyzer(QObject *parent) : QObject(parent), m_queue(kQueueCapacityFrames, 2) {}
+
+OnsetAnalyzer::~OnsetAnalyzer() { stop(); }
+
+void OnsetAnalyzer::start() {
+  if (m_running) {
+    return;
+  }
+  m_queue.reset();
+  {
+    const std::lock_guard<std::mutex> lock(m_resultsMutex);
+    m_tempo = TempoEstimate();
+    m_features = AudioFeatures();
+  }
+  m_running = true;
+  m_thread = std::thread(&OnsetAnalyzer::run, this);
+}
+
+void OnsetAnalyzer::stop() {
+  m_running = false;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+bool OnsetAnalyzer::isRunning() const { return m_running.load(); }
+
+void OnsetAnalyzer::setGate(float amplitude) { m_gate.store(amplitude, std::memory_order_relaxed); }
+
+TempoEstimate OnsetAnalyzer::tempo() const {
+  const std::lock_guard<std::mutex> lock(m_resultsMutex);
+  return m_tempo;
+}
+
+AudioFeatures OnsetAnalyzer::features() const {
+  const std::lock_guard<std::mutex> lock(m_resultsMutex);
+  return m_features;
+}
+
+void OnsetAnalyzer::submitAudioFrame(const QVector<float> &stereoFrame, const PcmBlockInfo &info) {
+  if (!m_running || info.sampleRate <= 0 || stereoFrame.size() < 2) {
+    return;
+  }
+  m_sampleRate.store(info.sampleRate, std::memory_order_relaxed);
+  m_queue.write(stereoFrame.constData(), static_cast<int>(stereoFrame.size() / 2));
+  m_queue.markTimestamp(info.captureTimeNs);
+}
+
+void OnsetAnalyzer::run() {
+  const ThreadPlacementScope placement(ThreadRole::Worker, "onset-analysis");
+  const SampleKernels &kernels = sampleKernels();
+  OnsetDetector detector;
+  TempoTracker tracker;
+  AudioFeatureTracker featureTracker;
+  std::vector<float> stereo;
+  std::vector<float> mono;
+
+  while (m_running) {
+    const int sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+    if (sampleRate <= 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kIdleSleepMs));
+      continue;
+    }
+    if (sampleRate != detector.sampleRate()) {
+      detector.configure(sampleRate);
+      tracker.configure(static_cast<int64_t>(detector.hopFrames()) * 1000000000LL / sampleRate);
+      featureTracker.configure(static_cast<double>(detector.hopFrames()) / sampleRate);
+    }
+    const int hopFrames = detector.hopFrames();
+    if (m_queue.availableFrames() < hopFrames) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kIdleSleepMs));
+      continue;
+    }
+
+    stereo.resize(static_cast<size_t>(hopFrames) * 2U);
+    mono.resize(static_cast<size_t>(hopFrames));
+    m_queue.read(stereo.data(), hopFrames);
+    kernels.interleavedToMono(stereo.data(), mono.data(), hopFrames, 2);
+    detector.setGate(m_gate.load(std::memory_order_relaxed));
+    float strength = 0.0f;
+    const bool onset = detector.process(mono.data(), &strength);
+
+    // Capture time of the first frame of the hop just read.
+    const int64_t hopPosition = static_cast<int64_t>(m_queue.readPosition()) - hopFrames;
+    int64_t hopTimeNs = monotonicTimeNs() - static_cast<int64_t>(hopFrames) * 1000000000LL / sampleRate;
+    uint64_t anchorPosition = 0;
+    int64_t anchorTimestampNs = 0;
+    if (m_queue.timestampAnchor(&anchorPosition, &anchorTimestampNs)) {
+      const int64_t framesAfterHop = static_cast<int64_t>(anchorPosition) - 1 - hopPosition;
+      hopTimeNs = anchorTimestampNs - framesAfterHop * 1000000000LL / sampleRate;
+    }
+    const bool tempoUpdated = tracker.push(detector.novelty(), detector.lowNovelty(), hopTimeNs);
+    if (tempoUpdated) {
+      featureTracker.setTempo(tracker.estimate());
+    }
+    featureTracker.push(detector.rms(), detector.centroidHz(), onset);
+    {
+      const std::lock_guard<std::mutex> lock(m_resultsMutex);
+      if (tempoUpdated) {
+        m_tempo = tracker.estimate();
+      }
+      m_features = featureTracker.features();
+    }
+    if (!onset) {
+      continue;
+    }
+
+    // The onset is in the newest hop of the previous window.
+    const qint64 captureTimeNs = hopTimeNs - static_cast<int64_t>(hopFrames) * 1000000000LL / sampleRate;
+    QMetaObject::invokeMethod(
+        this, [this, captureTimeNs, strength]() { Q_EMIT onsetDetected(captureTimeNs, strength); }, Qt::QueuedConnection);
+  }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "AudioFeatureTracker.h"
+#include "PcmBlockInfo.h"
+#include "PcmRingBuffer.h"
+#include "TempoTracker.h"
+
+#include <QObject>
+#include <QVector>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// Runs OnsetDetector, TempoTracker and AudioFeatureTracker on a worker
+// thread. submitAudioFrame() only copies the block into a queue, so the
+// thread that receives capture blocks does no analysis; onsets come back as
+// queued signals dated on the capture clock, tempo and features as polled
+// snapshots.
+class OnsetAnalyzer : public QObject {
+  Q_OBJECT
+
+public:
+  explicit OnsetAnalyzer(QObject *parent = nullptr);
+  ~OnsetAnalyzer() override;
+
+  void start();
+  void stop();
+  bool isRunning() const;
+  // Linear RMS below which the input counts as silence and yields no onsets.
+  void setGate(float amplitude);
+  TempoEstimate tempo() const;
+  AudioFeatures features() const;
+
+public Q_SLOTS:
+  void submitAudioFrame(const QVector<float> &stereoFrame, const PcmBlockInfo &info);
+
+Q_SIGNALS:
+  void onsetDetected(qint64 captureTimeNs, float strength);
+
+private:
+  void run();
+
+  PcmRingBuffer m_queue;
+  std::atomic<bool> m_running{false};
+  std::atomic<int> m_sampleRate{0};
+  std::atomic<float> m_gate{0.0f};
+  mutable std::mutex m_resultsMutex;
+  TempoEstimate m_tempo;
+  AudioFeatures m_features;
+  std::thread m_thread;
+};
@@ -0,0 +1,171 @@
+#include "OnsetDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kLowBands = 2;
+constexpr float kBandEdgesHz[OnsetDetector::kBands + 1] = {30.0f, 150.0f, 400.0f, 1000.0f, 3000.0f, 8000.0f, 16000.0f};
+// log(1 + kCompression * magnitude), magnitude 1 for a full-scale sine.
+constexpr float kCompression = 1000.0f;
+constexpr double kBandScaleSeconds = 4.0;
+constexpr float kMinBandScale = 0.3f;
+constexpr int kMedianHops = 15;
+constexpr float kThresholdOffset = 0.08f;
+constexpr float kThresholdScale = 1.5f;
+constexpr double kMinOnsetSeconds = 0.06;
+} // namespace
+
+OnsetDetector::OnsetDetector() : m_history(kMedianHops, 0.0f) { configure(48000); }
+
+void OnsetDetector::configure(int sampleRate) {
+  m_sampleRate = sampleRate > 0 ? sampleRate : 48000;
+  // About 21 ms windows every 10 ms whatever the rate.
+  const int fftSize = m_sampleRate > 64000 ? 2048 : 1024;
+  m_hopFrames = fftSize / 2;
+  m_fft = RealFft(fftSize);
+  const double hopSeconds = static_cast<double>(m_hopFrames) / m_sampleRate;
+  m_bandScaleDecay = static_cast<float>(std::exp(-hopSeconds / kBandScaleSeconds));
+  m_minOnsetHops = std::max(1, static_cast<int>(std::ceil(kMinOnsetSeconds / hopSeconds)));
+
+  // Hann window, scaled so a full-scale sine peaks at magnitude 1.
+  m_window.resize(fftSize);
+  double windowSum = 0.0;
+  for (int i = 0; i < fftSize; ++i) {
+    m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / fftSize));
+    windowSum += m_window[i];
+  }
+  for (float &value : m_window) {
+    value = static_cast<float>(value * 2.0 / windowSum);
+  }
+
+  const int bins = m_fft.bins();
+  for (int band = 0; band <= kBands; ++band) {
+    const int bin = static_cast<int>(std::lround(kBandEdgesHz[band] * fftSize / m_sampleRate));
+    m_bandStart[band] = std::clamp(bin, band > 0 ? m_bandStart[band - 1] : 1, bins);
+  }
+
+  m_frame.assign(fftSize, 0.0f);
+  m_windowed.assign(fftSize, 0.0f);
+  m_re.assign(bins, 0.0f);
+  m_im.assign(bins, 0.0f);
+  reset();
+}
+
+void OnsetDetector::reset() {
+  std::fill(m_frame.begin(), m_frame.end(), 0.0f);
+  m_previous.assign(m_fft.bins(), 0.0f);
+  std::fill(std::begin(m_bandScale), std::end(m_bandScale), kMinBandScale);
+  std::fill(m_history.begin(), m_history.end(), 0.0f);
+  m_historyIndex = 0;
+  std::fill(std::begin(m_novelty), std::end(m_novelty), 0.0f);
+  m_lowNovelty = 0.0f;
+  m_rms = 0.0f;
+  m_centroidHz = 0.0f;
+  std::fill(std::begin(m_threshold), std::end(m_threshold), 0.0f);
+  m_hopsSinceOnset = 0;
+  m_filledHops = 0;
+}
+
+int OnsetDetector::sampleRate() const { return m_sampleRate; }
+
+int OnsetDetector::hopFrames() const { return m_hopFrames; }
+
+void OnsetDetector::setGate(float amplitude) { m_gate = std::max(0.0f, amplitude); }
+
+bool OnsetDetector::process(const float *mono, float *strength) {
+  const int fftSize = m_fft.size();
+  std::copy(m_frame.begin() + m_hopFrames, m_frame.end(), m_frame.begin());
+  std::copy(mono, mono + m_hopFrames, m_frame.end() - m_hopFrames);
+
+  double energy = 0.0;
+  for (int i = 0; i < m_hopFrames; ++i) {
+    energy += static_cast<double>(mono[i]) * mono[i];
+  }
+  m_rms = static_cast<float>(std::sqrt(energy / m_hopFrames));
+  const bool audible = m_rms >= m_gate;
+
+  for (int i = 0; i < fftSize; ++i) {
+    m_windowed[i] = m_frame[i] * m_window[i];
+  }
+  m_fft.forward(m_windowed.data(), m_re.data(), m_im.data());
+  float lowNovelty = 0.0f;
+  float centroidHz = 0.0f;
+  const float novelty = spectralNovelty(&lowNovelty, &centroidHz);
+  m_lowNovelty = audible ? lowNovelty : 0.0f;
+  m_centroidHz = audible ? centroidHz : 0.0f;
+
+  m_novelty[2] = m_novelty[1];
+  m_novelty[1] = m_novelty[0];
+  m_novelty[0] = audible ? novelty : 0.0f;
+  m_history[m_historyIndex] = m_novelty[0];
+  m_historyIndex = (m_historyIndex + 1) % kMedianHops;
+  m_threshold[1] = m_threshold[0];
+  m_threshold[0] = threshold();
+  ++m_hopsSinceOnset;
+
+  // The window needs a full frame of real input before its flux means anything.
+  const int warmupHops = fftSize / m_hopFrames + 2;
+  if (m_filledHops < warmupHops) {
+    ++m_filledHops;
+    return false;
+  }
+
+  const bool peak = m_novelty[1] > m_threshold[1] && m_novelty[1] >= m_novelty[2] && m_novelty[1] > m_novelty[0];
+  if (!peak || m_hopsSinceOnset <= m_minOnsetHops) {
+    return false;
+  }
+  m_hopsSinceOnset = 0;
+  if (strength != nullptr) {
+    *strength = m_novelty[1] - m_threshold[1];
+  }
+  return true;
+}
+
+float OnsetDetector::novelty() const { return m_novelty[0]; }
+
+float OnsetDetector::lowNovelty() const { return m_lowNovelty; }
+
+float OnsetDetector::rms() const { return m_rms; }
+
+float OnsetDetector::centroidHz() const { return m_centroidHz; }
+
+float OnsetDetector::spectralNovelty(float *lowNovelty, float *centroidHz) {
+  float novelty = 0.0f;
+  float weightedBins = 0.0f;
+  float totalMagnitude = 0.0f;
+  for (int band = 0; band < kBands; ++band) {
+    const int first = m_bandStart[band];
+    const int last = m_bandStart[band + 1];
+    if (last <= first) {
+      continue;
+    }
+    float flux = 0.0f;
+    for (int bin = first; bin < last; ++bin) {
+      const float linear = std::sqrt(m_re[bin] * m_re[bin] + m_im[bin] * m_im[bin]);
+      weightedBins += linear * static_cast<float>(bin);
+      totalMagnitude += linear;
+      const float magnitude = std::log1p(kCompression * linear);
+      flux += std::max(0.0f, magnitude - m_previous[bin]);
+      m_previous[bin] = magnitude;
+    }
+    flux /= static_cast<float>(last - first);
+    m_bandScale[band] = std::max({flux, m_bandScale[band] * m_bandScaleDecay, kMinBandScale});
+    novelty += flux / m_bandScale[band];
+    if (band + 1 == kLowBands) {
+      *lowNovelty = novelty / kLowBands;
+    }
+  }
+  *centroidHz = totalMagnitude > 0.0f
+                    ? weightedBins / totalMagnitude * static_cast<float>(m_sampleRate) / static_cast<float>(m_fft.size())
+                    : 0.0f;
+  return novelty / kBands;
+}
+
+float OnsetDetector::threshold() const {
+  float window[kMedianHops];
+  std::copy(m_history.begin(), m_history.end(), window);
+  std::nth_element(window, window + kMedianHops / 2, window + kMedianHops);
+  return kThresholdOffset + kThresholdScale * window[kMedianHops / 2];
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "RealFft.h"
+
+#include <vector>
+
+// Multi-band spectral flux onset detector for mono PCM fed one hop at a
+// time. Each hop takes the log-compressed magnitude spectrum of the last
+// window, sums the rise over the previous one per band and scales every
+// band by its own recent peak, so a hi-hat counts as much as a kick and a
+// sustained bass line adds nothing once it stops changing. Onsets are the
+// local maxima of that novelty curve above a running median threshold.
+// Not thread-safe: the analysis worker owns it.
+class OnsetDetector {
+public:
+  static constexpr int kBands = 6;
+
+  OnsetDetector();
+
+  void configure(int sampleRate);
+  void reset();
+  int sampleRate() const;
+  int hopFrames() const;
+  // Linear RMS below which hops are treated as silence.
+  void setGate(float amplitude);
+
+  // Analyses one hop of hopFrames() samples. True when the hop before it
+  // was an onset, with *strength how far it rose above the threshold.
+  bool process(const float *mono, float *strength);
+  // Novelty of the hop just processed, roughly 0..1, and the same over the
+  // two bands below 400 Hz only.
+  float novelty() const;
+  float lowNovelty() const;
+  // Input RMS of that hop, and the magnitude-weighted mean frequency of its
+  // window over 30 Hz..16 kHz; 0 when the hop was below the gate.
+  float rms() const;
+  float centroidHz() const;
+
+private:
+  float spectralNovelty(float *lowNovelty, float *centroidHz);
+  float threshold() const;
+
+  int m_sampleRate = 0;
+  int m_hopFrames = 512;
+  float m_gate = 0.0f;
+  float m_bandScaleDecay = 1.0f;
+  int m_minOnsetHops = 1;
+
+  RealFft m_fft;
+  std::vector<float> m_window;
+  std::vector<float> m_frame;
+  std::vector<float> m_windowed;
+  std::vector<float> m_re;
+  std::vector<float> m_im;
+  std::vector<float> m_previous;
+  int m_bandStart[kBands + 1] = {};
+  float m_bandScale[kBands] = {};
+
+  std::vector<float> m_history;
+  int m_historyIndex = 0;
+  float m_novelty[3] = {};
+  float m_lowNovelty = 0.0f;
+  float m_rms = 0.0f;
+  float m_centroidHz = 0.0f;
+  float m_threshold[2] = {};
+  int m_hopsSinceOnset = 0;
+  int m_filledHops = 0;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Where a block of PCM sits in time. captureTimeNs is on the monotonic
+// clock (the one PipeWire reports in pw_time.now) and refers to the last
+// frame of the block; samplePosition is the index of its first frame in
+// the source's running frame count.
+struct PcmBlockInfo {
+  int64_t captureTimeNs = 0;
+  uint64_t samplePosition = 0;
+  int sampleRate = 0;
+};
+
+inline int64_t monotonicTimeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
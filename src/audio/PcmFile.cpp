@@ -0,0 +1,249 @@
+#include "PcmFile.h"
+
+#include "SampleKernels.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+constexpr uint16_t kWaveFormatPcm = 1;
+constexpr uint16_t kWaveFormatIeeeFloat = 3;
+constexpr uint16_t kWaveFormatExtensible = 0xFFFE;
+
+void setError(QString *error, const QString &message) {
+  if (error != nullptr) {
+    *error = message;
+  }
+}
+
+uint16_t readU16(const char *bytes) { return qFromLittleEndian<uint16_t>(bytes); }
+
+uint32_t readU32(const char *bytes) { return qFromLittleEndian<uint32_t>(bytes); }
+
+void appendU16(QByteArray *out, uint16_t value) {
+  char bytes[2];
+  qToLittleEndian(value, bytes);
+  out->append(bytes, 2);
+}
+
+void appendU32(QByteArray *out, uint32_t value) {
+  char bytes[4];
+  qToLittleEndian(value, bytes);
+  out->append(bytes, 4);
+}
+
+bool decodeSamples(const char *bytes,
+                   qsizetype byteCount,
+                   uint16_t formatTag,
+                   int bitsPerSample,
+                   int blockAlign,
+                   int channels,
+                   QVector<float> *out,
+                   QString *error) {
+  const qsizetype frames = byteCount / blockAlign;
+  out->resize(frames * channels);
+  float *dst = out->data();
+  const int bytesPerSample = bitsPerSample / 8;
+  const SampleKernels &kernels = sampleKernels();
+
+  if (formatTag == kWaveFormatIeeeFloat && bitsPerSample == 32) {
+    for (qsizetype frame = 0; frame < frames; ++frame) {
+      std::memcpy(dst + frame * channels, bytes + frame * blockAlign, static_cast<size_t>(channels) * sizeof(float));
+    }
+    return true;
+  }
+
+  if (formatTag != kWaveFormatPcm) {
+    setError(error, QStringLiteral("Unsupported WAV sample format %1.").arg(formatTag));
+    return false;
+  }
+
+  if (bitsPerSample == 16 && blockAlign == channels * 2) {
+    QVector<int16_t> packed(frames * channels);
+    std::memcpy(packed.data(), bytes, static_cast<size_t>(packed.size()) * sizeof(int16_t));
+    for (int16_t &value : packed) {
+      value = qFromLittleEndian(value);
+    }
+    kernels.s16ToFloat(packed.constData(), dst, static_cast<int>(packed.size()));
+    return true;
+  }
+
+  if (bitsPerSample == 32 && blockAlign == channels * 4) {
+    QVector<int32_t> packed(frames * channels);
+    std::memcpy(packed.data(), bytes, static_cast<size_t>(packed.size()) * sizeof(int32_t));
+    for (int32_t &value : packed) {
+      value = qFromLittleEndian(value);
+    }
+    kernels.s32ToFloat(packed.constData(), dst, static_cast<int>(packed.size()));
+    return true;
+  }
+
+  if (bitsPerSample == 24 || bitsPerSample == 16 || bitsPerSample == 32) {
+    for (qsizetype frame = 0; frame < frames; ++frame) {
+      const char *src = bytes + frame * blockAlign;
+      for (int channel = 0; channel < channels; ++channel) {
+        const auto *sample = reinterpret_cast<const uint8_t *>(src + channel * bytesPerSample);
+        int32_t value = 0;
+        if (bytesPerSample == 2) {
+          value = static_cast<int32_t>(static_cast<uint32_t>(sample[0]) << 16 | static_cast<uint32_t>(sample[1]) << 24);
+        } else if (bytesPerSample == 3) {
+          value = static_cast<int32_t>(static_cast<uint32_t>(sample[0]) << 8 | static_cast<uint32_t>(sample[1]) << 16 |
+                                       static_cast<uint32_t>(sample[2]) << 24);
+        } else {
+          value = static_cast<int32_t>(readU32(reinterpret_cast<const char *>(sample)));
+        }
+        dst[frame * channels + channel] = static_cast<float>(value) * (1.0f / 2147483648.0f);
+      }
+    }
+    return true;
+  }
+
+  setError(error, QStringLiteral("Unsupported WAV bit depth %1.").arg(bitsPerSample));
+  return false;
+}
+} // namespace
+
+bool readWavFile(const QString &filePath, PcmFileData *data, QString *error) {
+  if (data == nullptr) {
+    return false;
+  }
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    setError(error, QStringLiteral("Could not open %1: %2").arg(filePath, file.errorString()));
+    return false;
+  }
+
+  const QByteArray bytes = file.readAll();
+  if (bytes.size() < 12 || std::memcmp(bytes.constData(), "RIFF", 4) != 0 ||
+      std::memcmp(bytes.constData() + 8, "WAVE", 4) != 0) {
+    setError(error, QStringLiteral("%1 is not a RIFF/WAVE file.").arg(filePath));
+    return false;
+  }
+
+  uint16_t formatTag = 0;
+  int channels = 0;
+  int sampleRate = 0;
+  int blockAlign = 0;
+  int bitsPerSample = 0;
+  const char *sampleBytes = nullptr;
+  qsizetype sampleByteCount = 0;
+
+  qsizetype offset = 12;
+  while (offset + 8 <= bytes.size()) {
+    const char *chunk = bytes.constData() + offset;
+    const qsizetype chunkSize = readU32(chunk + 4);
+    const qsizetype available = qMin(chunkSize, bytes.size() - offset - 8);
+    if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+      formatTag = readU16(chunk + 8);
+      channels = readU16(chunk + 10);
+      sampleRate = static_cast<int>(readU32(chunk + 12));
+      blockAlign = readU16(chunk + 20);
+      bitsPerSample = readU16(chunk + 22);
+      if (formatTag == kWaveFormatExtensible && available >= 40) {
+        formatTag = readU16(chunk + 32);
+      }
+    } else if (std::memcmp(chunk, "data", 4) == 0) {
+      sampleBytes = chunk + 8;
+      sampleByteCount = available;
+    }
+    offset += 8 + chunkSize + (chunkSize & 1);
+  }
+
+  if (channels <= 0 || sampleRate <= 0 || blockAlign <= 0 || bitsPerSample <= 0 ||
+      blockAlign < channels * (bitsPerSample / 8)) {
+    setError(error, QStringLiteral("%1 has a missing or invalid fmt chunk.").arg(filePath));
+    return false;
+  }
+  if (sampleBytes == nullptr) {
+    setError(error, QStringLiteral("%1 has no data chunk.").arg(filePath));
+    return false;
+  }
+
+  PcmFileData decoded;
+  decoded.sampleRate = sampleRate;
+  decoded.channels = channels;
+  if (!decodeSamples(sampleBytes, sampleByteCount, formatTag, bitsPerSample, blockAlign, channels, &decoded.samples, error)) {
+    return false;
+  }
+  *data = decoded;
+  return true;
+}
+
+bool readRawFloatFile(const QString &filePath, int sampleRate, int channels, PcmFileData *data, QString *error) {
+  if (data == nullptr) {
+    return false;
+  }
+  if (sampleRate <= 0 || channels <= 0) {
+    setError(error, QStringLiteral("Raw PCM needs a positive sample rate and channel count."));
+    return false;
+  }
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    setError(error, QStringLiteral("Could not open %1: %2").arg(filePath, file.errorString()));
+    return false;
+  }
+
+  const QByteArray bytes = file.readAll();
+  const qsizetype frames = bytes.size() / static_cast<qsizetype>(sizeof(float) * channels);
+  PcmFileData decoded;
+  decoded.sampleRate = sampleRate;
+  decoded.channels = channels;
+  decoded.samples.resize(frames * channels);
+  std::memcpy(decoded.samples.data(), bytes.constData(), static_cast<size_t>(decoded.samples.size()) * sizeof(float));
+  *data = decoded;
+  return true;
+}
+
+bool writeWavFile(const QString &filePath,
+                  const float *interleaved,
+                  int frames,
+                  int channels,
+                  int sampleRate,
+                  QString *error) {
+  if (interleaved == nullptr && frames > 0) {
+    return false;
+  }
+  if (channels <= 0 || sampleRate <= 0 || frames < 0) {
+    setError(error, QStringLiteral("Invalid WAV layout (%1 Hz, %2 channels).").arg(sampleRate).arg(channels));
+    return false;
+  }
+
+  const uint32_t dataBytes = static_cast<uint32_t>(frames) * static_cast<uint32_t>(channels) * sizeof(float);
+  QByteArray header;
+  header.append("RIFF", 4);
+  appendU32(&header, 4 + (8 + 18) + (8 + 4) + 8 + dataBytes);
+  header.append("WAVE", 4);
+  header.append("fmt ", 4);
+  appendU32(&header, 18);
+  appendU16(&header, kWaveFormatIeeeFloat);
+  appendU16(&header, static_cast<uint16_t>(channels));
+  appendU32(&header, static_cast<uint32_t>(sampleRate));
+  appendU32(&header, static_cast<uint32_t>(sampleRate) * static_cast<uint32_t>(channels) * sizeof(float));
+  appendU16(&header, static_cast<uint16_t>(channels * sizeof(float)));
+  appendU16(&header, 32);
+  appendU16(&header, 0);
+  header.append("fact", 4);
+  appendU32(&header, 4);
+  appendU32(&header, static_cast<uint32_t>(frames));
+  header.append("data", 4);
+  appendU32(&header, dataBytes);
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    setError(error, QStringLiteral("Could not write %1: %2").arg(filePath, file.errorString()));
+    return false;
+  }
+
+  const auto bodySize = static_cast<qint64>(dataBytes);
+  if (file.write(header) != header.size() ||
+      file.write(reinterpret_cast<const char *>(interleaved), bodySize) != bodySize) {
+    setError(error, QStringLiteral("Could not write %1: %2").arg(filePath, file.errorString()));
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+// Interleaved float PCM loaded from or written to disk. WAV files may be
+// 16/24/32-bit integer or 32-bit float; raw files are headerless float32
+// in the layout the caller specifies.
+struct PcmFileData {
+  QVector<float> samples;
+  int sampleRate = 0;
+  int channels = 0;
+
+  int frameCount() const { return channels > 0 ? samples.size() / channels : 0; }
+};
+
+bool readWavFile(const QString &filePath, PcmFileData *data, QString *error = nullptr);
+bool readRawFloatFile(const QString &filePath, int sampleRate, int channels, PcmFileData *data, QString *error = nullptr);
+bool writeWavFile(const QString &filePath,
+                  const float *interleaved,
+                  int frames,
+                  int channels,
+                  int sampleRate,
+                  QString *error = nullptr);
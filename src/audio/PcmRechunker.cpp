@@ -0,0 +1,32 @@
+#include "PcmRechunker.h"
+
+namespace {
+constexpr int kDefaultBlockFrames = 1024;
+constexpr int kDefaultHopFrames = 512;
+constexpr int kMinBlockFrames = 64;
+constexpr int kMaxBlockFrames = 16384;
+} // namespace
+
+PcmRechunker::PcmRechunker() { configure(kDefaultBlockFrames, kDefaultHopFrames); }
+
+void PcmRechunker::configure(int blockFrames, int hopFrames) {
+  blockFrames = std::clamp(blockFrames, kMinBlockFrames, kMaxBlockFrames);
+  hopFrames = std::clamp(hopFrames, 1, blockFrames);
+  if (blockFrames == m_blockFrames && hopFrames == m_hopFrames) {
+    return;
+  }
+  m_blockFrames = blockFrames;
+  m_hopFrames = hopFrames;
+  m_window.assign(static_cast<size_t>(blockFrames) * 2U, 0.0f);
+  reset();
+}
+
+int PcmRechunker::blockFrames() const { return m_blockFrames; }
+
+int PcmRechunker::hopFrames() const { return m_hopFrames; }
+
+void PcmRechunker::reset() {
+  m_bufferedFrames = 0;
+  m_windowStart = 0;
+  m_nextPosition = 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "PcmBlockInfo.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Turns stereo PCM in whatever block sizes the backend delivers into
+// fixed windows of blockFrames, one every hopFrames. Small blocks are
+// coalesced, large ones split, and each window is dated by its last frame.
+// A jump in samplePosition (source restart, switch) drops the partial
+// window instead of splicing unrelated audio into it.
+class PcmRechunker {
+public:
+  PcmRechunker();
+
+  void configure(int blockFrames, int hopFrames);
+  int blockFrames() const;
+  int hopFrames() const;
+  void reset();
+
+  // emit(window, newest, info): window holds blockFrames interleaved frames,
+  // newest points at its last hopFrames, the ones not in any earlier window.
+  template <typename Emit>
+  void push(const float *stereo, int frames, const PcmBlockInfo &info, Emit &&emit) {
+    if (frames <= 0) {
+      return;
+    }
+    if (m_bufferedFrames > 0 && info.samplePosition != m_nextPosition) {
+      reset();
+    }
+    if (m_bufferedFrames == 0) {
+      m_windowStart = info.samplePosition;
+    }
+    m_nextPosition = info.samplePosition + static_cast<uint64_t>(frames);
+
+    int offset = 0;
+    while (offset < frames) {
+      const int take = std::min(frames - offset, m_blockFrames - m_bufferedFrames);
+      std::memcpy(m_window.data() + 2 * m_bufferedFrames,
+                  stereo + 2 * offset,
+                  static_cast<size_t>(take) * 2U * sizeof(float));
+      m_bufferedFrames += take;
+      offset += take;
+      if (m_bufferedFrames < m_blockFrames) {
+        break;
+      }
+
+      PcmBlockInfo windowInfo;
+      windowInfo.samplePosition = m_windowStart;
+      windowInfo.sampleRate = info.sampleRate;
+      windowInfo.captureTimeNs = info.captureTimeNs;
+      if (info.sampleRate > 0) {
+        windowInfo.captureTimeNs -= static_cast<int64_t>(frames - offset) * 1000000000LL / info.sampleRate;
+      }
+      emit(static_cast<const float *>(m_window.data()),
+           static_cast<const float *>(m_window.data() + 2 * (m_blockFrames - m_hopFrames)),
+           windowInfo);
+
+      const int kept = m_blockFrames - m_hopFrames;
+      std::memmove(m_window.data(), m_window.data() + 2 * m_hopFrames, static_cast<size_t>(kept) * 2U * sizeof(float));
+      m_bufferedFrames = kept;
+      m_windowStart += static_cast<uint64_t>(m_hopFrames);
+    }
+  }
+
+private:
+  std::vector<float> m_window;
+  int m_blockFrames = 0;
+  int m_hopFrames = 0;
+  int m_bufferedFrames = 0;
+  uint64_t m_windowStart = 0;
+  uint64_t m_nextPosition = 0;
+};
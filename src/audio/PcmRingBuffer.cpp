@@ -0,0 +1,154 @@
+#include "PcmRingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+uint64_t roundUpToPowerOfTwo(uint64_t value) {
+  uint64_t result = 1;
+  while (result < value) {
+    result <<= 1U;
+  }
+  return result;
+}
+} // namespace
+
+PcmRingBuffer::PcmRingBuffer(int capacityFrames, int channels)
+    : m_channels(std::max(1, channels)),
+      m_capacity(roundUpToPowerOfTwo(static_cast<uint64_t>(std::max(1, capacityFrames)))),
+      m_mask(m_capacity - 1) {
+  m_samples.assign(static_cast<size_t>(m_capacity) * static_cast<size_t>(m_channels), 0.0f);
+}
+
+int PcmRingBuffer::channels() const { return m_channels; }
+
+int PcmRingBuffer::capacityFrames() const { return static_cast<int>(m_capacity); }
+
+void PcmRingBuffer::write(const float *interleaved, int frames) {
+  if (interleaved == nullptr || frames <= 0) {
+    return;
+  }
+
+  uint64_t count = static_cast<uint64_t>(frames);
+  uint64_t writePos = m_writePos.load(std::memory_order_relaxed);
+  if (count > m_capacity) {
+    interleaved += static_cast<size_t>(count - m_capacity) * static_cast<size_t>(m_channels);
+    writePos += count - m_capacity;
+    count = m_capacity;
+  }
+
+  // Announce the range first so a concurrent read() can tell which of the
+  // frames it copied may have been overwritten underneath it.
+  m_writeReserve.store(writePos + count, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const uint64_t start = writePos & m_mask;
+  const uint64_t firstPart = std::min(count, m_capacity - start);
+  const size_t channels = static_cast<size_t>(m_channels);
+  std::memcpy(m_samples.data() + start * channels, interleaved, firstPart * channels * sizeof(float));
+  if (firstPart < count) {
+    std::memcpy(m_samples.data(),
+                interleaved + firstPart * channels,
+                (count - firstPart) * channels * sizeof(float));
+  }
+
+  m_writePos.store(writePos + count, std::memory_order_release);
+}
+
+void PcmRingBuffer::markTimestamp(int64_t timestampNs) {
+  const uint32_t sequence = m_anchorSequence.load(std::memory_order_relaxed);
+  m_anchorSequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  m_anchorPosition.store(m_writePos.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  m_anchorTimestampNs.store(timestampNs, std::memory_order_relaxed);
+  m_anchorSequence.store(sequence + 2, std::memory_order_release);
+}
+
+int PcmRingBuffer::read(float *interleaved, int maxFrames) {
+  if (interleaved == nullptr || maxFrames <= 0) {
+    return 0;
+  }
+
+  const uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+  uint64_t readPos = m_readPos.load(std::memory_order_relaxed);
+  if (writePos - readPos > m_capacity) {
+    m_droppedFrames.fetch_add(writePos - m_capacity - readPos, std::memory_order_relaxed);
+    readPos = writePos - m_capacity;
+  }
+
+  uint64_t count = std::min<uint64_t>(writePos - readPos, static_cast<uint64_t>(maxFrames));
+  if (count == 0) {
+    m_readPos.store(readPos, std::memory_order_release);
+    return 0;
+  }
+
+  const uint64_t start = readPos & m_mask;
+  const uint64_t firstPart = std::min(count, m_capacity - start);
+  const size_t channels = static_cast<size_t>(m_channels);
+  std::memcpy(interleaved, m_samples.data() + start * channels, firstPart * channels * sizeof(float));
+  if (firstPart < count) {
+    std::memcpy(interleaved + firstPart * channels,
+                m_samples.data(),
+                (count - firstPart) * channels * sizeof(float));
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t reserve = m_writeReserve.load(std::memory_order_relaxed);
+  if (reserve > readPos + m_capacity) {
+    const uint64_t clobbered = std::min(count, reserve - m_capacity - readPos);
+    m_droppedFrames.fetch_add(clobbered, std::memory_order_relaxed);
+    readPos += clobbered;
+    count -= clobbered;
+    if (count > 0) {
+      std::memmove(interleaved,
+                   interleaved + clobbered * channels,
+                   count * channels * sizeof(float));
+    }
+  }
+
+  m_readPos.store(readPos + count, std::memory_order_release);
+  return static_cast<int>(count);
+}
+
+int PcmRingBuffer::availableFrames() const {
+  const uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+  const uint64_t readPos = m_readPos.load(std::memory_order_acquire);
+  return static_cast<int>(std::min(writePos - readPos, m_capacity));
+}
+
+void PcmRingBuffer::reset() {
+  const uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+  m_readPos.store(writePos, std::memory_order_release);
+}
+
+uint64_t PcmRingBuffer::readPosition() const { return m_readPos.load(std::memory_order_acquire); }
+
+bool PcmRingBuffer::timestampAnchor(uint64_t *framePosition, int64_t *timestampNs) const {
+  for (int attempt = 0; attempt < 4; ++attempt) {
+    const uint32_t before = m_anchorSequence.load(std::memory_order_acquire);
+    if ((before & 1U) != 0U) {
+      continue;
+    }
+    const uint64_t position = m_anchorPosition.load(std::memory_order_relaxed);
+    const int64_t timestamp = m_anchorTimestampNs.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_anchorSequence.load(std::memory_order_relaxed) != before) {
+      continue;
+    }
+    if (before == 0U) {
+      return false;
+    }
+    if (framePosition != nullptr) {
+      *framePosition = position;
+    }
+    if (timestampNs != nullptr) {
+      *timestampNs = timestamp;
+    }
+    return true;
+  }
+  return false;
+}
+
+uint64_t PcmRingBuffer::writtenFrames() const { return m_writePos.load(std::memory_order_relaxed); }
+
+uint64_t PcmRingBuffer::droppedFrames() const { return m_droppedFrames.load(std::memory_order_relaxed); }
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Fixed-capacity single-producer/single-consumer ring of interleaved float frames.
+// The producer never blocks: when the consumer falls behind, the oldest unread
+// frames are overwritten and accounted for in droppedFrames().
+class PcmRingBuffer {
+public:
+  PcmRingBuffer(int capacityFrames, int channels);
+
+  int channels() const;
+  int capacityFrames() const;
+
+  void write(const float *interleaved, int frames);
+  // Producer side: records that the frame just before the current write
+  // position was captured at timestampNs.
+  void markTimestamp(int64_t timestampNs);
+
+  int read(float *interleaved, int maxFrames);
+  int availableFrames() const;
+  void reset();
+  // Frame index one past the last frame handed out by read().
+  uint64_t readPosition() const;
+  bool timestampAnchor(uint64_t *framePosition, int64_t *timestampNs) const;
+
+  uint64_t writtenFrames() const;
+  uint64_t droppedFrames() const;
+
+private:
+  std::vector<float> m_samples;
+  int m_channels = 1;
+  uint64_t m_capacity = 0;
+  uint64_t m_mask = 0;
+
+  alignas(64) std::atomic<uint64_t> m_writeReserve{0};
+  std::atomic<uint64_t> m_writePos{0};
+  alignas(64) std::atomic<uint64_t> m_readPos{0};
+  std::atomic<uint64_t> m_droppedFrames{0};
+
+  alignas(64) std::atomic<uint32_t> m_anchorSequence{0};
+  std::atomic<uint64_t> m_anchorPosition{0};
+  std::atomic<int64_t> m_anchorTimestampNs{0};
+};
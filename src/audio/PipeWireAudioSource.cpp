@@ -1,6 +1,12 @@
 #include "PipeWireAudioSource.h"
 
+#include "AudioSourceFactory.h"
+#include "RtSafetyGuard.h"
+#include "SampleKernels.h"
+#include "ThreadPlacement.h"
+
 #ifdef HAVE_PIPEWIRE
+#include <pipewire/extensions/metadata.h>
 #include <pipewire/keys.h>
 #include <pipewire/pipewire.h>
 #include <spa/param/audio/format-utils.h>
@@ -11,24 +17,60 @@
 #endif
 
 #include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 
 #include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QMetaObject>
 #include <QSet>
+#include <QStringList>
 
-#ifdef HAVE_PIPEWIRE
 namespace {
-struct PipeWireDeviceProbeContext {
-  pw_main_loop *loop = nullptr;
-  int syncSeq = -1;
-  bool done = false;
-  QString error;
-  QVector<AudioDeviceInfo> devices;
-  QSet<QString> seenIds;
-};
+constexpr int kRingCapacityFrames = 16384;
+constexpr int kConvertChunkFrames = 512;
+constexpr int kMaxCaptureChannels = 64;
+constexpr int kMaxMixInputs = 8;
+constexpr int kInputRingCapacityFrames = 16384;
+// Inputs whose dated heads differ by less than this are mixed as they are.
+constexpr int64_t kAlignToleranceNs = 2000000;
+// An input that has delivered nothing for this long no longer holds back the mix.
+constexpr int64_t kInputStallNs = 100000000;
+// Reconnect attempts start quickly for a daemon restart and back off to this cap.
+constexpr int64_t kRetryInitialDelayNs = 50000000;
+constexpr int64_t kRetryMaxDelayNs = 2000000000;
+
+float sampleToFloat(PcmSampleFormat format, const uint8_t *sample) {
+  switch (format) {
+  case PcmSampleFormat::S16: {
+    int16_t value = 0;
+    std::memcpy(&value, sample, sizeof(value));
+    return static_cast<float>(value) * (1.0f / 32768.0f);
+  }
+  case PcmSampleFormat::S32: {
+    int32_t value = 0;
+    std::memcpy(&value, sample, sizeof(value));
+    return static_cast<float>(value) * (1.0f / 2147483648.0f);
+  }
+  case PcmSampleFormat::F32:
+    break;
+  }
+  float value = 0.0f;
+  std::memcpy(&value, sample, sizeof(value));
+  return value;
+}
 
+// A lone input at unity gain skips the staging ring and the mix pass.
+bool needsMixStage(const QVector<AudioInputConfig> &inputs) {
+  return inputs.size() > 1 || (inputs.size() == 1 && inputs.constFirst().gain != 1.0f);
+}
+
+#ifdef HAVE_PIPEWIRE
 bool isAudioMediaClass(const char *mediaClass) {
   if (mediaClass == nullptr || mediaClass[0] == '\0') {
     return false;
@@ -63,41 +105,13 @@ QString displayNameForNode(const spa_dict *props) {
   return QStringLiteral("PipeWire Node");
 }
 
-void onProbeRegistryGlobal(void *userdata,
-                           uint32_t id,
-                           uint32_t permissions,
-                           const char *type,
-                           uint32_t version,
-                           const spa_dict *props) {
-  Q_UNUSED(permissions);
-  Q_UNUSED(version);
-
-  auto *probe = static_cast<PipeWireDeviceProbeContext *>(userdata);
-  if (probe == nullptr || type == nullptr || props == nullptr) {
-    return;
-  }
-
-  if (std::strcmp(type, PW_TYPE_INTERFACE_Node) != 0) {
-    return;
-  }
-
-  const char *mediaClass = spa_dict_lookup(props, PW_KEY_MEDIA_CLASS);
-  if (!isAudioMediaClass(mediaClass)) {
-    return;
-  }
-
+AudioDeviceInfo deviceInfoForNode(uint32_t id, const spa_dict *props) {
   const QString numericId = QString::number(id);
+  const char *mediaClass = spa_dict_lookup(props, PW_KEY_MEDIA_CLASS);
   const char *nodeName = spa_dict_lookup(props, PW_KEY_NODE_NAME);
-  const QString persistentId = (nodeName != nullptr && *nodeName != '\0')
-                                   ? QString::fromUtf8(nodeName)
-                                   : numericId;
-  if (probe->seenIds.contains(persistentId)) {
-    return;
-  }
-  probe->seenIds.insert(persistentId);
 
   AudioDeviceInfo device;
-  device.id = persistentId;
+  device.id = (nodeName != nullptr && *nodeName != '\0') ? QString::fromUtf8(nodeName) : numericId;
   device.name = displayNameForNode(props);
 
   const QString mediaClassText =
@@ -108,51 +122,77 @@ void onProbeRegistryGlobal(void *userdata,
   } else {
     device.description = QStringLiteral("%1 (id=%2)").arg(mediaClassText, numericId);
   }
-
-  probe->devices.push_back(device);
+  return device;
 }
 
-void onProbeCoreDone(void *userdata, uint32_t id, int seq) {
-  auto *probe = static_cast<PipeWireDeviceProbeContext *>(userdata);
-  if (probe == nullptr) {
-    return;
+// Values of the "default" metadata are JSON objects such as {"name":"alsa_output..."}.
+QString nodeNameFromMetadataValue(const char *value) {
+  if (value == nullptr || *value == '\0') {
+    return {};
   }
-
-  if (id == PW_ID_CORE && seq == probe->syncSeq) {
-    probe->done = true;
-    if (probe->loop != nullptr) {
-      pw_main_loop_quit(probe->loop);
-    }
+  const QJsonDocument document = QJsonDocument::fromJson(QByteArray(value));
+  if (!document.isObject()) {
+    return {};
   }
+  return document.object().value(QStringLiteral("name")).toString();
 }
 
-void onProbeCoreError(void *userdata, uint32_t id, int seq, int res, const char *message) {
-  Q_UNUSED(id);
-  Q_UNUSED(seq);
-
-  if (res >= 0) {
-    return;
+// Stands in for a pw_stream in the RT self-check: one buffer, always ready,
+// and a graph clock the check advances by hand.
+struct SyntheticStream {
+  pw_buffer buffer = {};
+  spa_buffer spaBuffer = {};
+  spa_data data = {};
+  spa_chunk chunk = {};
+  int64_t nowNs = 0;
+
+  void attach(std::vector<uint8_t> &bytes, int stride) {
+    chunk.offset = 0;
+    chunk.size = static_cast<uint32_t>(bytes.size());
+    chunk.stride = stride;
+    data.data = bytes.data();
+    data.maxsize = static_cast<uint32_t>(bytes.size());
+    data.chunk = &chunk;
+    spaBuffer.n_datas = 1;
+    spaBuffer.datas = &data;
+    buffer.buffer = &spaBuffer;
   }
+};
 
-  auto *probe = static_cast<PipeWireDeviceProbeContext *>(userdata);
-  if (probe == nullptr) {
-    return;
-  }
+SyntheticStream *syntheticStream(pw_stream *stream) { return reinterpret_cast<SyntheticStream *>(stream); }
 
-  QString detail = QString::fromUtf8(spa_strerror(res));
-  if (message != nullptr && *message != '\0') {
-    detail = QStringLiteral("%1 (%2)").arg(QString::fromUtf8(message), detail);
-  }
-  probe->error = detail;
-  probe->done = true;
-  if (probe->loop != nullptr) {
-    pw_main_loop_quit(probe->loop);
-  }
+pw_buffer *dequeueSyntheticBuffer(pw_stream *stream) { return &syntheticStream(stream)->buffer; }
+
+int queueSyntheticBuffer(pw_stream *stream, pw_buffer *buffer) {
+  Q_UNUSED(stream);
+  Q_UNUSED(buffer);
+  return 0;
+}
+
+int getSyntheticTime(pw_stream *stream, pw_time *time, size_t size) {
+  std::memset(time, 0, size);
+  time->now = syntheticStream(stream)->nowNs;
+  time->rate.num = 1;
+  time->rate.denom = 48000;
+  return 0;
 }
-} // namespace
 #endif
+} // namespace
+
+PipeWireAudioSource::CaptureInput::CaptureInput(PipeWireAudioSource *source,
+                                                int inputIndex,
+                                                const AudioInputConfig &config)
+    : owner(source), index(inputIndex), deviceId(config.deviceId), gain(config.gain),
+      ring(kInputRingCapacityFrames, 2) {
+  captureScratch.assign(static_cast<size_t>(kConvertChunkFrames) * 2U, 0.0f);
+  convertScratch.assign(static_cast<size_t>(kConvertChunkFrames) * kMaxCaptureChannels, 0.0f);
+}
 
-PipeWireAudioSource::PipeWireAudioSource(QObject *parent) : AudioSource(parent) {}
+PipeWireAudioSource::PipeWireAudioSource(QObject *parent) : BufferedAudioSource(kRingCapacityFrames, parent) {
+  m_mixScratch.assign(static_cast<size_t>(kConvertChunkFrames) * 2U, 0.0f);
+  m_mixReadScratch.assign(static_cast<size_t>(kConvertChunkFrames) * 2U, 0.0f);
+  m_kernels = &sampleKernels();
+}
 
 PipeWireAudioSource::~PipeWireAudioSource() { stop(); }
 
@@ -163,6 +203,17 @@ bool PipeWireAudioSource::start() {
   }
 
   m_running = true;
+  m_sampleRate = 48000;
+  m_quantumFrames = 0;
+  m_graphDelayNs = 0;
+  m_callbackCount = 0;
+  m_emptyBufferCount = 0;
+  m_shortChunkCount = 0;
+  m_strideMismatchCount = 0;
+  m_xrunCount = 0;
+  m_reconnectCount = 0;
+  m_lastReconnectNs = 0;
+  startDraining();
   m_loopThread = std::thread(&PipeWireAudioSource::runMainLoop, this);
   Q_EMIT statusMessage(QStringLiteral("Audio backend: PipeWire (initializing)."));
   return true;
@@ -175,15 +226,19 @@ bool PipeWireAudioSource::start() {
 void PipeWireAudioSource::stop() {
 #ifdef HAVE_PIPEWIRE
   const bool wasRunning = m_running.exchange(false);
-  if (wasRunning && m_mainLoop != nullptr) {
-    pw_main_loop_quit(m_mainLoop);
+  {
+    const std::lock_guard<std::mutex> lock(m_loopMutex);
+    if (wasRunning && m_mainLoop != nullptr) {
+      pw_main_loop_quit(m_mainLoop);
+    }
   }
 
   if (m_loopThread.joinable()) {
     m_loopThread.join();
   }
+  stopDraining();
 
-  if (wasRunning || m_stream != nullptr || m_core != nullptr || m_context != nullptr || m_mainLoop != nullptr) {
+  if (wasRunning || !m_inputs.empty() || m_core != nullptr || m_context != nullptr || m_mainLoop != nullptr) {
     shutdown();
   }
 #endif
@@ -194,11 +249,8 @@ bool PipeWireAudioSource::isRunning() const { return m_running.load(); }
 QString PipeWireAudioSource::backendName() const { return QStringLiteral("PipeWire"); }
 
 QVector<AudioDeviceInfo> PipeWireAudioSource::availableDevices() const {
-#ifdef HAVE_PIPEWIRE
-  return probeDevices(nullptr);
-#else
-  return {};
-#endif
+  std::lock_guard<std::mutex> lock(m_deviceMutex);
+  return m_deviceSnapshot;
 }
 
 QString PipeWireAudioSource::selectedDeviceId() const {
@@ -211,177 +263,416 @@ void PipeWireAudioSource::setSelectedDeviceId(const QString &deviceId) {
   m_selectedDeviceId = deviceId.trimmed();
 }
 
-void PipeWireAudioSource::onProcess(void *userdata) {
-#ifdef HAVE_PIPEWIRE
-  auto *self = static_cast<PipeWireAudioSource *>(userdata);
-  if (self != nullptr) {
-    self->processBuffer();
-  }
-#else
-  Q_UNUSED(userdata);
-#endif
+QString PipeWireAudioSource::defaultDeviceId() const {
+  std::lock_guard<std::mutex> lock(m_deviceMutex);
+  return m_defaultDeviceId;
 }
 
-#ifdef HAVE_PIPEWIRE
-QVector<AudioDeviceInfo> PipeWireAudioSource::probeDevices(QString *errorMessage) {
-  if (errorMessage != nullptr) {
-    errorMessage->clear();
+bool PipeWireAudioSource::retargetDevice(const QString &deviceId) {
+  setSelectedDeviceId(deviceId);
+  return requestStreamReconnect();
+}
+
+void PipeWireAudioSource::setRequestedLatencyFrames(int frames) {
+  frames = std::max(0, frames);
+  if (m_requestedLatencyFrames.exchange(frames) != frames) {
+    requestStreamReconnect();
   }
+}
 
-  QVector<AudioDeviceInfo> devices;
-  pw_init(nullptr, nullptr);
+AudioLatencyInfo PipeWireAudioSource::latencyInfo() const {
+  AudioLatencyInfo info;
+  info.requestedFrames = m_requestedLatencyFrames.load();
+  info.quantumFrames = m_quantumFrames.load(std::memory_order_relaxed);
+  info.sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+  info.graphDelayMs = static_cast<double>(m_graphDelayNs.load(std::memory_order_relaxed)) / 1.0e6;
+  return info;
+}
 
-  pw_main_loop *loop = pw_main_loop_new(nullptr);
-  if (loop == nullptr) {
-    if (errorMessage != nullptr) {
-      *errorMessage = QStringLiteral("Failed to create PipeWire loop for device probe.");
-    }
-    pw_deinit();
-    return devices;
+void PipeWireAudioSource::setMixInputs(const QVector<AudioInputConfig> &inputs) {
+  QVector<AudioInputConfig> limited = inputs;
+  if (limited.size() > kMaxMixInputs) {
+    limited.resize(kMaxMixInputs);
+    Q_EMIT statusMessage(QStringLiteral("Only the first %1 mix inputs are captured.").arg(kMaxMixInputs));
   }
-
-  pw_context *context = pw_context_new(pw_main_loop_get_loop(loop), nullptr, 0);
-  if (context == nullptr) {
-    if (errorMessage != nullptr) {
-      *errorMessage = QStringLiteral("Failed to create PipeWire context for device probe.");
-    }
-    pw_main_loop_destroy(loop);
-    pw_deinit();
-    return devices;
+  {
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    m_mixInputs = limited;
   }
 
-  pw_core *core = pw_context_connect(context, nullptr, 0);
-  if (core == nullptr) {
-    if (errorMessage != nullptr) {
-      *errorMessage = QStringLiteral("Failed to connect to PipeWire core for device probe.");
+  // A gain-only change is applied in place; anything else rebuilds the streams.
+  const QVector<AudioInputConfig> effective = configuredInputs();
+  {
+    std::lock_guard<std::mutex> lock(m_inputsMutex);
+    bool sameTargets =
+        m_mixing.load() == needsMixStage(effective) && static_cast<int>(m_inputs.size()) == effective.size();
+    for (int i = 0; sameTargets && i < effective.size(); ++i) {
+      sameTargets = m_inputs[i]->deviceId == effective.at(i).deviceId;
     }
-    pw_context_destroy(context);
-    pw_main_loop_destroy(loop);
-    pw_deinit();
-    return devices;
-  }
-
-  auto *registry = static_cast<pw_registry *>(pw_core_get_registry(core, PW_VERSION_REGISTRY, 0));
-  if (registry == nullptr) {
-    if (errorMessage != nullptr) {
-      *errorMessage = QStringLiteral("Failed to get PipeWire registry for device probe.");
+    if (sameTargets) {
+      for (int i = 0; i < effective.size(); ++i) {
+        m_inputs[i]->gain.store(effective.at(i).gain, std::memory_order_relaxed);
+      }
+      return;
     }
-    pw_core_disconnect(core);
-    pw_context_destroy(context);
-    pw_main_loop_destroy(loop);
-    pw_deinit();
-    return devices;
   }
+  requestStreamReconnect();
+}
 
-  PipeWireDeviceProbeContext probe;
-  probe.loop = loop;
-  spa_hook registryListener = {};
-  spa_hook coreListener = {};
-
-  pw_registry_events registryEvents = {};
-  registryEvents.version = PW_VERSION_REGISTRY_EVENTS;
-  registryEvents.global = &onProbeRegistryGlobal;
-  pw_registry_add_listener(registry, &registryListener, &registryEvents, &probe);
+QVector<AudioInputStats> PipeWireAudioSource::inputStats() const {
+  QVector<AudioInputStats> stats;
+  std::lock_guard<std::mutex> lock(m_inputsMutex);
+  stats.reserve(static_cast<int>(m_inputs.size()));
+  for (const auto &input : m_inputs) {
+    AudioInputStats entry;
+    entry.deviceId = input->deviceId;
+    entry.gain = input->gain.load(std::memory_order_relaxed);
+    entry.active = input->streaming.load(std::memory_order_relaxed);
+    const AudioLevels levels = input->levelMeter.snapshot();
+    entry.peak = std::max(levels.peak[0], levels.peak[1]);
+    entry.rms = std::sqrt((levels.rms[0] * levels.rms[0] + levels.rms[1] * levels.rms[1]) * 0.5f);
+    entry.offsetMs = static_cast<double>(input->offsetNs.load(std::memory_order_relaxed)) / 1.0e6;
+    entry.xruns = input->xruns.load(std::memory_order_relaxed);
+    entry.alignedFrames = input->alignedFrames.load(std::memory_order_relaxed);
+    entry.droppedFrames = input->ring.droppedFrames();
+    stats.push_back(entry);
+  }
+  return stats;
+}
 
-  pw_core_events coreEvents = {};
-  coreEvents.version = PW_VERSION_CORE_EVENTS;
-  coreEvents.done = &onProbeCoreDone;
-  coreEvents.error = &onProbeCoreError;
-  pw_core_add_listener(core, &coreListener, &coreEvents, &probe);
+AudioCaptureStats PipeWireAudioSource::captureStats() const {
+  AudioCaptureStats stats = BufferedAudioSource::captureStats();
+  stats.callbacks = m_callbackCount.load(std::memory_order_relaxed);
+  stats.emptyBuffers = m_emptyBufferCount.load(std::memory_order_relaxed);
+  stats.shortChunks = m_shortChunkCount.load(std::memory_order_relaxed);
+  stats.strideMismatches = m_strideMismatchCount.load(std::memory_order_relaxed);
+  stats.xruns = m_xrunCount.load(std::memory_order_relaxed);
+  stats.reconnects = m_reconnectCount.load(std::memory_order_relaxed);
+  stats.lastReconnectMs = static_cast<double>(m_lastReconnectNs.load(std::memory_order_relaxed)) / 1.0e6;
+  return stats;
+}
 
-  probe.syncSeq = pw_core_sync(core, PW_ID_CORE, 0);
-  int maxIterations = 50;
-  while (!probe.done && maxIterations-- > 0) {
-    if (pw_loop_iterate(pw_main_loop_get_loop(loop), 50) < 0) {
-      break;
-    }
-  }
-  if (!probe.done && probe.error.isEmpty()) {
-    probe.error = QStringLiteral("Timed out while enumerating PipeWire devices.");
+// The environment wins over settings. Without a mix list there is a single
+// input on the selected device at unity gain.
+QVector<AudioInputConfig> PipeWireAudioSource::configuredInputs() const {
+  const QVector<AudioInputConfig> envInputs =
+      parseAudioInputList(QString::fromUtf8(qgetenv("QT6MPLAYER_PIPEWIRE_INPUTS")));
+  if (!envInputs.isEmpty()) {
+    return envInputs.mid(0, kMaxMixInputs);
   }
 
-  spa_hook_remove(&registryListener);
-  spa_hook_remove(&coreListener);
-
-  if (errorMessage != nullptr && !probe.error.isEmpty()) {
-    *errorMessage = probe.error;
+  std::lock_guard<std::mutex> lock(m_deviceMutex);
+  if (!m_mixInputs.isEmpty()) {
+    return m_mixInputs;
   }
+  const QString envTarget = QString::fromUtf8(qgetenv("QT6MPLAYER_PIPEWIRE_TARGET")).trimmed();
+  AudioInputConfig single;
+  single.deviceId = envTarget.isEmpty() ? m_selectedDeviceId.trimmed() : envTarget;
+  return {single};
+}
 
-  devices = probe.devices;
-  std::sort(devices.begin(), devices.end(), [](const AudioDeviceInfo &left, const AudioDeviceInfo &right) {
-    return QString::compare(left.name, right.name, Qt::CaseInsensitive) < 0;
-  });
+bool PipeWireAudioSource::requestStreamReconnect() {
+#ifdef HAVE_PIPEWIRE
+  // Held across the invoke so the loop thread cannot destroy the loop under it.
+  const std::lock_guard<std::mutex> lock(m_loopMutex);
+  if (!m_running || m_mainLoop == nullptr) {
+    return false;
+  }
 
-  pw_core_disconnect(core);
-  pw_context_destroy(context);
-  pw_main_loop_destroy(loop);
-  pw_deinit();
-  return devices;
+  // Only the streams are rebuilt, on the loop thread; context, core and
+  // registry stay up. The drain timer covers the switch with silence.
+  setFillGaps(true);
+  const int result =
+      pw_loop_invoke(pw_main_loop_get_loop(m_mainLoop), &PipeWireAudioSource::onReconnectInvoke, 0, nullptr, 0, false, this);
+  if (result < 0) {
+    setFillGaps(false);
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
 }
+
+void PipeWireAudioSource::onProcess(void *userdata) {
+#ifdef HAVE_PIPEWIRE
+  auto *input = static_cast<CaptureInput *>(userdata);
+  if (input == nullptr || input->owner == nullptr) {
+    return;
+  }
+  PipeWireAudioSource *self = input->owner;
+  const RtSection section;
+  if (self->m_dataThreadId.load(std::memory_order_relaxed) == 0) {
+    self->m_dataThreadId = currentThreadId();
+    registerThread(self->m_dataThreadId, ThreadRole::Capture, "pipewire-data");
+  }
+  self->processBuffer(*input);
+  if (self->m_mixing.load(std::memory_order_relaxed)) {
+    self->mixInputs();
+  }
+#else
+  Q_UNUSED(userdata);
 #endif
+}
 
-void PipeWireAudioSource::processBuffer() {
+void PipeWireAudioSource::processBuffer(CaptureInput &input) {
 #ifdef HAVE_PIPEWIRE
-  if (m_stream == nullptr) {
+  pw_stream *stream = input.stream;
+  if (stream == nullptr) {
     return;
   }
+  m_callbackCount.fetch_add(1, std::memory_order_relaxed);
 
-  pw_buffer *buffer = pw_stream_dequeue_buffer(m_stream);
+  pw_buffer *buffer = m_streamCalls.dequeueBuffer(stream);
   if (buffer == nullptr || buffer->buffer == nullptr || buffer->buffer->n_datas == 0) {
+    m_emptyBufferCount.fetch_add(1, std::memory_order_relaxed);
     return;
   }
 
   spa_data &data = buffer->buffer->datas[0];
-  if (data.data == nullptr || data.chunk == nullptr || data.chunk->size == 0) {
-    pw_stream_queue_buffer(m_stream, buffer);
+  if (data.data == nullptr || data.chunk == nullptr || data.chunk->size == 0 || data.chunk->offset >= data.maxsize) {
+    m_emptyBufferCount.fetch_add(1, std::memory_order_relaxed);
+    m_streamCalls.queueBuffer(stream, buffer);
     return;
   }
 
-  const int bytesPerSample = static_cast<int>(sizeof(float));
-  const int frameStride = bytesPerSample * m_channels;
-  if (frameStride <= 0) {
-    pw_stream_queue_buffer(m_stream, buffer);
-    return;
+  // pw_time.now is the monotonic start of this graph cycle; the last frame
+  // of the buffer left the device roughly one graph delay before that.
+  const int sampleRate = input.sampleRate.load(std::memory_order_relaxed);
+  int64_t captureTimeNs = 0;
+  pw_time time = {};
+  if (m_streamCalls.getTime(stream, &time, sizeof(time)) == 0 && time.rate.denom > 0) {
+    int64_t delayNs = time.delay * SPA_NSEC_PER_SEC * time.rate.num / time.rate.denom;
+    if (sampleRate > 0) {
+      delayNs += static_cast<int64_t>(time.buffered) * SPA_NSEC_PER_SEC / sampleRate;
+    }
+    if (input.index == 0) {
+      m_graphDelayNs.store(delayNs, std::memory_order_relaxed);
+    }
+    if (time.now > 0) {
+      captureTimeNs = time.now - delayNs;
+    }
   }
 
-  if (data.chunk->offset >= data.maxsize) {
-    pw_stream_queue_buffer(m_stream, buffer);
+  const auto *rawData = static_cast<const uint8_t *>(data.data);
+  const uint32_t available = data.maxsize - data.chunk->offset;
+  consumeChunk(input,
+               rawData + data.chunk->offset,
+               std::min<uint32_t>(data.chunk->size, available),
+               data.chunk->stride,
+               captureTimeNs);
+  m_streamCalls.queueBuffer(stream, buffer);
+#else
+  Q_UNUSED(input);
+#endif
+}
+
+// Everything after the dequeue; kept free of PipeWire types so the RT self
+// check can feed it synthetic buffers.
+void PipeWireAudioSource::consumeChunk(CaptureInput &input,
+                                       const uint8_t *bytes,
+                                       uint32_t byteCount,
+                                       int chunkStride,
+                                       int64_t captureTimeNs) {
+  const int channels = input.channels.load(std::memory_order_relaxed);
+  const int frameStride = bytesPerSample(input.sampleFormat.load(std::memory_order_relaxed)) * channels;
+  if (frameStride <= 0) {
     return;
   }
 
-  const auto *rawData = static_cast<const uint8_t *>(data.data);
-  const uint32_t available = data.maxsize - data.chunk->offset;
-  const uint32_t byteCount = std::min<uint32_t>(data.chunk->size, available);
-  const int stride = data.chunk->stride > 0 ? static_cast<int>(data.chunk->stride) : frameStride;
+  const int stride = chunkStride > 0 ? chunkStride : frameStride;
+  if (stride != frameStride) {
+    m_strideMismatchCount.fetch_add(1, std::memory_order_relaxed);
+  }
   if (stride < frameStride || byteCount == 0U) {
-    pw_stream_queue_buffer(m_stream, buffer);
     return;
   }
 
+  // Short: a trailing partial frame, or fewer frames than the previous cycle.
   const int frameCount = static_cast<int>(byteCount / static_cast<uint32_t>(stride));
+  if (byteCount % static_cast<uint32_t>(stride) != 0U || frameCount < input.lastFrameCount) {
+    m_shortChunkCount.fetch_add(1, std::memory_order_relaxed);
+  }
   if (frameCount <= 0) {
-    pw_stream_queue_buffer(m_stream, buffer);
+    return;
+  }
+  input.lastFrameCount = frameCount;
+
+  if (captureTimeNs <= 0) {
+    captureTimeNs = monotonicTimeNs();
+  }
+  if (input.index == 0) {
+    m_quantumFrames.store(frameCount, std::memory_order_relaxed);
+  }
+
+  // A buffer that ends well past where the previous one predicted means the
+  // graph skipped at least half a quantum for this input.
+  const int sampleRate = input.sampleRate.load(std::memory_order_relaxed);
+  if (sampleRate > 0) {
+    const int64_t blockNs = static_cast<int64_t>(frameCount) * 1000000000LL / sampleRate;
+    if (input.expectedCaptureNs > 0 && captureTimeNs - input.expectedCaptureNs > blockNs / 2) {
+      input.xruns.fetch_add(1, std::memory_order_relaxed);
+      m_xrunCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    input.expectedCaptureNs = captureTimeNs + blockNs;
+  }
+
+  PcmRingBuffer &target = m_mixing.load(std::memory_order_relaxed) ? input.ring : m_ring;
+  captureInterleaved(input, bytes, frameCount, stride, target);
+  target.markTimestamp(captureTimeNs);
+  input.lastCaptureNs.store(monotonicTimeNs(), std::memory_order_relaxed);
+}
+
+void PipeWireAudioSource::captureInterleaved(CaptureInput &input,
+                                             const uint8_t *samples,
+                                             int frameCount,
+                                             int stride,
+                                             PcmRingBuffer &target) {
+  const PcmSampleFormat format = input.sampleFormat.load(std::memory_order_relaxed);
+  const int channels = input.channels.load(std::memory_order_relaxed);
+  const int sampleBytes = bytesPerSample(format);
+  const int frameStride = sampleBytes * channels;
+  if (channels <= 0 || channels > kMaxCaptureChannels || stride < frameStride) {
+    return;
+  }
+
+  // Mixed inputs are metered after their gain, in mixInputs().
+  const bool meter = &target == &m_ring;
+  const int sampleRate = input.sampleRate.load(std::memory_order_relaxed);
+  const auto writeStereo = [&](const float *stereo, int frames) {
+    target.write(stereo, frames);
+    if (meter) {
+      input.levelMeter.process(stereo, frames, sampleRate);
+      meterCaptured(stereo, frames);
+    }
+  };
+
+  if (format == PcmSampleFormat::F32 && channels == 2 && stride == frameStride) {
+    writeStereo(reinterpret_cast<const float *>(samples), frameCount);
     return;
   }
 
-  const auto *chunkData = rawData + data.chunk->offset;
-  QVector<float> mono(frameCount);
-  for (int i = 0; i < frameCount; ++i) {
-    const auto *frameSamples =
-        reinterpret_cast<const float *>(chunkData + static_cast<size_t>(i) * static_cast<size_t>(stride));
-    float accum = 0.0f;
-    for (int c = 0; c < m_channels; ++c) {
-      accum += frameSamples[c];
+  float *stereo = input.captureScratch.data();
+  if (stride == frameStride) {
+    for (int chunkStart = 0; chunkStart < frameCount; chunkStart += kConvertChunkFrames) {
+      const int chunkFrames = std::min(kConvertChunkFrames, frameCount - chunkStart);
+      const uint8_t *chunk = samples + static_cast<size_t>(chunkStart) * static_cast<size_t>(stride);
+      const int chunkSamples = chunkFrames * channels;
+      const float *floatSamples = input.convertScratch.data();
+      if (format == PcmSampleFormat::S32) {
+        m_kernels->s32ToFloat(reinterpret_cast<const int32_t *>(chunk), input.convertScratch.data(), chunkSamples);
+      } else if (format == PcmSampleFormat::S16) {
+        m_kernels->s16ToFloat(reinterpret_cast<const int16_t *>(chunk), input.convertScratch.data(), chunkSamples);
+      } else {
+        floatSamples = reinterpret_cast<const float *>(chunk);
+      }
+      m_kernels->interleavedToStereo(floatSamples, stereo, chunkFrames, channels);
+      writeStereo(stereo, chunkFrames);
     }
-    mono[i] = accum / static_cast<float>(m_channels);
+    return;
   }
 
-  pw_stream_queue_buffer(m_stream, buffer);
+  for (int chunkStart = 0; chunkStart < frameCount; chunkStart += kConvertChunkFrames) {
+    const int chunkFrames = std::min(kConvertChunkFrames, frameCount - chunkStart);
+    for (int i = 0; i < chunkFrames; ++i) {
+      const uint8_t *frame = samples + static_cast<size_t>(chunkStart + i) * static_cast<size_t>(stride);
+      const int rightOffset = channels > 1 ? sampleBytes : 0;
+      stereo[2 * i] = sampleToFloat(format, frame);
+      stereo[2 * i + 1] = sampleToFloat(format, frame + rightOffset);
+    }
+    writeStereo(stereo, chunkFrames);
+  }
+}
 
-  QMetaObject::invokeMethod(this,
-                            [this, mono]() { Q_EMIT pcmFrameReady(mono); },
-                            Qt::QueuedConnection);
-#endif
+// Runs on the data thread after any input delivered. Each live input's next
+// unread frame is dated from its ring's timestamp anchor; inputs that lag the
+// newest one drop the difference, then the common span is mixed with gain.
+void PipeWireAudioSource::mixInputs() {
+  std::unique_lock<std::mutex> lock(m_inputsMutex, std::try_to_lock);
+  if (!lock.owns_lock() || m_inputs.empty()) {
+    return;
+  }
+
+  const int sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+  if (sampleRate <= 0) {
+    return;
+  }
+  const int64_t now = monotonicTimeNs();
+  const int inputCount = std::min(static_cast<int>(m_inputs.size()), kMaxMixInputs);
+  bool live[kMaxMixInputs] = {};
+  int64_t heads[kMaxMixInputs] = {};
+  int64_t newestHead = INT64_MIN;
+  for (int i = 0; i < inputCount; ++i) {
+    CaptureInput &input = *m_inputs[i];
+    if (!input.streaming.load(std::memory_order_relaxed) ||
+        input.sampleRate.load(std::memory_order_relaxed) != sampleRate ||
+        now - input.lastCaptureNs.load(std::memory_order_relaxed) > kInputStallNs) {
+      continue;
+    }
+    const int available = input.ring.availableFrames();
+    uint64_t anchorPosition = 0;
+    int64_t anchorTimestampNs = 0;
+    if (available <= 0 || !input.ring.timestampAnchor(&anchorPosition, &anchorTimestampNs)) {
+      // A live input that has not delivered this cycle yet; its own callback mixes.
+      return;
+    }
+    const uint64_t readPosition = input.ring.readPosition();
+    const auto framesAhead = static_cast<int64_t>(anchorPosition - 1U - readPosition);
+    heads[i] = anchorTimestampNs - framesAhead * 1000000000LL / sampleRate;
+    live[i] = true;
+    newestHead = std::max(newestHead, heads[i]);
+  }
+  if (newestHead == INT64_MIN) {
+    return;
+  }
+
+  int frames = INT_MAX;
+  for (int i = 0; i < inputCount; ++i) {
+    if (!live[i]) {
+      continue;
+    }
+    CaptureInput &input = *m_inputs[i];
+    const int64_t lagNs = newestHead - heads[i];
+    input.offsetNs.store(lagNs, std::memory_order_relaxed);
+    int available = input.ring.availableFrames();
+    if (lagNs > kAlignToleranceNs) {
+      int skip = static_cast<int>(std::min<int64_t>(available, lagNs * sampleRate / 1000000000LL));
+      input.alignedFrames.fetch_add(static_cast<uint64_t>(skip), std::memory_order_relaxed);
+      while (skip > 0) {
+        const int discarded = input.ring.read(m_mixReadScratch.data(), std::min(skip, kConvertChunkFrames));
+        if (discarded <= 0) {
+          break;
+        }
+        skip -= discarded;
+        available -= discarded;
+      }
+    }
+    frames = std::min(frames, available);
+  }
+  if (frames <= 0 || frames == INT_MAX) {
+    return;
+  }
+
+  for (int mixed = 0; mixed < frames; mixed += kConvertChunkFrames) {
+    const int chunkFrames = std::min(kConvertChunkFrames, frames - mixed);
+    std::fill_n(m_mixScratch.begin(), chunkFrames * 2, 0.0f);
+    for (int i = 0; i < inputCount; ++i) {
+      if (!live[i]) {
+        continue;
+      }
+      CaptureInput &input = *m_inputs[i];
+      const int read = input.ring.read(m_mixReadScratch.data(), chunkFrames);
+      const float gain = input.gain.load(std::memory_order_relaxed);
+      for (int s = 0; s < read * 2; ++s) {
+        m_mixReadScratch[s] *= gain;
+        m_mixScratch[s] += m_mixReadScratch[s];
+      }
+      input.levelMeter.process(m_mixReadScratch.data(), read, sampleRate);
+    }
+    m_ring.write(m_mixScratch.data(), chunkFrames);
+    meterCaptured(m_mixScratch.data(), chunkFrames);
+  }
+  m_ring.markTimestamp(newestHead + static_cast<int64_t>(frames - 1) * 1000000000LL / sampleRate);
 }
 
 #ifdef HAVE_PIPEWIRE
@@ -390,21 +681,45 @@ void PipeWireAudioSource::onStateChanged(void *userdata,
                                          enum pw_stream_state state,
                                          const char *error) {
   Q_UNUSED(oldState);
-  auto *self = static_cast<PipeWireAudioSource *>(userdata);
-  if (self == nullptr) {
+  auto *input = static_cast<CaptureInput *>(userdata);
+  if (input == nullptr || input->owner == nullptr) {
     return;
   }
+  PipeWireAudioSource *self = input->owner;
+  input->streaming.store(state == PW_STREAM_STATE_STREAMING, std::memory_order_relaxed);
 
+  const QString label = self->m_mixing.load() ? QStringLiteral("PipeWire input %1").arg(input->index + 1)
+                                              : QStringLiteral("PipeWire stream");
   if (state == PW_STREAM_STATE_STREAMING) {
+    self->setFillGaps(false);
+    const int sampleRate = input->sampleRate.load();
+    const int channels = input->channels.load();
     QMetaObject::invokeMethod(
         self,
-        [self]() {
-          Q_EMIT self->statusMessage(
-              QStringLiteral("PipeWire stream active (%1 Hz, %2 channels).")
-                  .arg(self->m_sampleRate)
-                  .arg(self->m_channels));
+        [self, label, sampleRate, channels]() {
+          Q_EMIT self->statusMessage(QStringLiteral("%1 active (%2 Hz, %3 channels, %4 kernels).")
+                                         .arg(label)
+                                         .arg(sampleRate)
+                                         .arg(channels)
+                                         .arg(QString::fromLatin1(self->m_kernels->name)));
         },
         Qt::QueuedConnection);
+    if (self->m_disconnectedAtNs != 0) {
+      const int64_t outageNs = monotonicTimeNs() - self->m_disconnectedAtNs;
+      const int attempts = self->m_retryAttempts;
+      self->m_disconnectedAtNs = 0;
+      self->m_retryAttempts = 0;
+      self->m_reconnectCount.fetch_add(1, std::memory_order_relaxed);
+      self->m_lastReconnectNs.store(outageNs, std::memory_order_relaxed);
+      QMetaObject::invokeMethod(
+          self,
+          [self, outageNs, attempts]() {
+            Q_EMIT self->statusMessage(QStringLiteral("PipeWire reconnected after %1 ms (%2 attempts).")
+                                           .arg(static_cast<double>(outageNs) / 1.0e6, 0, 'f', 0)
+                                           .arg(attempts));
+          },
+          Qt::QueuedConnection);
+    }
     return;
   }
 
@@ -413,17 +728,98 @@ void PipeWireAudioSource::onStateChanged(void *userdata,
         error != nullptr ? QString::fromUtf8(error) : QStringLiteral("unknown stream error");
     QMetaObject::invokeMethod(
         self,
-        [self, detail]() { Q_EMIT self->errorMessage(QStringLiteral("PipeWire stream error: %1").arg(detail)); },
+        [self, label, detail]() { Q_EMIT self->errorMessage(QStringLiteral("%1 error: %2").arg(label, detail)); },
         Qt::QueuedConnection);
-    self->m_running = false;
-    if (self->m_mainLoop != nullptr) {
-      pw_main_loop_quit(self->m_mainLoop);
+    // A failed secondary input drops out of the mix; the others keep running.
+    if (input->index > 0 || self->m_sessionLost) {
+      return;
     }
+    self->scheduleSessionRetry();
+  }
+}
+
+void PipeWireAudioSource::onParamChanged(void *userdata, uint32_t id, const spa_pod *param) {
+  auto *input = static_cast<CaptureInput *>(userdata);
+  if (input == nullptr || input->owner == nullptr || param == nullptr || id != SPA_PARAM_Format) {
+    return;
+  }
+  PipeWireAudioSource *self = input->owner;
+
+  uint32_t mediaType = 0;
+  uint32_t mediaSubtype = 0;
+  if (spa_format_parse(param, &mediaType, &mediaSubtype) < 0 || mediaType != SPA_MEDIA_TYPE_audio ||
+      mediaSubtype != SPA_MEDIA_SUBTYPE_raw) {
+    return;
+  }
+
+  spa_audio_info_raw info = {};
+  if (spa_format_audio_raw_parse(param, &info) < 0) {
+    return;
+  }
+
+  PcmSampleFormat format = PcmSampleFormat::F32;
+  switch (info.format) {
+  case SPA_AUDIO_FORMAT_F32:
+    format = PcmSampleFormat::F32;
+    break;
+  case SPA_AUDIO_FORMAT_S32:
+    format = PcmSampleFormat::S32;
+    break;
+  case SPA_AUDIO_FORMAT_S16:
+    format = PcmSampleFormat::S16;
+    break;
+  default: {
+    const QString detail = QString::number(info.format);
+    QMetaObject::invokeMethod(
+        self,
+        [self, detail]() {
+          Q_EMIT self->errorMessage(QStringLiteral("PipeWire negotiated unsupported sample format %1.").arg(detail));
+        },
+        Qt::QueuedConnection);
+    return;
+  }
+  }
+
+  const int channels = std::clamp(static_cast<int>(info.channels), 1, kMaxCaptureChannels);
+  const int sampleRate = info.rate > 0 ? static_cast<int>(info.rate) : input->sampleRate.load();
+  input->sampleFormat.store(format, std::memory_order_relaxed);
+  input->channels.store(channels, std::memory_order_relaxed);
+  input->sampleRate.store(sampleRate, std::memory_order_relaxed);
+  // The first input sets the mix rate; inputs at another rate are left out.
+  if (input->index == 0) {
+    self->m_sampleRate.store(sampleRate, std::memory_order_relaxed);
   }
+
+  const QString formatName = QString::fromLatin1(sampleFormatName(format));
+  const int inputNumber = input->index + 1;
+  const bool mixing = self->m_mixing.load();
+  const int mixRate = self->m_sampleRate.load();
+  QMetaObject::invokeMethod(
+      self,
+      [self, formatName, sampleRate, channels, inputNumber, mixing, mixRate]() {
+        if (!mixing) {
+          Q_EMIT self->statusMessage(QStringLiteral("PipeWire format negotiated: %1, %2 Hz, %3 channels.")
+                                         .arg(formatName)
+                                         .arg(sampleRate)
+                                         .arg(channels));
+          return;
+        }
+        Q_EMIT self->statusMessage(QStringLiteral("PipeWire input %1 format: %2, %3 Hz, %4 channels.")
+                                       .arg(inputNumber)
+                                       .arg(formatName)
+                                       .arg(sampleRate)
+                                       .arg(channels));
+        if (sampleRate != mixRate) {
+          Q_EMIT self->errorMessage(QStringLiteral("PipeWire input %1 runs at %2 Hz; only inputs at %3 Hz are mixed.")
+                                        .arg(inputNumber)
+                                        .arg(sampleRate)
+                                        .arg(mixRate));
+        }
+      },
+      Qt::QueuedConnection);
 }
 
 void PipeWireAudioSource::onCoreError(void *userdata, uint32_t id, int seq, int res, const char *message) {
-  Q_UNUSED(id);
   Q_UNUSED(seq);
 
   if (res >= 0) {
@@ -444,150 +840,691 @@ void PipeWireAudioSource::onCoreError(void *userdata, uint32_t id, int seq, int
       self,
       [self, detail]() { Q_EMIT self->errorMessage(QStringLiteral("PipeWire core error: %1").arg(detail)); },
       Qt::QueuedConnection);
-  self->m_running = false;
-  if (self->m_mainLoop != nullptr) {
-    pw_main_loop_quit(self->m_mainLoop);
+  // Errors on the core itself mean the connection is gone (daemon restart);
+  // errors on other proxies surface through their own streams.
+  if (id == PW_ID_CORE && !self->m_sessionLost) {
+    self->scheduleSessionRetry();
+  }
+}
+
+void PipeWireAudioSource::onCoreDone(void *userdata, uint32_t id, int seq) {
+  auto *self = static_cast<PipeWireAudioSource *>(userdata);
+  if (self == nullptr || id != PW_ID_CORE || seq != self->m_registrySyncSeq) {
+    return;
+  }
+
+  // The initial registry burst is published once, not one global at a time.
+  self->m_registrySynced = true;
+  self->publishDeviceSnapshot();
+  if (self->m_awaitingTargets && self->targetsListed()) {
+    self->m_awaitingTargets = false;
   }
 }
+
+void PipeWireAudioSource::onRegistryGlobal(void *userdata,
+                                           uint32_t id,
+                                           uint32_t permissions,
+                                           const char *type,
+                                           uint32_t version,
+                                           const spa_dict *props) {
+  Q_UNUSED(permissions);
+  Q_UNUSED(version);
+
+  auto *self = static_cast<PipeWireAudioSource *>(userdata);
+  if (self == nullptr || type == nullptr || props == nullptr) {
+    return;
+  }
+
+  if (std::strcmp(type, PW_TYPE_INTERFACE_Metadata) == 0) {
+    const char *metadataName = spa_dict_lookup(props, PW_KEY_METADATA_NAME);
+    if (self->m_defaultMetadata != nullptr || metadataName == nullptr ||
+        std::strcmp(metadataName, "default") != 0) {
+      return;
+    }
+
+    static const pw_metadata_events metadataEvents = [] {
+      pw_metadata_events events = {};
+      events.version = PW_VERSION_METADATA_EVENTS;
+      events.property = &PipeWireAudioSource::onMetadataProperty;
+      return events;
+    }();
+
+    self->m_defaultMetadata = static_cast<pw_metadata *>(
+        pw_registry_bind(self->m_registry, id, PW_TYPE_INTERFACE_Metadata, PW_VERSION_METADATA, 0));
+    if (self->m_defaultMetadata != nullptr) {
+      self->m_defaultMetadataId = id;
+      pw_metadata_add_listener(self->m_defaultMetadata, &self->m_metadataListener, &metadataEvents, self);
+      self->m_metadataListenerAttached = true;
+    }
+    return;
+  }
+
+  if (std::strcmp(type, PW_TYPE_INTERFACE_Node) != 0 ||
+      !isAudioMediaClass(spa_dict_lookup(props, PW_KEY_MEDIA_CLASS))) {
+    return;
+  }
+
+  self->m_registryNodes.insert(id, deviceInfoForNode(id, props));
+  if (!self->m_registrySynced) {
+    return;
+  }
+  self->publishDeviceSnapshot();
+
+  // After a reconnect the streams can come up before the daemon lists their
+  // target nodes, and the session manager then links them to the default.
+  // Relink once every target is back.
+  if (self->m_awaitingTargets && !self->m_sessionLost && self->targetsListed()) {
+    self->m_awaitingTargets = false;
+    self->setFillGaps(true);
+    const int result = self->rebuildInputs();
+    if (result < 0) {
+      self->scheduleSessionRetry();
+    }
+  }
+}
+
+void PipeWireAudioSource::onRegistryGlobalRemove(void *userdata, uint32_t id) {
+  auto *self = static_cast<PipeWireAudioSource *>(userdata);
+  if (self == nullptr) {
+    return;
+  }
+
+  if (self->m_defaultMetadata != nullptr && id == self->m_defaultMetadataId) {
+    if (self->m_metadataListenerAttached) {
+      spa_hook_remove(&self->m_metadataListener);
+      self->m_metadataListenerAttached = false;
+    }
+    pw_proxy_destroy(reinterpret_cast<pw_proxy *>(self->m_defaultMetadata));
+    self->m_defaultMetadata = nullptr;
+    return;
+  }
+
+  if (self->m_registryNodes.remove(id) > 0 && self->m_registrySynced) {
+    self->publishDeviceSnapshot();
+  }
+}
+
+int PipeWireAudioSource::onMetadataProperty(void *userdata,
+                                            uint32_t subject,
+                                            const char *key,
+                                            const char *type,
+                                            const char *value) {
+  Q_UNUSED(type);
+
+  auto *self = static_cast<PipeWireAudioSource *>(userdata);
+  if (self == nullptr || subject != PW_ID_CORE) {
+    return 0;
+  }
+
+  // A null key clears every property of the subject.
+  if (key != nullptr && std::strcmp(key, "default.audio.sink") != 0) {
+    return 0;
+  }
+
+  const QString defaultId = key != nullptr ? nodeNameFromMetadataValue(value) : QString();
+  {
+    std::lock_guard<std::mutex> lock(self->m_deviceMutex);
+    if (self->m_defaultDeviceId == defaultId) {
+      return 0;
+    }
+    self->m_defaultDeviceId = defaultId;
+  }
+
+  QMetaObject::invokeMethod(
+      self, [self, defaultId]() { Q_EMIT self->defaultDeviceChanged(defaultId); }, Qt::QueuedConnection);
+  return 0;
+}
+
+void PipeWireAudioSource::publishDeviceSnapshot() {
+  QVector<AudioDeviceInfo> devices;
+  devices.reserve(m_registryNodes.size());
+  QSet<QString> seenIds;
+  for (auto it = m_registryNodes.cbegin(); it != m_registryNodes.cend(); ++it) {
+    if (seenIds.contains(it.value().id)) {
+      continue;
+    }
+    seenIds.insert(it.value().id);
+    devices.push_back(it.value());
+  }
+  std::sort(devices.begin(), devices.end(), [](const AudioDeviceInfo &left, const AudioDeviceInfo &right) {
+    return QString::compare(left.name, right.name, Qt::CaseInsensitive) < 0;
+  });
+
+  QVector<AudioDeviceInfo> added;
+  QVector<AudioDeviceInfo> changed;
+  QStringList removed;
+  {
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    QHash<QString, AudioDeviceInfo> previous;
+    for (const AudioDeviceInfo &device : m_deviceSnapshot) {
+      previous.insert(device.id, device);
+    }
+    for (const AudioDeviceInfo &device : devices) {
+      const auto it = previous.constFind(device.id);
+      if (it == previous.cend()) {
+        added.push_back(device);
+      } else if (it->name != device.name || it->description != device.description) {
+        changed.push_back(device);
+      }
+    }
+    for (const AudioDeviceInfo &device : m_deviceSnapshot) {
+      if (!seenIds.contains(device.id)) {
+        removed.push_back(device.id);
+      }
+    }
+    if (added.isEmpty() && changed.isEmpty() && removed.isEmpty()) {
+      return;
+    }
+    m_deviceSnapshot = devices;
+  }
+
+  QMetaObject::invokeMethod(
+      this,
+      [this, added, changed, removed]() {
+        for (const AudioDeviceInfo &device : added) {
+          Q_EMIT deviceAdded(device);
+        }
+        for (const AudioDeviceInfo &device : changed) {
+          Q_EMIT deviceChanged(device);
+        }
+        for (const QString &deviceId : removed) {
+          Q_EMIT deviceRemoved(deviceId);
+        }
+        Q_EMIT devicesChanged();
+      },
+      Qt::QueuedConnection);
+}
+#endif
+
+bool PipeWireAudioSource::runRtSelfCheck(QString *report) {
+  constexpr int kFrames = 256;
+  constexpr int kCycles = 64;
+  const int64_t blockNs = static_cast<int64_t>(kFrames) * 1000000000LL / 48000;
+
+  struct Case {
+    const char *name;
+    PcmSampleFormat format;
+    int channels;
+    int padBytes;
+  };
+  const Case cases[] = {
+      {"F32 stereo", PcmSampleFormat::F32, 2, 0},
+      {"S16 5.1", PcmSampleFormat::S16, 6, 0},
+      {"S32 7.1", PcmSampleFormat::S32, 8, 0},
+      {"F32 stereo, padded stride", PcmSampleFormat::F32, 2, 4},
+  };
+
+  // Everything the cycles touch is allocated up front, outside any section.
+  std::vector<std::vector<uint8_t>> buffers;
+  for (const Case &testCase : cases) {
+    const int stride = bytesPerSample(testCase.format) * testCase.channels + testCase.padBytes;
+    std::vector<uint8_t> buffer(static_cast<size_t>(stride) * kFrames);
+    for (size_t i = 0; i < buffer.size(); ++i) {
+      buffer[i] = static_cast<uint8_t>((i * 37U) & 0x3fU);
+    }
+    buffers.push_back(std::move(buffer));
+  }
+
+  const auto setFormat = [](CaptureInput &input, const Case &testCase) {
+    input.sampleFormat.store(testCase.format);
+    input.channels.store(testCase.channels);
+    input.sampleRate.store(48000);
+    input.streaming.store(true);
+  };
+  const auto strideOf = [](const Case &testCase) {
+    return bytesPerSample(testCase.format) * testCase.channels + testCase.padBytes;
+  };
+
+#ifdef HAVE_PIPEWIRE
+  // Each input gets a synthetic stream and the cycles go through onProcess,
+  // so dequeue, timing, conversion and mixing all run as in a real callback.
+  std::vector<SyntheticStream> streams(std::size(cases));
+  for (size_t c = 0; c < streams.size(); ++c) {
+    streams[c].attach(buffers[c], strideOf(cases[c]));
+  }
+  const StreamCalls pipeWireCalls = m_streamCalls;
+  m_streamCalls = {&dequeueSyntheticBuffer, &queueSyntheticBuffer, &getSyntheticTime};
+  const auto attachInput = [&streams](CaptureInput &input, int c) {
+    input.stream = reinterpret_cast<pw_stream *>(&streams[c]);
+  };
+  const auto runCycle = [&streams](CaptureInput &input, int c, int64_t timeNs) {
+    streams[c].nowNs = timeNs;
+    onProcess(&input);
+  };
+#else
+  // Without PipeWire there is no callback to drive; feed the path after the dequeue.
+  const auto attachInput = [](CaptureInput &, int) {};
+  const auto runCycle = [this, &buffers, &cases, &strideOf](CaptureInput &input, int c, int64_t timeNs) {
+    const RtSection section;
+    consumeChunk(input, buffers[c].data(), static_cast<uint32_t>(buffers[c].size()), strideOf(cases[c]), timeNs);
+    if (m_mixing.load(std::memory_order_relaxed)) {
+      mixInputs();
+    }
+  };
+#endif
+
+  const RtSafetyCounts before = rtSafetyCounts();
+  int callbacks = 0;
+  m_sampleRate = 48000;
+
+  // A lone input writing straight into the output ring, once per layout.
+  for (int c = 0; c < static_cast<int>(std::size(cases)); ++c) {
+    m_inputs.clear();
+    m_inputs.push_back(std::make_unique<CaptureInput>(this, 0, AudioInputConfig{}));
+    m_mixing = false;
+    CaptureInput &input = *m_inputs.front();
+    setFormat(input, cases[c]);
+    attachInput(input, c);
+    for (int cycle = 0; cycle < kCycles; ++cycle) {
+      runCycle(input, c, (cycle + 1) * blockNs);
+      ++callbacks;
+    }
+  }
+
+  // Two inputs through the staging rings and the mixer.
+  m_inputs.clear();
+  m_inputs.push_back(std::make_unique<CaptureInput>(this, 0, AudioInputConfig{QString(), 1.0f}));
+  m_inputs.push_back(std::make_unique<CaptureInput>(this, 1, AudioInputConfig{QString(), 0.5f}));
+  m_mixing = true;
+  for (int i = 0; i < 2; ++i) {
+    setFormat(*m_inputs[i], cases[i]);
+    attachInput(*m_inputs[i], i);
+  }
+  for (int cycle = 0; cycle < kCycles; ++cycle) {
+    for (int i = 0; i < 2; ++i) {
+      runCycle(*m_inputs[i], i, (cycle + 1) * blockNs);
+      ++callbacks;
+    }
+  }
+
+  const RtSafetyCounts after = rtSafetyCounts();
+  const uint64_t allocations = after.allocations - before.allocations;
+  const uint64_t frees = after.frees - before.frees;
+  const uint64_t mutexLocks = after.mutexLocks - before.mutexLocks;
+  const uint64_t mutexTryLocks = after.mutexTryLocks - before.mutexTryLocks;
+  const bool clean = allocations == 0 && frees == 0 && mutexLocks == 0;
+
+  // The synthetic streams are not PipeWire's to destroy.
+  for (const std::unique_ptr<CaptureInput> &input : m_inputs) {
+    input->stream = nullptr;
+  }
+  m_inputs.clear();
+  m_mixing = false;
+#ifdef HAVE_PIPEWIRE
+  m_streamCalls = pipeWireCalls;
+  unregisterThread(m_dataThreadId.exchange(0));
 #endif
 
+  if (report != nullptr) {
+    *report = QStringLiteral("%1 simulated process callbacks (%2 kernels): %3 allocations, %4 frees, %5 mutex locks (%6 try-locks).")
+                  .arg(callbacks)
+                  .arg(QString::fromLatin1(m_kernels->name))
+                  .arg(allocations)
+                  .arg(frees)
+                  .arg(mutexLocks)
+                  .arg(mutexTryLocks);
+  }
+  return clean;
+}
+
 void PipeWireAudioSource::runMainLoop() {
 #ifdef HAVE_PIPEWIRE
+  const ThreadPlacementScope placement(ThreadRole::Worker, "pipewire-loop");
   pw_init(nullptr, nullptr);
 
   const auto fail = [this](const QString &message) {
-    QMetaObject::invokeMethod(this, [this, message]() { Q_EMIT errorMessage(message); }, Qt::QueuedConnection);
     m_running = false;
+    QMetaObject::invokeMethod(
+        this,
+        [this, message]() {
+          // As stop() does, unless the source was started again meanwhile;
+          // otherwise gap filling would keep emitting silence for a dead source.
+          if (!m_running) {
+            stopDraining();
+          }
+          Q_EMIT errorMessage(message);
+        },
+        Qt::QueuedConnection);
     shutdown();
   };
 
-  m_mainLoop = pw_main_loop_new(nullptr);
+  pw_main_loop *mainLoop = pw_main_loop_new(nullptr);
+  {
+    const std::lock_guard<std::mutex> lock(m_loopMutex);
+    m_mainLoop = mainLoop;
+  }
   if (m_mainLoop == nullptr) {
     fail(QStringLiteral("Failed to create PipeWire main loop."));
     return;
   }
+  m_retryTimer = pw_loop_add_timer(pw_main_loop_get_loop(m_mainLoop), &PipeWireAudioSource::onSessionRetry, this);
+  m_sessionLost = false;
+  m_awaitingTargets = false;
+  m_retryAttempts = 0;
+  m_disconnectedAtNs = 0;
+
+  // Only the first connection may fail the source, so callers can fall back
+  // to another backend; later losses are retried on the loop.
+  QString error;
+  if (!connectSession(&error)) {
+    fail(error);
+    return;
+  }
+
+  pw_main_loop_run(m_mainLoop);
+#else
+  QMetaObject::invokeMethod(this,
+                            [this]() { Q_EMIT errorMessage(QStringLiteral("PipeWire support unavailable.")); },
+                            Qt::QueuedConnection);
+#endif
+}
 
+#ifdef HAVE_PIPEWIRE
+bool PipeWireAudioSource::connectSession(QString *error) {
   m_context = pw_context_new(pw_main_loop_get_loop(m_mainLoop), nullptr, 0);
   if (m_context == nullptr) {
-    fail(QStringLiteral("Failed to create PipeWire context."));
-    return;
+    *error = QStringLiteral("Failed to create PipeWire context.");
+    return false;
   }
 
   m_core = pw_context_connect(m_context, nullptr, 0);
   if (m_core == nullptr) {
-    fail(QStringLiteral("Failed to connect to PipeWire core."));
-    return;
+    *error = QStringLiteral("Failed to connect to PipeWire core.");
+    return false;
   }
 
-  pw_properties *properties = pw_properties_new(PW_KEY_MEDIA_TYPE,
-                                                "Audio",
-                                                PW_KEY_MEDIA_CATEGORY,
-                                                "Capture",
-                                                PW_KEY_MEDIA_ROLE,
-                                                "Music",
-                                                PW_KEY_APP_NAME,
-                                                "qt6mplayer",
-                                                nullptr);
-  if (properties == nullptr) {
-    fail(QStringLiteral("Failed to allocate PipeWire stream properties."));
-    return;
-  }
+  pw_core_events coreEvents = {};
+  coreEvents.version = PW_VERSION_CORE_EVENTS;
+  coreEvents.error = &PipeWireAudioSource::onCoreError;
+  coreEvents.done = &PipeWireAudioSource::onCoreDone;
+  pw_core_add_listener(m_core, &m_coreListener, &coreEvents, this);
+  m_coreListenerAttached = true;
 
-  QString selectedDevice;
-  {
-    std::lock_guard<std::mutex> lock(m_deviceMutex);
-    selectedDevice = m_selectedDeviceId.trimmed();
+  pw_registry_events registryEvents = {};
+  registryEvents.version = PW_VERSION_REGISTRY_EVENTS;
+  registryEvents.global = &PipeWireAudioSource::onRegistryGlobal;
+  registryEvents.global_remove = &PipeWireAudioSource::onRegistryGlobalRemove;
+
+  m_registry = static_cast<pw_registry *>(pw_core_get_registry(m_core, PW_VERSION_REGISTRY, 0));
+  if (m_registry == nullptr) {
+    *error = QStringLiteral("Failed to get PipeWire registry.");
+    return false;
   }
-  const QString envTarget = QString::fromUtf8(qgetenv("QT6MPLAYER_PIPEWIRE_TARGET")).trimmed();
-  const QString configuredTarget = envTarget.isEmpty() ? selectedDevice : envTarget;
-  const QByteArray targetObject = configuredTarget.toUtf8();
-#ifdef PW_KEY_TARGET_OBJECT
-  if (!targetObject.isEmpty()) {
-    pw_properties_set(properties, PW_KEY_TARGET_OBJECT, targetObject.constData());
+  pw_registry_add_listener(m_registry, &m_registryListener, &registryEvents, this);
+  m_registryListenerAttached = true;
+  m_registrySyncSeq = pw_core_sync(m_core, PW_ID_CORE, 0);
+
+  const int result = rebuildInputs();
+  if (result < 0) {
+    *error = QStringLiteral("Failed to connect PipeWire stream: %1").arg(QString::fromUtf8(spa_strerror(result)));
+    return false;
   }
-#else
-  Q_UNUSED(targetObject);
+  return true;
+}
 #endif
+
+#ifdef HAVE_PIPEWIRE
+int PipeWireAudioSource::rebuildInputs() {
+  destroyInputs();
+
+  const QVector<AudioInputConfig> configs = configuredInputs();
+  const bool mixing = needsMixStage(configs);
+  {
+    std::lock_guard<std::mutex> lock(m_inputsMutex);
+    m_mixing.store(mixing);
+    for (int i = 0; i < configs.size(); ++i) {
+      m_inputs.push_back(std::make_unique<CaptureInput>(this, i, configs.at(i)));
+    }
+  }
+
+  static const pw_stream_events streamEvents = [] {
+    pw_stream_events events = {};
+    events.version = PW_VERSION_STREAM_EVENTS;
+    events.state_changed = &PipeWireAudioSource::onStateChanged;
+    events.param_changed = &PipeWireAudioSource::onParamChanged;
+    events.process = &PipeWireAudioSource::onProcess;
+    return events;
+  }();
+
+  for (const auto &input : m_inputs) {
+    pw_properties *properties = pw_properties_new(PW_KEY_MEDIA_TYPE,
+                                                  "Audio",
+                                                  PW_KEY_MEDIA_CATEGORY,
+                                                  "Capture",
+                                                  PW_KEY_MEDIA_ROLE,
+                                                  "Music",
+                                                  PW_KEY_APP_NAME,
+                                                  "qt6mplayer",
+                                                  nullptr);
+    if (properties == nullptr) {
+      return -ENOMEM;
+    }
 #ifdef PW_KEY_STREAM_CAPTURE_SINK
-  pw_properties_set(properties, PW_KEY_STREAM_CAPTURE_SINK, "true");
+    pw_properties_set(properties, PW_KEY_STREAM_CAPTURE_SINK, "true");
+#endif
+#ifdef PW_KEY_STREAM_DONT_REMIX
+    pw_properties_set(properties, PW_KEY_STREAM_DONT_REMIX, "true");
 #endif
 
-  m_stream = pw_stream_new(m_core, "qt6mplayer-input", properties);
-  if (m_stream == nullptr) {
-    fail(QStringLiteral("Failed to create PipeWire stream."));
-    return;
+    const QByteArray streamName = input->index == 0 ? QByteArray("qt6mplayer-input")
+                                                    : "qt6mplayer-input-" + QByteArray::number(input->index + 1);
+    input->stream = pw_stream_new(m_core, streamName.constData(), properties);
+    if (input->stream == nullptr) {
+      return -ENOMEM;
+    }
+    pw_stream_add_listener(input->stream, &input->listener, &streamEvents, input.get());
+    input->listenerAttached = true;
+
+    const int result = connectStream(*input);
+    if (result < 0) {
+      return result;
+    }
   }
+  return 0;
+}
 
-  pw_stream_events events = {};
-  events.version = PW_VERSION_STREAM_EVENTS;
-  events.state_changed = &PipeWireAudioSource::onStateChanged;
-  events.process = &PipeWireAudioSource::onProcess;
+// pw_stream_destroy() waits for the data thread to leave the stream, so the
+// inputs can be released once the streams are gone.
+void PipeWireAudioSource::destroyInputs() {
+  for (const auto &input : m_inputs) {
+    if (input->listenerAttached) {
+      spa_hook_remove(&input->listener);
+      input->listenerAttached = false;
+    }
+    if (input->stream != nullptr) {
+      pw_stream_destroy(input->stream);
+      input->stream = nullptr;
+    }
+  }
 
-  pw_stream_add_listener(m_stream, &m_streamListener, &events, this);
-  m_streamListenerAttached = true;
+  std::lock_guard<std::mutex> lock(m_inputsMutex);
+  m_inputs.clear();
+  m_mixing.store(false);
+}
 
-  pw_core_events coreEvents = {};
-  coreEvents.version = PW_VERSION_CORE_EVENTS;
-  coreEvents.error = &PipeWireAudioSource::onCoreError;
-  pw_core_add_listener(m_core, &m_coreListener, &coreEvents, this);
-  m_coreListenerAttached = true;
+int PipeWireAudioSource::connectStream(CaptureInput &input) {
+  const QByteArray targetObject = input.deviceId.toUtf8();
+  const int latencyFrames = m_requestedLatencyFrames.load();
+  const QByteArray latency =
+      latencyFrames > 0 ? QByteArray::number(latencyFrames) + '/' + QByteArray::number(m_sampleRate.load())
+                        : QByteArray();
 
-  uint8_t paramsBuffer[256];
+  // Empty values remove the key, handing the choice back to the graph.
+  spa_dict_item items[2];
+  uint32_t itemCount = 0;
+#ifdef PW_KEY_TARGET_OBJECT
+  items[itemCount++] =
+      SPA_DICT_ITEM_INIT(PW_KEY_TARGET_OBJECT, targetObject.isEmpty() ? nullptr : targetObject.constData());
+#else
+  Q_UNUSED(targetObject);
+#endif
+  items[itemCount++] = SPA_DICT_ITEM_INIT(PW_KEY_NODE_LATENCY, latency.isEmpty() ? nullptr : latency.constData());
+  const spa_dict streamDict = SPA_DICT_INIT(items, itemCount);
+  pw_stream_update_properties(input.stream, &streamDict);
+
+  // Leave format, rate and layout open so the node's native format is taken
+  // as-is; conversion and downmixing happen in processBuffer() instead of an
+  // adapter stage in the graph. The fixed F32 stereo entry is a last resort.
+  uint8_t paramsBuffer[1024];
   spa_pod_builder builder = SPA_POD_BUILDER_INIT(paramsBuffer, sizeof(paramsBuffer));
 
-  spa_audio_info_raw info = {};
-  info.format = SPA_AUDIO_FORMAT_F32;
-  info.rate = m_sampleRate;
-  info.channels = static_cast<uint32_t>(m_channels);
-  info.position[0] = SPA_AUDIO_CHANNEL_FL;
-  info.position[1] = SPA_AUDIO_CHANNEL_FR;
-
-  const spa_pod *params[1];
-  params[0] = spa_format_audio_raw_build(&builder, SPA_PARAM_EnumFormat, &info);
-
-  const int result = pw_stream_connect(
-      m_stream,
+  const spa_pod *params[2];
+  spa_pod_frame frame = {};
+  spa_pod_builder_push_object(&builder, &frame, SPA_TYPE_OBJECT_Format, SPA_PARAM_EnumFormat);
+  spa_pod_builder_add(&builder,
+                      SPA_FORMAT_mediaType,
+                      SPA_POD_Id(SPA_MEDIA_TYPE_audio),
+                      SPA_FORMAT_mediaSubtype,
+                      SPA_POD_Id(SPA_MEDIA_SUBTYPE_raw),
+                      SPA_FORMAT_AUDIO_format,
+                      SPA_POD_CHOICE_ENUM_Id(4,
+                                             SPA_AUDIO_FORMAT_F32,
+                                             SPA_AUDIO_FORMAT_F32,
+                                             SPA_AUDIO_FORMAT_S32,
+                                             SPA_AUDIO_FORMAT_S16),
+                      SPA_FORMAT_AUDIO_rate,
+                      SPA_POD_CHOICE_RANGE_Int(48000, 8000, 384000),
+                      SPA_FORMAT_AUDIO_channels,
+                      SPA_POD_CHOICE_RANGE_Int(2, 1, kMaxCaptureChannels),
+                      0);
+  params[0] = static_cast<const spa_pod *>(spa_pod_builder_pop(&builder, &frame));
+
+  spa_audio_info_raw fallback = {};
+  fallback.format = SPA_AUDIO_FORMAT_F32;
+  fallback.rate = 48000;
+  fallback.channels = 2;
+  fallback.position[0] = SPA_AUDIO_CHANNEL_FL;
+  fallback.position[1] = SPA_AUDIO_CHANNEL_FR;
+  params[1] = spa_format_audio_raw_build(&builder, SPA_PARAM_EnumFormat, &fallback);
+
+  return pw_stream_connect(
+      input.stream,
       PW_DIRECTION_INPUT,
       PW_ID_ANY,
       static_cast<pw_stream_flags>(PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_MAP_BUFFERS |
                                    PW_STREAM_FLAG_RT_PROCESS),
       params,
-      1);
+      2);
+}
+
+int PipeWireAudioSource::onReconnectInvoke(spa_loop *loop, bool async, uint32_t seq, const void *data, size_t size, void *userdata) {
+  Q_UNUSED(loop);
+  Q_UNUSED(async);
+  Q_UNUSED(seq);
+  Q_UNUSED(data);
+  Q_UNUSED(size);
 
+  // While the session is down the next connection picks up the new targets.
+  auto *self = static_cast<PipeWireAudioSource *>(userdata);
+  if (self == nullptr || self->m_core == nullptr || self->m_sessionLost) {
+    return 0;
+  }
+
+  const int result = self->rebuildInputs();
   if (result < 0) {
-    fail(QStringLiteral("Failed to connect PipeWire stream: %1").arg(QString::fromUtf8(spa_strerror(result))));
+    const QString detail = QString::fromUtf8(spa_strerror(result));
+    QMetaObject::invokeMethod(
+        self,
+        [self, detail]() {
+          Q_EMIT self->errorMessage(QStringLiteral("Failed to reconnect PipeWire stream: %1").arg(detail));
+        },
+        Qt::QueuedConnection);
+    self->scheduleSessionRetry();
+  }
+  return 0;
+}
+
+void PipeWireAudioSource::onSessionRetry(void *userdata, uint64_t expirations) {
+  Q_UNUSED(expirations);
+  auto *self = static_cast<PipeWireAudioSource *>(userdata);
+  if (self == nullptr || !self->m_sessionLost || !self->m_running) {
     return;
   }
 
-  pw_main_loop_run(m_mainLoop);
-  const bool stoppedByRequest = !m_running.exchange(false);
-  if (!stoppedByRequest) {
-    shutdown();
+  self->closeSession();
+  QString error;
+  if (!self->connectSession(&error)) {
+    self->scheduleSessionRetry();
+    return;
   }
-#else
-  QMetaObject::invokeMethod(this,
-                            [this]() { Q_EMIT errorMessage(QStringLiteral("PipeWire support unavailable.")); },
-                            Qt::QueuedConnection);
-#endif
+  self->m_sessionLost = false;
+  self->m_awaitingTargets = true;
 }
 
-void PipeWireAudioSource::shutdown() {
+// Called on the loop thread, usually from inside a core or stream callback,
+// so the dead session is only torn down when the timer fires.
+void PipeWireAudioSource::scheduleSessionRetry() {
+  if (m_retryTimer == nullptr) {
+    return;
+  }
+  if (m_disconnectedAtNs == 0) {
+    m_disconnectedAtNs = monotonicTimeNs();
+    setFillGaps(true);
+    QMetaObject::invokeMethod(
+        this,
+        [this]() { Q_EMIT statusMessage(QStringLiteral("PipeWire connection lost; reconnecting.")); },
+        Qt::QueuedConnection);
+  }
+  m_sessionLost = true;
+
+  const int64_t delayNs = std::min(kRetryMaxDelayNs, kRetryInitialDelayNs << std::min(m_retryAttempts, 8));
+  ++m_retryAttempts;
+  timespec value = {static_cast<time_t>(delayNs / 1000000000), static_cast<long>(delayNs % 1000000000)};
+  timespec interval = {};
+  pw_loop_update_timer(pw_main_loop_get_loop(m_mainLoop), m_retryTimer, &value, &interval, false);
+}
+
+bool PipeWireAudioSource::targetsListed() const {
+  for (const auto &input : m_inputs) {
+    if (input->deviceId.isEmpty()) {
+      continue;
+    }
+    bool listed = false;
+    for (auto it = m_registryNodes.cbegin(); it != m_registryNodes.cend() && !listed; ++it) {
+      listed = it.value().id == input->deviceId;
+    }
+    if (!listed) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
 #ifdef HAVE_PIPEWIRE
-  if (m_streamListenerAttached) {
-    spa_hook_remove(&m_streamListener);
-    m_streamListenerAttached = false;
+// Everything that belongs to one daemon connection; the main loop and the
+// retry timer outlive it.
+void PipeWireAudioSource::closeSession() {
+  if (m_metadataListenerAttached) {
+    spa_hook_remove(&m_metadataListener);
+    m_metadataListenerAttached = false;
+  }
+
+  if (m_defaultMetadata != nullptr) {
+    pw_proxy_destroy(reinterpret_cast<pw_proxy *>(m_defaultMetadata));
+    m_defaultMetadata = nullptr;
   }
 
+  if (m_registryListenerAttached) {
+    spa_hook_remove(&m_registryListener);
+    m_registryListenerAttached = false;
+  }
+
+  if (m_registry != nullptr) {
+    pw_proxy_destroy(reinterpret_cast<pw_proxy *>(m_registry));
+    m_registry = nullptr;
+  }
+  m_registryNodes.clear();
+  m_registrySynced = false;
+  m_registrySyncSeq = -1;
+
+  destroyInputs();
+
   if (m_coreListenerAttached) {
     spa_hook_remove(&m_coreListener);
     m_coreListenerAttached = false;
   }
 
-  if (m_stream != nullptr) {
-    pw_stream_destroy(m_stream);
-    m_stream = nullptr;
-  }
-
   if (m_core != nullptr) {
     pw_core_disconnect(m_core);
     m_core = nullptr;
@@ -597,10 +1534,26 @@ void PipeWireAudioSource::shutdown() {
     pw_context_destroy(m_context);
     m_context = nullptr;
   }
+  unregisterThread(m_dataThreadId.exchange(0));
+}
+#endif
 
-  if (m_mainLoop != nullptr) {
-    pw_main_loop_destroy(m_mainLoop);
-    m_mainLoop = nullptr;
+void PipeWireAudioSource::shutdown() {
+#ifdef HAVE_PIPEWIRE
+  closeSession();
+
+  if (m_retryTimer != nullptr) {
+    pw_loop_destroy_source(pw_main_loop_get_loop(m_mainLoop), m_retryTimer);
+    m_retryTimer = nullptr;
+  }
+
+  pw_main_loop *mainLoop = nullptr;
+  {
+    const std::lock_guard<std::mutex> lock(m_loopMutex);
+    std::swap(mainLoop, m_mainLoop);
+  }
+  if (mainLoop != nullptr) {
+    pw_main_loop_destroy(mainLoop);
   }
 
   pw_deinit();
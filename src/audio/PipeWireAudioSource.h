@@ -1,23 +1,41 @@
 #pragma once
 
-#include "AudioSource.h"
+#include "BufferedAudioSource.h"
+#include "LevelMeter.h"
+#include "PcmRingBuffer.h"
+#include "SampleKernels.h"
+
+#include <QHash>
 
 #ifdef HAVE_PIPEWIRE
 #include <pipewire/core.h>
 #include <pipewire/stream.h>
+#include <spa/utils/dict.h>
 #include <spa/utils/hook.h>
 #endif
 
 #include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 struct pw_main_loop;
 struct pw_context;
 struct pw_core;
 struct pw_stream;
+struct pw_registry;
+struct pw_metadata;
+struct spa_pod;
+struct spa_loop;
+struct spa_source;
 
-class PipeWireAudioSource : public AudioSource {
+// Captures one or more PipeWire nodes. Once the first connection is up, a
+// lost daemon or a failed stream is reconnected with backoff to the same
+// targets for as long as the source runs; the drain timer feeds silence
+// meanwhile.
+class PipeWireAudioSource : public BufferedAudioSource {
   Q_OBJECT
 
 public:
@@ -31,39 +49,152 @@ public:
   QVector<AudioDeviceInfo> availableDevices() const override;
   QString selectedDeviceId() const override;
   void setSelectedDeviceId(const QString &deviceId) override;
+  QString defaultDeviceId() const override;
+  bool retargetDevice(const QString &deviceId) override;
+  void setRequestedLatencyFrames(int frames) override;
+  AudioLatencyInfo latencyInfo() const override;
+  void setMixInputs(const QVector<AudioInputConfig> &inputs) override;
+  QVector<AudioInputStats> inputStats() const override;
+  AudioCaptureStats captureStats() const override;
+  // Feeds synthetic buffers through the capture and mix path inside an
+  // RtSection; false when the RT checks saw heap or mutex use.
+  bool runRtSelfCheck(QString *report);
 
 private:
+  // One pw_stream. Format and stats are written on the data thread; the
+  // struct itself is created and destroyed on the loop thread.
+  struct CaptureInput {
+    CaptureInput(PipeWireAudioSource *source, int inputIndex, const AudioInputConfig &config);
+
+    PipeWireAudioSource *owner = nullptr;
+    int index = 0;
+    QString deviceId;
+    pw_stream *stream = nullptr;
+#ifdef HAVE_PIPEWIRE
+    spa_hook listener = {};
+    bool listenerAttached = false;
+#endif
+    std::atomic<float> gain{1.0f};
+    std::atomic<int> channels{2};
+    std::atomic<PcmSampleFormat> sampleFormat{PcmSampleFormat::F32};
+    std::atomic<int> sampleRate{48000};
+    std::atomic<bool> streaming{false};
+    // Mixed inputs stage frames here; a lone input writes m_ring directly.
+    PcmRingBuffer ring;
+    std::atomic<int64_t> lastCaptureNs{0};
+    int64_t expectedCaptureNs = 0;
+    int lastFrameCount = 0;
+    std::atomic<uint64_t> xruns{0};
+    std::atomic<uint64_t> alignedFrames{0};
+    std::atomic<int64_t> offsetNs{0};
+    LevelMeter levelMeter;
+    std::vector<float> captureScratch;
+    std::vector<float> convertScratch;
+  };
+
+#ifdef HAVE_PIPEWIRE
+  // The stream calls processBuffer makes; the RT self-check points them at
+  // a synthetic stream so the real process callback runs without a daemon.
+  struct StreamCalls {
+    pw_buffer *(*dequeueBuffer)(pw_stream *stream);
+    int (*queueBuffer)(pw_stream *stream, pw_buffer *buffer);
+    int (*getTime)(pw_stream *stream, pw_time *time, size_t size);
+  };
+#endif
+
   static void onProcess(void *userdata);
 #ifdef HAVE_PIPEWIRE
   static void onStateChanged(void *userdata,
                              enum pw_stream_state oldState,
                              enum pw_stream_state state,
                              const char *error);
+  static void onParamChanged(void *userdata, uint32_t id, const spa_pod *param);
   static void onCoreError(void *userdata, uint32_t id, int seq, int res, const char *message);
+  static void onCoreDone(void *userdata, uint32_t id, int seq);
+  static void onRegistryGlobal(void *userdata,
+                               uint32_t id,
+                               uint32_t permissions,
+                               const char *type,
+                               uint32_t version,
+                               const spa_dict *props);
+  static void onRegistryGlobalRemove(void *userdata, uint32_t id);
+  static int onMetadataProperty(void *userdata, uint32_t subject, const char *key, const char *type, const char *value);
+  static int onReconnectInvoke(spa_loop *loop, bool async, uint32_t seq, const void *data, size_t size, void *userdata);
+  static void onSessionRetry(void *userdata, uint64_t expirations);
+  bool connectSession(QString *error);
+  void closeSession();
+  void scheduleSessionRetry();
+  bool targetsListed() const;
+  void publishDeviceSnapshot();
+  int rebuildInputs();
+  void destroyInputs();
+  int connectStream(CaptureInput &input);
 #endif
-  void processBuffer();
+  QVector<AudioInputConfig> configuredInputs() const;
+  bool requestStreamReconnect();
+  void processBuffer(CaptureInput &input);
+  void consumeChunk(CaptureInput &input, const uint8_t *bytes, uint32_t byteCount, int chunkStride, int64_t captureTimeNs);
+  void captureInterleaved(CaptureInput &input, const uint8_t *samples, int frameCount, int stride, PcmRingBuffer &target);
+  void mixInputs();
   void runMainLoop();
   void shutdown();
-#ifdef HAVE_PIPEWIRE
-  static QVector<AudioDeviceInfo> probeDevices(QString *errorMessage);
-#endif
 
   std::atomic<bool> m_running{false};
   std::thread m_loopThread;
   mutable std::mutex m_deviceMutex;
   QString m_selectedDeviceId;
+  QVector<AudioDeviceInfo> m_deviceSnapshot;
+  QString m_defaultDeviceId;
+  QVector<AudioInputConfig> m_mixInputs;
 
+  // Set and cleared under m_loopMutex; threads other than the loop thread
+  // read it only under the lock, so never after pw_main_loop_destroy.
+  mutable std::mutex m_loopMutex;
   pw_main_loop *m_mainLoop = nullptr;
   pw_context *m_context = nullptr;
   pw_core *m_core = nullptr;
-  pw_stream *m_stream = nullptr;
+  pw_registry *m_registry = nullptr;
+  pw_metadata *m_defaultMetadata = nullptr;
+  uint32_t m_defaultMetadataId = 0;
 
 #ifdef HAVE_PIPEWIRE
-  spa_hook m_streamListener = {};
   spa_hook m_coreListener = {};
-  bool m_streamListenerAttached = false;
   bool m_coreListenerAttached = false;
+  spa_hook m_registryListener = {};
+  spa_hook m_metadataListener = {};
+  bool m_registryListenerAttached = false;
+  bool m_metadataListenerAttached = false;
+  int m_registrySyncSeq = -1;
+  bool m_registrySynced = false;
+  // Loop thread only; m_deviceSnapshot is the copy readers see.
+  QHash<uint32_t, AudioDeviceInfo> m_registryNodes;
+  // Loop thread only. m_disconnectedAtNs is non-zero from a loss until a
+  // stream is back; m_sessionLost while the retry timer is armed.
+  spa_source *m_retryTimer = nullptr;
+  bool m_sessionLost = false;
+  bool m_awaitingTargets = false;
+  int m_retryAttempts = 0;
+  int64_t m_disconnectedAtNs = 0;
+  StreamCalls m_streamCalls = {&pw_stream_dequeue_buffer, &pw_stream_queue_buffer, &pw_stream_get_time_n};
 #endif
-  int m_sampleRate = 48000;
-  int m_channels = 2;
+  // Loop thread swaps the inputs under this lock; the mixer only try-locks it.
+  mutable std::mutex m_inputsMutex;
+  std::vector<std::unique_ptr<CaptureInput>> m_inputs;
+  std::atomic<bool> m_mixing{false};
+  std::atomic<int> m_requestedLatencyFrames{0};
+  std::atomic<int> m_quantumFrames{0};
+  std::atomic<int64_t> m_graphDelayNs{0};
+  std::atomic<uint64_t> m_callbackCount{0};
+  std::atomic<uint64_t> m_emptyBufferCount{0};
+  std::atomic<uint64_t> m_shortChunkCount{0};
+  std::atomic<uint64_t> m_strideMismatchCount{0};
+  std::atomic<uint64_t> m_xrunCount{0};
+  std::atomic<uint64_t> m_reconnectCount{0};
+  std::atomic<int64_t> m_lastReconnectNs{0};
+  // PipeWire owns the data-loop thread; it is registered for placement on its first callback.
+  std::atomic<int> m_dataThreadId{0};
+
+  const SampleKernels *m_kernels = nullptr;
+  std::vector<float> m_mixScratch;
+  std::vector<float> m_mixReadScratch;
 };
@@ -0,0 +1,82 @@
+#include "RealFft.h"
+
+#include "SampleKernels.h"
+
+#include <cmath>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+} // namespace
+
+RealFft::RealFft(int size) : m_size(size), m_kernels(&sampleKernels()) {
+  const int half = m_size / 2;
+  int bits = 0;
+  while ((1 << bits) < half) {
+    ++bits;
+  }
+  m_bitReverse.resize(half);
+  for (int i = 0; i < half; ++i) {
+    int reversed = 0;
+    for (int bit = 0; bit < bits; ++bit) {
+      reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+    }
+    m_bitReverse[i] = reversed;
+  }
+
+  m_twiddleRe.assign(half, 0.0f);
+  m_twiddleIm.assign(half, 0.0f);
+  for (int h = 1; h < half; h *= 2) {
+    for (int j = 0; j < h; ++j) {
+      const double angle = -kPi * j / h;
+      m_twiddleRe[h + j] = static_cast<float>(std::cos(angle));
+      m_twiddleIm[h + j] = static_cast<float>(std::sin(angle));
+    }
+  }
+
+  m_unpackCos.resize(half + 1);
+  m_unpackSin.resize(half + 1);
+  for (int k = 0; k <= half; ++k) {
+    const double angle = 2.0 * kPi * k / m_size;
+    m_unpackCos[k] = static_cast<float>(std::cos(angle));
+    m_unpackSin[k] = static_cast<float>(std::sin(angle));
+  }
+  m_re.resize(half);
+  m_im.resize(half);
+}
+
+int RealFft::size() const { return m_size; }
+
+int RealFft::bins() const { return m_size / 2 + 1; }
+
+void RealFft::forward(const float *in, float *re, float *im) {
+  const int half = m_size / 2;
+  // Even samples as the real part and odd ones as the imaginary part.
+  for (int i = 0; i < half; ++i) {
+    const int source = m_bitReverse[i];
+    m_re[i] = in[2 * source];
+    m_im[i] = in[2 * source + 1];
+  }
+  for (int h = 1; h < half; h *= 2) {
+    for (int group = 0; group < half; group += 2 * h) {
+      m_kernels->fftButterflies(m_re.data() + group, m_im.data() + group, m_twiddleRe.data() + h,
+                                m_twiddleIm.data() + h, h);
+    }
+  }
+
+  // X[k] = E[k] + e^(-2 pi i k / size) O[k], with E and O the spectra of the
+  // even and odd samples recovered from Z[k] and conj(Z[half - k]).
+  for (int k = 0; k <= half; ++k) {
+    const float ar = m_re[k % half];
+    const float ai = m_im[k % half];
+    const float br = m_re[(half - k) % half];
+    const float bi = -m_im[(half - k) % half];
+    const float evenRe = 0.5f * (ar + br);
+    const float evenIm = 0.5f * (ai + bi);
+    const float oddRe = 0.5f * (ai - bi);
+    const float oddIm = -0.5f * (ar - br);
+    const float c = m_unpackCos[k];
+    const float s = m_unpackSin[k];
+    re[k] = evenRe + c * oddRe + s * oddIm;
+    im[k] = evenIm + c * oddIm - s * oddRe;
+  }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+struct SampleKernels;
+
+// Forward FFT of a real block whose size is a power of two (at least 4).
+// The block is packed into a half-size complex FFT, computed in split
+// re/im arrays with the SampleKernels butterfly pass, then untangled, so
+// the output holds bins 0..size/2 inclusive. Not thread-safe: each
+// instance owns its scratch.
+class RealFft {
+public:
+  explicit RealFft(int size = 1024);
+
+  int size() const;
+  int bins() const;
+
+  // re and im need bins() entries each.
+  void forward(const float *in, float *re, float *im);
+
+private:
+  int m_size = 0;
+  const SampleKernels *m_kernels = nullptr;
+  std::vector<int> m_bitReverse;
+  // Twiddles for the pass with half h start at index h.
+  std::vector<float> m_twiddleRe;
+  std::vector<float> m_twiddleIm;
+  std::vector<float> m_unpackCos;
+  std::vector<float> m_unpackSin;
+  std::vector<float> m_re;
+  std::vector<float> m_im;
+};
@@ -0,0 +1,208 @@
+#include "ReplayAudioSource.h"
+
+#include "SampleKernels.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr int kReplayBlockFrames = 512;
+constexpr int kRealtimeTickMs = 4;
+constexpr int kFastBlocksPerTick = 16;
+
+// Save Capture's default file name; the newest such file is offered first.
+QFileInfoList savedCaptures() {
+  return QDir::home().entryInfoList(QStringList{QStringLiteral("qt6mplayer-capture-*.wav")}, QDir::Files, QDir::Time);
+}
+} // namespace
+
+ReplayAudioSource::ReplayAudioSource(QObject *parent) : AudioSource(parent) {
+  m_timer.setTimerType(Qt::PreciseTimer);
+  connect(&m_timer, &QTimer::timeout, this, &ReplayAudioSource::emitDueBlocks);
+}
+
+bool ReplayAudioSource::start() {
+  if (m_running) {
+    return true;
+  }
+
+  if (m_filePath.isEmpty()) {
+    m_filePath = defaultDeviceId();
+  }
+  QString error;
+  if (!loadFile(&error)) {
+    Q_EMIT errorMessage(QStringLiteral("Replay failed: %1").arg(error));
+    return false;
+  }
+
+  m_positionFrames = 0;
+  m_emittedFrames = 0;
+  m_levelMeter.reset();
+  m_block.resize(kReplayBlockFrames * 2);
+  m_startTimeNs = monotonicTimeNs();
+  m_clock.start();
+  m_running = true;
+  m_timer.setInterval(m_pacing == Pacing::Fast ? 0 : kRealtimeTickMs);
+  m_timer.start();
+  Q_EMIT statusMessage(QStringLiteral("Audio backend: replay of %1 (%2 Hz, %3 frames, %4).")
+                           .arg(QFileInfo(m_filePath).fileName())
+                           .arg(m_sampleRate)
+                           .arg(m_stereo.size() / 2)
+                           .arg(m_pacing == Pacing::Fast ? QStringLiteral("fast") : QStringLiteral("realtime")));
+  return true;
+}
+
+void ReplayAudioSource::stop() {
+  if (!m_running) {
+    return;
+  }
+  m_running = false;
+  m_timer.stop();
+}
+
+bool ReplayAudioSource::isRunning() const { return m_running; }
+
+QString ReplayAudioSource::backendName() const { return QStringLiteral("Replay"); }
+
+AudioLevels ReplayAudioSource::levels() const { return m_levelMeter.snapshot(); }
+
+void ReplayAudioSource::setSilenceFloor(float amplitude) { m_levelMeter.setSilenceFloor(amplitude); }
+
+QVector<AudioDeviceInfo> ReplayAudioSource::availableDevices() const {
+  QVector<AudioDeviceInfo> devices;
+  const auto addDevice = [&devices](const QString &filePath) {
+    for (const AudioDeviceInfo &device : devices) {
+      if (device.id == filePath) {
+        return;
+      }
+    }
+    AudioDeviceInfo device;
+    device.id = filePath;
+    device.name = QFileInfo(filePath).fileName();
+    device.description = QStringLiteral("Recorded capture (%1)").arg(filePath);
+    devices.push_back(device);
+  };
+
+  if (!m_filePath.isEmpty()) {
+    addDevice(m_filePath);
+  }
+  for (const QFileInfo &capture : savedCaptures()) {
+    addDevice(capture.absoluteFilePath());
+  }
+  return devices;
+}
+
+QString ReplayAudioSource::selectedDeviceId() const { return m_filePath; }
+
+QString ReplayAudioSource::defaultDeviceId() const {
+  const QFileInfoList captures = savedCaptures();
+  return captures.isEmpty() ? QString() : captures.constFirst().absoluteFilePath();
+}
+
+void ReplayAudioSource::setSelectedDeviceId(const QString &deviceId) {
+  // Live-device ids from settings do not apply here; only a file switches input.
+  if (QFileInfo(deviceId).isFile()) {
+    setFilePath(deviceId);
+  }
+}
+
+void ReplayAudioSource::setFilePath(const QString &filePath) { m_filePath = filePath.trimmed(); }
+
+QString ReplayAudioSource::filePath() const { return m_filePath; }
+
+void ReplayAudioSource::setPacing(Pacing pacing) { m_pacing = pacing; }
+
+void ReplayAudioSource::setLooping(bool looping) { m_looping = looping; }
+
+void ReplayAudioSource::setRawFormat(int sampleRate, int channels) {
+  m_rawSampleRate = sampleRate;
+  m_rawChannels = channels;
+}
+
+bool ReplayAudioSource::loadFile(QString *error) {
+  if (m_filePath.isEmpty()) {
+    *error = QStringLiteral("no replay file configured");
+    return false;
+  }
+
+  PcmFileData data;
+  const bool isWav = m_filePath.endsWith(QStringLiteral(".wav"), Qt::CaseInsensitive);
+  const bool loaded = isWav ? readWavFile(m_filePath, &data, error)
+                            : readRawFloatFile(m_filePath, m_rawSampleRate, m_rawChannels, &data, error);
+  if (!loaded) {
+    return false;
+  }
+  if (data.frameCount() <= 0) {
+    *error = QStringLiteral("%1 contains no audio").arg(m_filePath);
+    return false;
+  }
+
+  m_sampleRate = data.sampleRate;
+  m_stereo.resize(data.frameCount() * 2);
+  if (data.channels == 2) {
+    std::memcpy(m_stereo.data(), data.samples.constData(), static_cast<size_t>(m_stereo.size()) * sizeof(float));
+  } else {
+    sampleKernels().interleavedToStereo(data.samples.constData(), m_stereo.data(), data.frameCount(), data.channels);
+  }
+  return true;
+}
+
+void ReplayAudioSource::emitDueBlocks() {
+  if (!m_running) {
+    return;
+  }
+
+  if (m_pacing == Pacing::Fast) {
+    for (int i = 0; i < kFastBlocksPerTick && m_running; ++i) {
+      emitBlock(monotonicTimeNs());
+    }
+    return;
+  }
+
+  // Blocks go out once their last frame is due, so block boundaries and
+  // contents are identical from run to run regardless of timer jitter.
+  const auto dueFrames = static_cast<uint64_t>((m_clock.nsecsElapsed() / 1000) * m_sampleRate / 1000000);
+  while (m_running && m_emittedFrames + kReplayBlockFrames <= dueFrames) {
+    const uint64_t blockEnd = m_emittedFrames + kReplayBlockFrames;
+    emitBlock(m_startTimeNs + static_cast<int64_t>(blockEnd * 1000000000ULL / static_cast<uint64_t>(m_sampleRate)));
+  }
+}
+
+bool ReplayAudioSource::emitBlock(int64_t captureTimeNs) {
+  const qsizetype totalFrames = m_stereo.size() / 2;
+  int filled = 0;
+  while (filled < kReplayBlockFrames) {
+    if (m_positionFrames >= totalFrames) {
+      if (!m_looping) {
+        break;
+      }
+      m_positionFrames = 0;
+    }
+    const int count = static_cast<int>(std::min<qsizetype>(kReplayBlockFrames - filled, totalFrames - m_positionFrames));
+    std::memcpy(m_block.data() + filled * 2,
+                m_stereo.constData() + m_positionFrames * 2,
+                static_cast<size_t>(count) * 2 * sizeof(float));
+    filled += count;
+    m_positionFrames += count;
+  }
+
+  if (filled == 0) {
+    stop();
+    Q_EMIT statusMessage(QStringLiteral("Replay finished after %1 frames.").arg(m_emittedFrames));
+    return false;
+  }
+
+  PcmBlockInfo info;
+  info.captureTimeNs = captureTimeNs;
+  info.samplePosition = m_emittedFrames;
+  info.sampleRate = m_sampleRate;
+  m_block.resize(filled * 2);
+  m_levelMeter.process(m_block.constData(), filled, m_sampleRate);
+  m_emittedFrames += static_cast<uint64_t>(filled);
+  Q_EMIT pcmFrameReady(m_block, info);
+  m_block.resize(kReplayBlockFrames * 2);
+  return true;
+}
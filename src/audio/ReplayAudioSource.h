@@ -0,0 +1,60 @@
+#pragma once
+
+#include "AudioSource.h"
+#include "LevelMeter.h"
+#include "PcmFile.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+
+// Plays a recorded capture back in fixed-size blocks, either paced to the
+// wall clock or as fast as the event loop allows, so render and beat paths
+// can be exercised with identical input on any machine.
+class ReplayAudioSource : public AudioSource {
+  Q_OBJECT
+
+public:
+  enum class Pacing { Realtime, Fast };
+
+  explicit ReplayAudioSource(QObject *parent = nullptr);
+
+  bool start() override;
+  void stop() override;
+  bool isRunning() const override;
+  QString backendName() const override;
+  QVector<AudioDeviceInfo> availableDevices() const override;
+  QString selectedDeviceId() const override;
+  void setSelectedDeviceId(const QString &deviceId) override;
+  // The newest capture saved under the default name in the home directory.
+  QString defaultDeviceId() const override;
+  AudioLevels levels() const override;
+  void setSilenceFloor(float amplitude) override;
+
+  void setFilePath(const QString &filePath);
+  QString filePath() const;
+  void setPacing(Pacing pacing);
+  void setLooping(bool looping);
+  void setRawFormat(int sampleRate, int channels);
+
+private:
+  bool loadFile(QString *error);
+  void emitDueBlocks();
+  bool emitBlock(int64_t captureTimeNs);
+
+  QString m_filePath;
+  Pacing m_pacing = Pacing::Realtime;
+  bool m_looping = false;
+  int m_rawSampleRate = 48000;
+  int m_rawChannels = 2;
+
+  QVector<float> m_stereo;
+  int m_sampleRate = 0;
+  qsizetype m_positionFrames = 0;
+  uint64_t m_emittedFrames = 0;
+  QVector<float> m_block;
+  QElapsedTimer m_clock;
+  int64_t m_startTimeNs = 0;
+  QTimer m_timer;
+  bool m_running = false;
+  LevelMeter m_levelMeter;
+};
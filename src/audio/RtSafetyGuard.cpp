@@ -0,0 +1,183 @@
+#include "RtSafetyGuard.h"
+
+#ifdef QT6MPLAYER_RT_CHECKS
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Plain int in static TLS: reading it from the hooks below never allocates.
+thread_local int t_sectionDepth = 0;
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_frees{0};
+std::atomic<uint64_t> g_mutexLocks{0};
+std::atomic<uint64_t> g_mutexTryLocks{0};
+
+[[maybe_unused]] void recordViolation(std::atomic<uint64_t> &counter, const char *what) {
+  counter.fetch_add(1, std::memory_order_relaxed);
+  const char *mode = std::getenv("QT6MPLAYER_RT_CHECKS");
+  if (mode == nullptr || std::strcmp(mode, "abort") != 0) {
+    return;
+  }
+#if defined(__GLIBC__)
+  // Assembled on the stack; formatting helpers may allocate.
+  static const char prefix[] = "qt6mplayer: ";
+  static const char suffix[] = " on the audio process thread\n";
+  char message[128];
+  const size_t whatLength = std::min(std::strlen(what), sizeof(message) - sizeof(prefix) - sizeof(suffix));
+  size_t length = 0;
+  std::memcpy(message + length, prefix, sizeof(prefix) - 1);
+  length += sizeof(prefix) - 1;
+  std::memcpy(message + length, what, whatLength);
+  length += whatLength;
+  std::memcpy(message + length, suffix, sizeof(suffix) - 1);
+  length += sizeof(suffix) - 1;
+  [[maybe_unused]] const ssize_t written = ::write(STDERR_FILENO, message, length);
+#else
+  static_cast<void>(what);
+#endif
+  std::abort();
+}
+} // namespace
+
+#if defined(__GLIBC__)
+// Resolved on first use rather than by a static initializer: these symbols
+// override the ones every shared library calls, and their constructors can
+// lock a mutex before this file's initializers have run. dlsym takes the
+// loader's own lock, not these hooks, and may allocate through the hooks below.
+template <typename Function>
+static Function realFunction(std::atomic<Function> &slot, const char *name) {
+  Function function = slot.load(std::memory_order_acquire);
+  if (function == nullptr) {
+    function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+    slot.store(function, std::memory_order_release);
+  }
+  return function;
+}
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void __libc_free(void *pointer);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size) {
+  if (t_sectionDepth > 0) {
+    recordViolation(g_allocations, "malloc");
+  }
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  if (t_sectionDepth > 0) {
+    recordViolation(g_allocations, "calloc");
+  }
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+  if (t_sectionDepth > 0) {
+    recordViolation(g_allocations, "realloc");
+  }
+  return __libc_realloc(pointer, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+  if (t_sectionDepth > 0) {
+    recordViolation(g_allocations, "memalign");
+  }
+  return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  if (t_sectionDepth > 0) {
+    recordViolation(g_allocations, "aligned_alloc");
+  }
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) {
+  if (t_sectionDepth > 0) {
+    recordViolation(g_allocations, "posix_memalign");
+  }
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment % sizeof(void *) != 0) {
+    return EINVAL;
+  }
+  void *memory = __libc_memalign(alignment, size);
+  if (memory == nullptr) {
+    return ENOMEM;
+  }
+  *pointer = memory;
+  return 0;
+}
+
+void free(void *pointer) {
+  if (t_sectionDepth > 0 && pointer != nullptr) {
+    recordViolation(g_frees, "free");
+  }
+  __libc_free(pointer);
+}
+
+using MutexLockFunction = int (*)(pthread_mutex_t *);
+using MutexTimedLockFunction = int (*)(pthread_mutex_t *, const struct timespec *);
+// Constant-initialised, so they are valid before any static constructor runs.
+static std::atomic<MutexLockFunction> g_realMutexLock{nullptr};
+static std::atomic<MutexLockFunction> g_realMutexTryLock{nullptr};
+static std::atomic<MutexTimedLockFunction> g_realMutexTimedLock{nullptr};
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) {
+  if (t_sectionDepth > 0) {
+    recordViolation(g_mutexLocks, "pthread_mutex_lock");
+  }
+  return realFunction(g_realMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_mutex_timedlock(pthread_mutex_t *mutex, const struct timespec *deadline) {
+  if (t_sectionDepth > 0) {
+    recordViolation(g_mutexLocks, "pthread_mutex_timedlock");
+  }
+  return realFunction(g_realMutexTimedLock, "pthread_mutex_timedlock")(mutex, deadline);
+}
+
+// A try-lock never waits, so it is counted but is not a violation.
+int pthread_mutex_trylock(pthread_mutex_t *mutex) {
+  if (t_sectionDepth > 0) {
+    g_mutexTryLocks.fetch_add(1, std::memory_order_relaxed);
+  }
+  return realFunction(g_realMutexTryLock, "pthread_mutex_trylock")(mutex);
+}
+}
+#endif
+
+RtSection::RtSection() { ++t_sectionDepth; }
+
+RtSection::~RtSection() { --t_sectionDepth; }
+
+bool rtSafetyChecksEnabled() { return true; }
+
+RtSafetyCounts rtSafetyCounts() {
+  RtSafetyCounts counts;
+  counts.allocations = g_allocations.load(std::memory_order_relaxed);
+  counts.frees = g_frees.load(std::memory_order_relaxed);
+  counts.mutexLocks = g_mutexLocks.load(std::memory_order_relaxed);
+  counts.mutexTryLocks = g_mutexTryLocks.load(std::memory_order_relaxed);
+  return counts;
+}
+#else
+RtSection::RtSection() = default;
+
+RtSection::~RtSection() = default;
+
+bool rtSafetyChecksEnabled() { return false; }
+
+RtSafetyCounts rtSafetyCounts() { return {}; }
+#endif
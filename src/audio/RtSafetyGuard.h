@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+struct RtSafetyCounts {
+  uint64_t allocations = 0;
+  uint64_t frees = 0;
+  uint64_t mutexLocks = 0;
+  // Informational: a try-lock never waits, so it is not a violation.
+  uint64_t mutexTryLocks = 0;
+};
+
+// Marks the current thread as running realtime audio code for its lifetime.
+// Builds with QT6MPLAYER_RT_CHECKS interpose malloc, calloc, realloc,
+// memalign, aligned_alloc, posix_memalign, free, pthread_mutex_lock and
+// pthread_mutex_timedlock and count every call made inside a section; with
+// QT6MPLAYER_RT_CHECKS=abort in the environment the first one aborts instead.
+// pthread_mutex_trylock is counted separately and never aborts. Not covered:
+// valloc/pvalloc, rwlocks, condition variables, semaphores and raw futex
+// calls. Posting a Qt event is caught through the allocation of the event.
+// Other builds compile the section away.
+class RtSection {
+public:
+  RtSection();
+  ~RtSection();
+  RtSection(const RtSection &) = delete;
+  RtSection &operator=(const RtSection &) = delete;
+};
+
+bool rtSafetyChecksEnabled();
+RtSafetyCounts rtSafetyCounts();
@@ -0,0 +1,426 @@
+#include "RtpAudioSource.h"
+
+#include "SampleKernels.h"
+#include "ThreadPlacement.h"
+
+#include <QMetaObject>
+#include <QStringList>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+constexpr int kRingCapacityFrames = 65536;
+constexpr int kMaxDatagramBytes = 65536;
+constexpr int kMaxRtpChannels = 8;
+constexpr int kReceiveBufferBytes = 1 << 20;
+constexpr int64_t kIdlePollNs = 100000000LL;
+constexpr int64_t kPrefillPollNs = 1000000LL;
+constexpr int64_t kResyncLateNs = 1000000000LL;
+
+const QString kRtpPrefix = QStringLiteral("rtp:");
+
+struct FormatName {
+  RtpPayloadFormat format;
+  const char *name;
+};
+
+constexpr FormatName kFormats[] = {
+    {RtpPayloadFormat::L16, "l16"},
+    {RtpPayloadFormat::L24, "l24"},
+    {RtpPayloadFormat::F32, "f32"},
+};
+
+QString formatName(RtpPayloadFormat format) {
+  for (const FormatName &entry : kFormats) {
+    if (entry.format == format) {
+      return QString::fromLatin1(entry.name);
+    }
+  }
+  return QStringLiteral("l16");
+}
+
+int64_t framesToNs(int frames, int sampleRate) { return static_cast<int64_t>(frames) * 1000000000LL / sampleRate; }
+} // namespace
+
+RtpAudioSource::RtpAudioSource(QObject *parent)
+    : BufferedAudioSource(kRingCapacityFrames, parent), m_deviceId(kRtpPrefix + QStringLiteral("5004")) {}
+
+RtpAudioSource::~RtpAudioSource() { stop(); }
+
+bool RtpAudioSource::start() {
+  if (m_running) {
+    return true;
+  }
+
+  RtpInputSettings settings;
+  {
+    const std::lock_guard<std::mutex> lock(m_settingsMutex);
+    settings = m_settings;
+  }
+  QString error;
+  const int socketFd = openSocket(settings, &error);
+  if (socketFd < 0) {
+    Q_EMIT errorMessage(QStringLiteral("RTP input: %1").arg(error));
+    return false;
+  }
+
+  m_sampleRate = settings.sampleRate;
+  m_packets = 0;
+  m_invalidPackets = 0;
+  m_latePackets = 0;
+  m_concealedFrames = 0;
+  m_skippedFrames = 0;
+  m_resyncs = 0;
+  m_running = true;
+  startDraining();
+  setFillGaps(true);
+  m_receiverThread = std::thread(&RtpAudioSource::runReceiver, this, socketFd, settings);
+  Q_EMIT statusMessage(QStringLiteral("Audio backend: RTP (%1), waiting for a sender.").arg(selectedDeviceId()));
+  return true;
+}
+
+void RtpAudioSource::stop() {
+  m_running = false;
+  if (m_receiverThread.joinable()) {
+    m_receiverThread.join();
+  }
+  stopDraining();
+}
+
+bool RtpAudioSource::isRunning() const { return m_running.load(); }
+
+QString RtpAudioSource::backendName() const { return QStringLiteral("RTP"); }
+
+QVector<AudioDeviceInfo> RtpAudioSource::availableDevices() const {
+  QVector<AudioDeviceInfo> devices;
+  const auto addDevice = [&devices](const QString &id, const QString &description) {
+    for (const AudioDeviceInfo &device : devices) {
+      if (device.id == id) {
+        return;
+      }
+    }
+    AudioDeviceInfo device;
+    device.id = id;
+    device.name = QStringLiteral("RTP: %1").arg(id.mid(kRtpPrefix.size()));
+    device.description = description;
+    devices.push_back(device);
+  };
+
+  addDevice(selectedDeviceId(), QStringLiteral("RTP PCM input"));
+  addDevice(kRtpPrefix + QStringLiteral("5004"), QStringLiteral("L16 stereo 48 kHz on 127.0.0.1:5004"));
+  addDevice(kRtpPrefix + QStringLiteral("5004,format=f32"), QStringLiteral("Float stereo 48 kHz on 127.0.0.1:5004"));
+  addDevice(kRtpPrefix + QStringLiteral("0.0.0.0:5004"), QStringLiteral("L16 stereo 48 kHz on every interface"));
+  return devices;
+}
+
+QString RtpAudioSource::selectedDeviceId() const {
+  const std::lock_guard<std::mutex> lock(m_settingsMutex);
+  return m_deviceId;
+}
+
+void RtpAudioSource::setSelectedDeviceId(const QString &deviceId) {
+  const QString trimmed = deviceId.trimmed();
+  // Ids saved for other backends are ignored so the input keeps its port.
+  if (!trimmed.startsWith(kRtpPrefix)) {
+    return;
+  }
+  RtpInputSettings settings;
+  QString error;
+  if (!parseDeviceId(trimmed, &settings, &error)) {
+    Q_EMIT errorMessage(QStringLiteral("RTP input: %1").arg(error));
+    return;
+  }
+
+  const std::lock_guard<std::mutex> lock(m_settingsMutex);
+  m_deviceId = trimmed;
+  m_settings = settings;
+}
+
+AudioLatencyInfo RtpAudioSource::latencyInfo() const {
+  RtpInputSettings settings;
+  {
+    const std::lock_guard<std::mutex> lock(m_settingsMutex);
+    settings = m_settings;
+  }
+  AudioLatencyInfo info;
+  info.sampleRate = m_sampleRate.load();
+  info.requestedFrames = static_cast<int>(static_cast<int64_t>(settings.minDelayMs) * info.sampleRate / 1000);
+  info.quantumFrames = m_packetFrames.load(std::memory_order_relaxed);
+  info.graphDelayMs = m_bufferedMs.load(std::memory_order_relaxed);
+  info.jitterMs = m_jitterMs.load(std::memory_order_relaxed);
+  info.targetDelayMs = m_targetDelayMs.load(std::memory_order_relaxed);
+  return info;
+}
+
+AudioCaptureStats RtpAudioSource::captureStats() const {
+  AudioCaptureStats stats = BufferedAudioSource::captureStats();
+  stats.callbacks = m_packets.load(std::memory_order_relaxed);
+  stats.strideMismatches = m_invalidPackets.load(std::memory_order_relaxed);
+  stats.xruns = m_resyncs.load(std::memory_order_relaxed);
+  stats.latePackets = m_latePackets.load(std::memory_order_relaxed);
+  stats.concealedFrames = m_concealedFrames.load(std::memory_order_relaxed);
+  stats.skippedFrames = m_skippedFrames.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool RtpAudioSource::parseDeviceId(const QString &deviceId, RtpInputSettings *settings, QString *error) {
+  const QString spec = deviceId.startsWith(kRtpPrefix) ? deviceId.mid(kRtpPrefix.size()) : deviceId;
+  const QStringList parts = spec.split(QLatin1Char(','));
+  RtpInputSettings parsed;
+
+  // [host:]port, with IPv6 hosts in brackets.
+  QString address = parts.value(0).trimmed();
+  QString portText = address;
+  if (address.startsWith(QStringLiteral("["))) {
+    const qsizetype close = address.indexOf(QStringLiteral("]:"));
+    if (close < 0) {
+      if (error != nullptr) {
+        *error = QStringLiteral("expected [address]:port, got \"%1\"").arg(address);
+      }
+      return false;
+    }
+    parsed.host = address.mid(1, close - 1).toLatin1();
+    portText = address.mid(close + 2);
+  } else if (address.contains(QStringLiteral(":"))) {
+    const qsizetype separator = address.lastIndexOf(QLatin1Char(':'));
+    parsed.host = address.left(separator).toLatin1();
+    portText = address.mid(separator + 1);
+  }
+  bool ok = false;
+  parsed.port = portText.toInt(&ok);
+  if (!ok || parsed.port <= 0 || parsed.port > 65535 || parsed.host.isEmpty()) {
+    if (error != nullptr) {
+      *error = QStringLiteral("expected [host:]port, got \"%1\"").arg(address);
+    }
+    return false;
+  }
+
+  for (qsizetype i = 1; i < parts.size(); ++i) {
+    const QString option = parts.at(i).trimmed();
+    if (option.isEmpty()) {
+      continue;
+    }
+    const qsizetype separator = option.indexOf(QLatin1Char('='));
+    const QString key = option.left(separator).trimmed().toLower();
+    const QString value = separator > 0 ? option.mid(separator + 1).trimmed().toLower() : QString();
+
+    if (key == QStringLiteral("format")) {
+      bool known = false;
+      for (const FormatName &entry : kFormats) {
+        if (value == QLatin1String(entry.name)) {
+          parsed.format = entry.format;
+          known = true;
+        }
+      }
+      if (!known) {
+        if (error != nullptr) {
+          *error = QStringLiteral("unknown format \"%1\"; use l16, l24 or f32").arg(value);
+        }
+        return false;
+      }
+      continue;
+    }
+
+    const int number = value.toInt(&ok);
+    if (separator <= 0 || !ok) {
+      if (error != nullptr) {
+        *error = QStringLiteral("expected key=number, got \"%1\"").arg(option);
+      }
+      return false;
+    }
+    if (key == QStringLiteral("rate")) {
+      parsed.sampleRate = number;
+    } else if (key == QStringLiteral("channels")) {
+      parsed.channels = number;
+    } else if (key == QStringLiteral("latency")) {
+      parsed.minDelayMs = number;
+    } else if (key == QStringLiteral("max")) {
+      parsed.maxDelayMs = number;
+    } else {
+      if (error != nullptr) {
+        *error = QStringLiteral("unknown option \"%1\"").arg(key);
+      }
+      return false;
+    }
+  }
+
+  if (parsed.sampleRate < 8000 || parsed.sampleRate > 192000 || parsed.channels < 1 ||
+      parsed.channels > kMaxRtpChannels || parsed.minDelayMs < 0 || parsed.maxDelayMs < parsed.minDelayMs) {
+    if (error != nullptr) {
+      *error = QStringLiteral("unsupported stream %1 Hz, %2 channels, %3-%4 ms delay")
+                   .arg(parsed.sampleRate)
+                   .arg(parsed.channels)
+                   .arg(parsed.minDelayMs)
+                   .arg(parsed.maxDelayMs);
+    }
+    return false;
+  }
+
+  *settings = parsed;
+  return true;
+}
+
+int RtpAudioSource::openSocket(const RtpInputSettings &settings, QString *error) const {
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+  addrinfo *addresses = nullptr;
+  const QByteArray port = QByteArray::number(settings.port);
+  const int status = ::getaddrinfo(settings.host.constData(), port.constData(), &hints, &addresses);
+  if (status != 0) {
+    *error = QStringLiteral("could not resolve %1: %2")
+                 .arg(QString::fromLatin1(settings.host), QString::fromLocal8Bit(::gai_strerror(status)));
+    return -1;
+  }
+
+  int socketFd = -1;
+  int lastErrno = 0;
+  for (addrinfo *address = addresses; address != nullptr && socketFd < 0; address = address->ai_next) {
+    socketFd = ::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+    if (socketFd < 0) {
+      lastErrno = errno;
+      continue;
+    }
+    const int reuse = 1;
+    ::setsockopt(socketFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    // Room for a burst after a scheduling hiccup; the kernel may cap it.
+    const int receiveBuffer = kReceiveBufferBytes;
+    ::setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    if (::bind(socketFd, address->ai_addr, address->ai_addrlen) != 0) {
+      lastErrno = errno;
+      ::close(socketFd);
+      socketFd = -1;
+    }
+  }
+  ::freeaddrinfo(addresses);
+
+  if (socketFd < 0) {
+    *error = QStringLiteral("could not listen on %1:%2: %3")
+                 .arg(QString::fromLatin1(settings.host))
+                 .arg(settings.port)
+                 .arg(QString::fromLocal8Bit(std::strerror(lastErrno)));
+  }
+  return socketFd;
+}
+
+void RtpAudioSource::runReceiver(int socketFd, RtpInputSettings settings) {
+  const ThreadPlacementScope placement(ThreadRole::Capture, "rtp-receive");
+  RtpJitterBuffer jitter;
+  jitter.configure(settings.sampleRate, settings.minDelayMs, settings.maxDelayMs);
+
+  std::vector<uint8_t> datagram(static_cast<size_t>(kMaxDatagramBytes));
+  std::vector<float> decoded(static_cast<size_t>(RtpJitterBuffer::kMaxPacketFrames) * settings.channels);
+  std::vector<float> stereo(static_cast<size_t>(RtpJitterBuffer::kMaxPacketFrames) * 2U);
+  std::vector<float> block(static_cast<size_t>(RtpJitterBuffer::kMaxPacketFrames) * 2U);
+  const int64_t frameNs = framesToNs(1, settings.sampleRate);
+
+  // The block popped from the jitter buffer is handed to the capture ring
+  // once the local clock has played it out, like a sound card period.
+  int heldFrames = 0;
+  int64_t blockEndNs = 0;
+  bool clockRunning = false;
+  bool streamSeen = false;
+
+  while (m_running) {
+    int64_t nowNs = monotonicTimeNs();
+    for (;;) {
+      if (heldFrames > 0) {
+        if (nowNs < blockEndNs) {
+          break;
+        }
+        m_ring.write(block.data(), heldFrames);
+        meterCaptured(block.data(), heldFrames);
+        m_ring.markTimestamp(blockEndNs - frameNs);
+        heldFrames = 0;
+        if (nowNs - blockEndNs > kResyncLateNs) {
+          // Stalled (suspend, debugger): restart the clock rather than burst to catch up.
+          clockRunning = false;
+        }
+      }
+      if (!clockRunning) {
+        blockEndNs = nowNs;
+      }
+      heldFrames = jitter.pop(block.data(), nowNs);
+      clockRunning = heldFrames > 0;
+      if (!clockRunning) {
+        break;
+      }
+      blockEndNs += framesToNs(heldFrames, settings.sampleRate);
+    }
+
+    if (jitter.hasStream() != streamSeen) {
+      streamSeen = jitter.hasStream();
+      postStatus(streamSeen ? QStringLiteral("RTP sender connected (%1, %2 Hz, %3 channels).")
+                                  .arg(formatName(settings.format).toUpper())
+                                  .arg(settings.sampleRate)
+                                  .arg(settings.channels)
+                            : QStringLiteral("RTP sender stopped; waiting for a new one."));
+    }
+    publishStats(jitter);
+
+    const int64_t waitNs =
+        heldFrames > 0 ? std::max<int64_t>(0, blockEndNs - nowNs) : jitter.hasStream() ? kPrefillPollNs : kIdlePollNs;
+    const timespec timeout = {static_cast<time_t>(waitNs / 1000000000LL), static_cast<long>(waitNs % 1000000000LL)};
+    pollfd descriptor = {socketFd, POLLIN, 0};
+    const int ready = ::ppoll(&descriptor, 1, &timeout, nullptr);
+    if (ready < 0 && errno != EINTR) {
+      break;
+    }
+    if (ready <= 0) {
+      continue;
+    }
+
+    for (;;) {
+      const ssize_t size = ::recv(socketFd, datagram.data(), datagram.size(), MSG_DONTWAIT);
+      if (size < 0) {
+        break;
+      }
+      nowNs = monotonicTimeNs();
+      RtpPacket packet;
+      if (!parseRtpPacket(datagram.data(), static_cast<int>(size), &packet)) {
+        m_invalidPackets.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      const int frames = decodeRtpPayload(packet, settings.format, settings.channels, decoded.data(),
+                                          RtpJitterBuffer::kMaxPacketFrames);
+      if (frames <= 0) {
+        m_invalidPackets.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      const float *frame = decoded.data();
+      if (settings.channels != 2) {
+        sampleKernels().interleavedToStereo(decoded.data(), stereo.data(), frames, settings.channels);
+        frame = stereo.data();
+      }
+      jitter.push(packet.sequence, packet.timestamp, packet.ssrc, frame, frames, nowNs);
+    }
+  }
+
+  ::close(socketFd);
+}
+
+void RtpAudioSource::publishStats(const RtpJitterBuffer &jitter) {
+  const RtpJitterStats stats = jitter.stats();
+  m_packets.store(stats.receivedPackets, std::memory_order_relaxed);
+  m_latePackets.store(stats.latePackets, std::memory_order_relaxed);
+  m_concealedFrames.store(stats.concealedFrames, std::memory_order_relaxed);
+  m_skippedFrames.store(stats.skippedFrames, std::memory_order_relaxed);
+  m_resyncs.store(stats.resyncs, std::memory_order_relaxed);
+  m_packetFrames.store(stats.packetFrames, std::memory_order_relaxed);
+  m_jitterMs.store(stats.jitterMs, std::memory_order_relaxed);
+  m_targetDelayMs.store(stats.targetDelayMs, std::memory_order_relaxed);
+  m_bufferedMs.store(stats.bufferedMs, std::memory_order_relaxed);
+}
+
+void RtpAudioSource::postStatus(const QString &message) {
+  QMetaObject::invokeMethod(this, [this, message]() { Q_EMIT statusMessage(message); }, Qt::QueuedConnection);
+}
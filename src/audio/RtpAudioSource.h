@@ -0,0 +1,70 @@
+#pragma once
+
+#include "BufferedAudioSource.h"
+#include "RtpJitterBuffer.h"
+
+#include <QByteArray>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+struct RtpInputSettings {
+  QByteArray host = QByteArrayLiteral("127.0.0.1");
+  int port = 5004;
+  RtpPayloadFormat format = RtpPayloadFormat::L16;
+  int sampleRate = 48000;
+  int channels = 2;
+  int minDelayMs = 20;
+  int maxDelayMs = 500;
+};
+
+// Receives PCM over RTP on a UDP socket, usually from another process on
+// the same machine. A receive thread feeds an adaptive jitter buffer and
+// plays it out one packet at a time on the local clock, so lost packets
+// are concealed and sender clock drift is absorbed by the buffer rather
+// than by the capture ring. The format is not negotiated: device ids are
+// "rtp:[host:]port[,key=value...]", for example "rtp:5004",
+// "rtp:0.0.0.0:5004,format=l24,rate=44100" or "rtp:[::1]:5004,latency=40".
+class RtpAudioSource : public BufferedAudioSource {
+  Q_OBJECT
+
+public:
+  explicit RtpAudioSource(QObject *parent = nullptr);
+  ~RtpAudioSource() override;
+
+  bool start() override;
+  void stop() override;
+  bool isRunning() const override;
+  QString backendName() const override;
+  QVector<AudioDeviceInfo> availableDevices() const override;
+  QString selectedDeviceId() const override;
+  void setSelectedDeviceId(const QString &deviceId) override;
+  AudioLatencyInfo latencyInfo() const override;
+  AudioCaptureStats captureStats() const override;
+
+  static bool parseDeviceId(const QString &deviceId, RtpInputSettings *settings, QString *error = nullptr);
+
+private:
+  int openSocket(const RtpInputSettings &settings, QString *error) const;
+  void runReceiver(int socketFd, RtpInputSettings settings);
+  void publishStats(const RtpJitterBuffer &jitter);
+  void postStatus(const QString &message);
+
+  std::atomic<bool> m_running{false};
+  std::thread m_receiverThread;
+  mutable std::mutex m_settingsMutex;
+  QString m_deviceId;
+  RtpInputSettings m_settings;
+
+  std::atomic<uint64_t> m_packets{0};
+  std::atomic<uint64_t> m_invalidPackets{0};
+  std::atomic<uint64_t> m_latePackets{0};
+  std::atomic<uint64_t> m_concealedFrames{0};
+  std::atomic<uint64_t> m_skippedFrames{0};
+  std::atomic<uint64_t> m_resyncs{0};
+  std::atomic<int> m_packetFrames{0};
+  std::atomic<double> m_jitterMs{0.0};
+  std::atomic<double> m_targetDelayMs{0.0};
+  std::atomic<double> m_bufferedMs{0.0};
+};
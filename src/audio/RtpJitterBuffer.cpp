@@ -0,0 +1,283 @@
+#include "RtpJitterBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr int kSlotCount = 1024;
+constexpr int kSampleRingFrames = 131072;
+constexpr int kJitterMultiple = 4;
+constexpr int64_t kAdjustIntervalNs = 250000000LL;
+constexpr int kRestartAfterUnderrunMs = 500;
+constexpr float kConcealDecay = 0.5f;
+constexpr int kLateAllowanceDecayShift = 9;
+
+uint16_t readBe16(const uint8_t *bytes) { return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]); }
+
+uint32_t readBe32(const uint8_t *bytes) {
+  return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+         (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+} // namespace
+
+bool parseRtpPacket(const uint8_t *datagram, int size, RtpPacket *packet) {
+  if (datagram == nullptr || size < 12 || (datagram[0] >> 6) != 2) {
+    return false;
+  }
+
+  int offset = 12 + 4 * (datagram[0] & 0x0F);
+  int end = size;
+  if ((datagram[0] & 0x20) != 0) {
+    end -= datagram[size - 1];
+  }
+  if ((datagram[0] & 0x10) != 0) {
+    if (offset + 4 > end) {
+      return false;
+    }
+    offset += 4 + 4 * readBe16(datagram + offset + 2);
+  }
+  if (offset > end) {
+    return false;
+  }
+
+  packet->sequence = readBe16(datagram + 2);
+  packet->timestamp = readBe32(datagram + 4);
+  packet->ssrc = readBe32(datagram + 8);
+  packet->payload = datagram + offset;
+  packet->payloadBytes = end - offset;
+  return true;
+}
+
+int decodeRtpPayload(const RtpPacket &packet, RtpPayloadFormat format, int channels, float *interleaved, int maxFrames) {
+  const int sampleBytes = format == RtpPayloadFormat::L16 ? 2 : format == RtpPayloadFormat::L24 ? 3 : 4;
+  if (channels <= 0 || packet.payload == nullptr) {
+    return 0;
+  }
+  const int frames = std::min(packet.payloadBytes / (sampleBytes * channels), maxFrames);
+  const int samples = frames * channels;
+  const uint8_t *in = packet.payload;
+
+  switch (format) {
+  case RtpPayloadFormat::L16:
+    for (int i = 0; i < samples; ++i, in += 2) {
+      interleaved[i] = static_cast<float>(static_cast<int16_t>(readBe16(in))) / 32768.0f;
+    }
+    break;
+  case RtpPayloadFormat::L24:
+    for (int i = 0; i < samples; ++i, in += 3) {
+      const uint32_t bits = (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+                            (static_cast<uint32_t>(in[2]) << 8);
+      interleaved[i] = static_cast<float>(static_cast<int32_t>(bits) >> 8) / 8388608.0f;
+    }
+    break;
+  case RtpPayloadFormat::F32:
+    for (int i = 0; i < samples; ++i, in += 4) {
+      const uint32_t bits = readBe32(in);
+      std::memcpy(&interleaved[i], &bits, sizeof(float));
+    }
+    break;
+  }
+  return frames;
+}
+
+RtpJitterBuffer::RtpJitterBuffer()
+    : m_samples(static_cast<size_t>(kSampleRingFrames) * 2U, 0.0f),
+      m_slots(kSlotCount),
+      m_lastPacket(static_cast<size_t>(kMaxPacketFrames) * 2U, 0.0f) {
+  configure(48000, 20, 500);
+}
+
+void RtpJitterBuffer::configure(int sampleRate, int minDelayMs, int maxDelayMs) {
+  m_sampleRate = std::max(1000, sampleRate);
+  m_minDelayFrames = static_cast<int>(static_cast<int64_t>(std::max(0, minDelayMs)) * m_sampleRate / 1000);
+  m_maxDelayFrames = static_cast<int>(static_cast<int64_t>(std::max(0, maxDelayMs)) * m_sampleRate / 1000);
+  m_maxDelayFrames = std::clamp(m_maxDelayFrames, m_minDelayFrames, kSampleRingFrames / 2);
+  m_minDelayFrames = std::min(m_minDelayFrames, m_maxDelayFrames);
+  reset();
+}
+
+void RtpJitterBuffer::reset() {
+  std::fill(m_slots.begin(), m_slots.end(), Slot());
+  m_started = false;
+  m_playing = false;
+  m_packetFrames = 0;
+  m_lastFrames = 0;
+  m_concealRun = 0;
+  m_haveTransit = false;
+  m_jitterFrames = 0.0;
+  m_lateAllowanceFrames = 0;
+  m_stats = RtpJitterStats();
+}
+
+void RtpJitterBuffer::push(uint16_t sequence,
+                           uint32_t timestamp,
+                           uint32_t ssrc,
+                           const float *stereo,
+                           int frames,
+                           int64_t arrivalNs) {
+  if (stereo == nullptr || frames <= 0) {
+    return;
+  }
+  frames = std::min(frames, kMaxPacketFrames);
+
+  if (!m_started || ssrc != m_ssrc) {
+    m_stats.resyncs += m_started ? 1 : 0;
+    startStream(sequence, timestamp, ssrc, arrivalNs);
+  } else {
+    const auto ahead = static_cast<int16_t>(sequence - m_nextSequence);
+    if (ahead < 0) {
+      // It was concealed already; keep that much more delay for a while.
+      ++m_stats.latePackets;
+      const auto lateFrames = static_cast<int32_t>(m_nextTimestamp - timestamp);
+      m_lateAllowanceFrames = std::clamp(lateFrames, m_lateAllowanceFrames, m_maxDelayFrames);
+      return;
+    }
+    // A jump past what the buffer can hold is a sender restart, not loss.
+    const auto span = static_cast<int32_t>(timestamp + static_cast<uint32_t>(frames) - m_nextTimestamp);
+    if (ahead >= kSlotCount || span < 0 || span > kSampleRingFrames) {
+      ++m_stats.resyncs;
+      startStream(sequence, timestamp, ssrc, arrivalNs);
+    }
+  }
+
+  // Interarrival jitter, RFC 3550 section 6.4.1, in sample-clock units.
+  if (m_haveTransit) {
+    const double arrivalFrames = static_cast<double>(arrivalNs - m_lastArrivalNs) * m_sampleRate / 1e9;
+    const double difference = arrivalFrames - static_cast<int32_t>(timestamp - m_lastTimestamp);
+    m_jitterFrames += (std::abs(difference) - m_jitterFrames) / 16.0;
+  }
+  m_haveTransit = true;
+  m_lastArrivalNs = arrivalNs;
+  m_lastTimestamp = timestamp;
+
+  Slot &slot = m_slots[sequence & (kSlotCount - 1)];
+  slot.filled = true;
+  slot.sequence = sequence;
+  slot.timestamp = timestamp;
+  slot.frames = frames;
+
+  const int start = static_cast<int>(timestamp & (kSampleRingFrames - 1));
+  const int firstPart = std::min(frames, kSampleRingFrames - start);
+  std::memcpy(m_samples.data() + 2 * start, stereo, static_cast<size_t>(firstPart) * 2U * sizeof(float));
+  std::memcpy(m_samples.data(), stereo + 2 * firstPart, static_cast<size_t>(frames - firstPart) * 2U * sizeof(float));
+
+  if (static_cast<int32_t>(timestamp + static_cast<uint32_t>(frames) - m_newestEnd) > 0) {
+    m_newestEnd = timestamp + static_cast<uint32_t>(frames);
+  }
+  m_packetFrames = frames;
+  ++m_stats.receivedPackets;
+}
+
+int RtpJitterBuffer::pop(float *stereo, int64_t nowNs) {
+  if (!m_started) {
+    return 0;
+  }
+
+  const int target = targetFrames();
+  if (!m_playing) {
+    const int64_t waitedNs = nowNs - m_firstArrivalNs;
+    if (bufferedFrames() < target && waitedNs * m_sampleRate < static_cast<int64_t>(target) * 1000000000LL) {
+      return 0;
+    }
+    m_playing = true;
+    m_lastAdjustNs = nowNs;
+  }
+
+  Slot *slot = &m_slots[m_nextSequence & (kSlotCount - 1)];
+  bool present = slot->filled && slot->sequence == m_nextSequence;
+  const int hysteresis = std::max(m_packetFrames, m_sampleRate / 200);
+  if (present && bufferedFrames() - slot->frames > target + hysteresis && nowNs - m_lastAdjustNs >= kAdjustIntervalNs) {
+    m_stats.skippedFrames += static_cast<uint64_t>(slot->frames);
+    advancePast(*slot);
+    m_lastAdjustNs = nowNs;
+    slot = &m_slots[m_nextSequence & (kSlotCount - 1)];
+    present = slot->filled && slot->sequence == m_nextSequence;
+  }
+
+  if (present) {
+    const int frames = slot->frames;
+    const int start = static_cast<int>(slot->timestamp & (kSampleRingFrames - 1));
+    const int firstPart = std::min(frames, kSampleRingFrames - start);
+    std::memcpy(stereo, m_samples.data() + 2 * start, static_cast<size_t>(firstPart) * 2U * sizeof(float));
+    std::memcpy(stereo + 2 * firstPart, m_samples.data(), static_cast<size_t>(frames - firstPart) * 2U * sizeof(float));
+    std::memcpy(m_lastPacket.data(), stereo, static_cast<size_t>(frames) * 2U * sizeof(float));
+    m_lastFrames = frames;
+    m_concealRun = 0;
+    m_lateAllowanceFrames -= m_lateAllowanceFrames >> kLateAllowanceDecayShift;
+    advancePast(*slot);
+    return frames;
+  }
+
+  m_lateAllowanceFrames -= m_lateAllowanceFrames >> kLateAllowanceDecayShift;
+  const int frames = m_packetFrames;
+  if (bufferedFrames() >= target) {
+    // Enough later audio is queued that waiting for this one would only
+    // add delay: treat it as lost.
+    ++m_nextSequence;
+    m_nextTimestamp += static_cast<uint32_t>(frames);
+  } else if (bufferedFrames() == 0 && static_cast<int64_t>(m_concealRun + 1) * frames * 1000 >=
+             static_cast<int64_t>(kRestartAfterUnderrunMs) * m_sampleRate) {
+    // The sender has stopped; the next packet starts a new stream.
+    m_started = false;
+    m_playing = false;
+    return 0;
+  }
+  return conceal(stereo, frames);
+}
+
+bool RtpJitterBuffer::hasStream() const { return m_started; }
+
+bool RtpJitterBuffer::isPlaying() const { return m_playing; }
+
+RtpJitterStats RtpJitterBuffer::stats() const {
+  RtpJitterStats stats = m_stats;
+  stats.jitterMs = m_jitterFrames * 1000.0 / m_sampleRate;
+  stats.targetDelayMs = targetFrames() * 1000.0 / m_sampleRate;
+  stats.bufferedMs = m_started ? bufferedFrames() * 1000.0 / m_sampleRate : 0.0;
+  stats.packetFrames = m_packetFrames;
+  return stats;
+}
+
+void RtpJitterBuffer::startStream(uint16_t sequence, uint32_t timestamp, uint32_t ssrc, int64_t arrivalNs) {
+  std::fill(m_slots.begin(), m_slots.end(), Slot());
+  m_started = true;
+  m_playing = false;
+  m_ssrc = ssrc;
+  m_nextSequence = sequence;
+  m_nextTimestamp = timestamp;
+  m_newestEnd = timestamp;
+  m_firstArrivalNs = arrivalNs;
+  m_lastFrames = 0;
+  m_concealRun = 0;
+  m_haveTransit = false;
+}
+
+int RtpJitterBuffer::bufferedFrames() const {
+  return std::max(0, static_cast<int32_t>(m_newestEnd - m_nextTimestamp));
+}
+
+int RtpJitterBuffer::targetFrames() const {
+  const int wanted = m_packetFrames + static_cast<int>(kJitterMultiple * m_jitterFrames) + m_lateAllowanceFrames;
+  return std::clamp(wanted, m_minDelayFrames, m_maxDelayFrames);
+}
+
+void RtpJitterBuffer::advancePast(Slot &slot) {
+  slot.filled = false;
+  m_nextSequence = static_cast<uint16_t>(slot.sequence + 1);
+  m_nextTimestamp = slot.timestamp + static_cast<uint32_t>(slot.frames);
+}
+
+int RtpJitterBuffer::conceal(float *stereo, int frames) {
+  m_stats.concealedFrames += static_cast<uint64_t>(frames);
+  const float gain = std::pow(kConcealDecay, static_cast<float>(++m_concealRun));
+  if (m_lastFrames <= 0 || gain < 1e-3f) {
+    std::fill(stereo, stereo + 2 * frames, 0.0f);
+    return frames;
+  }
+  const int period = 2 * m_lastFrames;
+  for (int i = 0; i < 2 * frames; ++i) {
+    stereo[i] = m_lastPacket[static_cast<size_t>(i % period)] * gain;
+  }
+  return frames;
+}
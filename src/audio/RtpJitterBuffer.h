@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum class RtpPayloadFormat { L16, L24, F32 };
+
+struct RtpPacket {
+  uint16_t sequence = 0;
+  uint32_t timestamp = 0;
+  uint32_t ssrc = 0;
+  const uint8_t *payload = nullptr;
+  int payloadBytes = 0;
+};
+
+// Splits an RTP datagram (RFC 3550) into header fields and payload, skipping
+// CSRCs, a header extension and padding. False for anything not version 2.
+bool parseRtpPacket(const uint8_t *datagram, int size, RtpPacket *packet);
+// Decodes big-endian L16/L24 (RFC 3551/3190) or big-endian float32 into
+// interleaved floats; returns whole frames decoded, at most maxFrames.
+int decodeRtpPayload(const RtpPacket &packet, RtpPayloadFormat format, int channels, float *interleaved, int maxFrames);
+
+struct RtpJitterStats {
+  uint64_t receivedPackets = 0;
+  uint64_t latePackets = 0;
+  uint64_t concealedFrames = 0;
+  uint64_t skippedFrames = 0;
+  uint64_t resyncs = 0;
+  double jitterMs = 0.0;
+  double targetDelayMs = 0.0;
+  double bufferedMs = 0.0;
+  int packetFrames = 0;
+};
+
+// Reorders stereo RTP packets and plays them out one packet at a time.
+// Playout starts once the first packet has waited the target delay, which
+// follows the RFC 3550 interarrival jitter estimate, plus however late
+// recent stragglers were, between a minimum and a maximum. A missing packet
+// is concealed by repeating the last one at falling gain. Below target the
+// concealment holds position, so the delay grows and a straggler can still
+// play; at or above target the packet counts as lost. A queue well above
+// target drops one packet at a time to shrink it, which also absorbs clock
+// drift between sender and receiver.
+// Not thread-safe: the receive thread pushes and pops.
+class RtpJitterBuffer {
+public:
+  static constexpr int kMaxPacketFrames = 4096;
+
+  RtpJitterBuffer();
+
+  void configure(int sampleRate, int minDelayMs, int maxDelayMs);
+  void reset();
+
+  void push(uint16_t sequence, uint32_t timestamp, uint32_t ssrc, const float *stereo, int frames, int64_t arrivalNs);
+  // Writes the next packet, real or concealed, and returns its frame count;
+  // 0 while there is nothing to play yet.
+  int pop(float *stereo, int64_t nowNs);
+  bool hasStream() const;
+  bool isPlaying() const;
+  RtpJitterStats stats() const;
+
+private:
+  struct Slot {
+    bool filled = false;
+    uint16_t sequence = 0;
+    uint32_t timestamp = 0;
+    int frames = 0;
+  };
+
+  void startStream(uint16_t sequence, uint32_t timestamp, uint32_t ssrc, int64_t arrivalNs);
+  int bufferedFrames() const;
+  int targetFrames() const;
+  void advancePast(Slot &slot);
+  int conceal(float *stereo, int frames);
+
+  int m_sampleRate = 48000;
+  int m_minDelayFrames = 0;
+  int m_maxDelayFrames = 0;
+
+  std::vector<float> m_samples;
+  std::vector<Slot> m_slots;
+  std::vector<float> m_lastPacket;
+  int m_lastFrames = 0;
+  int m_concealRun = 0;
+
+  bool m_started = false;
+  bool m_playing = false;
+  uint32_t m_ssrc = 0;
+  uint16_t m_nextSequence = 0;
+  uint32_t m_nextTimestamp = 0;
+  uint32_t m_newestEnd = 0;
+  int m_packetFrames = 0;
+  int64_t m_firstArrivalNs = 0;
+  int64_t m_lastAdjustNs = 0;
+
+  bool m_haveTransit = false;
+  int64_t m_lastArrivalNs = 0;
+  uint32_t m_lastTimestamp = 0;
+  double m_jitterFrames = 0.0;
+  int m_lateAllowanceFrames = 0;
+
+  RtpJitterStats m_stats;
+};
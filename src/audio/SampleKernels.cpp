@@ -0,0 +1,820 @@
+#include "SampleKernels.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define QT6MPLAYER_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define QT6MPLAYER_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+constexpr float kCenterGain = 0.70710678f;
+constexpr float kSurroundGain = 0.70710678f;
+// BS.775 drops the LFE channel entirely; we fold it in at -6 dB instead so kick
+// energy from 5.1/7.1 sources still reaches beat detection.
+constexpr float kLfeGain = 0.5f;
+// Each stereo side is scaled by the sum of its coefficients, so full-scale
+// input on every channel stays within [-1, 1].
+constexpr float kFront51 = 1.0f / (1.0f + kCenterGain + kLfeGain + kSurroundGain);
+constexpr float kCenter51 = kCenterGain * kFront51;
+constexpr float kLfe51 = kLfeGain * kFront51;
+constexpr float kSurround51 = kSurroundGain * kFront51;
+constexpr float kFront71 = 1.0f / (1.0f + kCenterGain + kLfeGain + 2.0f * kSurroundGain);
+constexpr float kCenter71 = kCenterGain * kFront71;
+constexpr float kLfe71 = kLfeGain * kFront71;
+constexpr float kSurround71 = kSurroundGain * kFront71;
+constexpr float kS16Scale = 1.0f / 32768.0f;
+constexpr float kS32Scale = 1.0f / 2147483648.0f;
+
+void scalarInterleavedToMono(const float *in, float *out, int frames, int channels) {
+  if (channels <= 0) {
+    return;
+  }
+  const float scale = 1.0f / static_cast<float>(channels);
+  for (int i = 0; i < frames; ++i) {
+    const float *frame = in + static_cast<size_t>(i) * static_cast<size_t>(channels);
+    float accum = 0.0f;
+    for (int c = 0; c < channels; ++c) {
+      accum += frame[c];
+    }
+    out[i] = accum * scale;
+  }
+}
+
+void scalarDownmix51ToStereo(const float *in, float *out, int frames) {
+  for (int i = 0; i < frames; ++i) {
+    const float *frame = in + static_cast<size_t>(i) * 6U;
+    const float common = kCenter51 * frame[2] + kLfe51 * frame[3];
+    out[2 * i] = kFront51 * frame[0] + common + kSurround51 * frame[4];
+    out[2 * i + 1] = kFront51 * frame[1] + common + kSurround51 * frame[5];
+  }
+}
+
+void scalarDownmix71ToStereo(const float *in, float *out, int frames) {
+  for (int i = 0; i < frames; ++i) {
+    const float *frame = in + static_cast<size_t>(i) * 8U;
+    const float common = kCenter71 * frame[2] + kLfe71 * frame[3];
+    out[2 * i] = kFront71 * frame[0] + common + kSurround71 * (frame[4] + frame[6]);
+    out[2 * i + 1] = kFront71 * frame[1] + common + kSurround71 * (frame[5] + frame[7]);
+  }
+}
+
+void scalarFrontPairToStereo(const float *in, float *out, int frames, int channels) {
+  for (int i = 0; i < frames; ++i) {
+    const float *frame = in + static_cast<size_t>(i) * static_cast<size_t>(channels);
+    out[2 * i] = frame[0];
+    out[2 * i + 1] = frame[1];
+  }
+}
+
+void scalarInterleavedToStereo(const float *in, float *out, int frames, int channels) {
+  switch (channels) {
+  case 1:
+    for (int i = 0; i < frames; ++i) {
+      out[2 * i] = in[i];
+      out[2 * i + 1] = in[i];
+    }
+    return;
+  case 2:
+    std::memcpy(out, in, static_cast<size_t>(frames) * 2U * sizeof(float));
+    return;
+  case 6:
+    scalarDownmix51ToStereo(in, out, frames);
+    return;
+  case 8:
+    scalarDownmix71ToStereo(in, out, frames);
+    return;
+  default:
+    if (channels > 2) {
+      scalarFrontPairToStereo(in, out, frames, channels);
+    }
+    return;
+  }
+}
+
+void scalarS16ToFloat(const int16_t *in, float *out, int samples) {
+  for (int i = 0; i < samples; ++i) {
+    out[i] = static_cast<float>(in[i]) * kS16Scale;
+  }
+}
+
+void scalarS32ToFloat(const int32_t *in, float *out, int samples) {
+  for (int i = 0; i < samples; ++i) {
+    out[i] = static_cast<float>(in[i]) * kS32Scale;
+  }
+}
+
+void scalarStereoLevels(const float *in, int frames, float *peaks, float *sumSquares) {
+  float peakLeft = 0.0f;
+  float peakRight = 0.0f;
+  float sumLeft = 0.0f;
+  float sumRight = 0.0f;
+  for (int i = 0; i < frames; ++i) {
+    const float left = in[2 * i];
+    const float right = in[2 * i + 1];
+    peakLeft = std::max(peakLeft, std::fabs(left));
+    peakRight = std::max(peakRight, std::fabs(right));
+    sumLeft += left * left;
+    sumRight += right * right;
+  }
+  peaks[0] = peakLeft;
+  peaks[1] = peakRight;
+  sumSquares[0] = sumLeft;
+  sumSquares[1] = sumRight;
+}
+
+// Folds the lanes of an L R L R ... accumulator pair and the scalar tail.
+void mergeStereoLevels(const float *laneMaxima, const float *laneSums, int lanes, const float *tailPeaks,
+                       const float *tailSums, float *peaks, float *sumSquares) {
+  peaks[0] = tailPeaks[0];
+  peaks[1] = tailPeaks[1];
+  sumSquares[0] = tailSums[0];
+  sumSquares[1] = tailSums[1];
+  for (int lane = 0; lane < lanes; ++lane) {
+    peaks[lane & 1] = std::max(peaks[lane & 1], laneMaxima[lane]);
+    sumSquares[lane & 1] += laneSums[lane];
+  }
+}
+
+// Butterflies first..half-1 of a pass; the SIMD kernels finish with it.
+void fftButterfliesFrom(float *re, float *im, const float *twiddleRe, const float *twiddleIm, int half, int first) {
+  for (int j = first; j < half; ++j) {
+    const float oddRe = twiddleRe[j] * re[j + half] - twiddleIm[j] * im[j + half];
+    const float oddIm = twiddleRe[j] * im[j + half] + twiddleIm[j] * re[j + half];
+    re[j + half] = re[j] - oddRe;
+    im[j + half] = im[j] - oddIm;
+    re[j] += oddRe;
+    im[j] += oddIm;
+  }
+}
+
+void scalarFftButterflies(float *re, float *im, const float *twiddleRe, const float *twiddleIm, int half) {
+  fftButterfliesFrom(re, im, twiddleRe, twiddleIm, half, 0);
+}
+
+const SampleKernels kScalarKernels = {
+    "scalar",
+    &scalarInterleavedToMono,
+    &scalarInterleavedToStereo,
+    &scalarS16ToFloat,
+    &scalarS32ToFloat,
+    &scalarDownmix51ToStereo,
+    &scalarDownmix71ToStereo,
+    &scalarStereoLevels,
+    &scalarFftButterflies,
+};
+
+#ifdef QT6MPLAYER_KERNELS_X86
+void sse2InterleavedToMono(const float *in, float *out, int frames, int channels) {
+  if (channels != 2) {
+    scalarInterleavedToMono(in, out, frames, channels);
+    return;
+  }
+
+  const __m128 half = _mm_set1_ps(0.5f);
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 a = _mm_loadu_ps(in + 2 * i);
+    const __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+    const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+  }
+  scalarInterleavedToMono(in + 2 * i, out + i, frames - i, 2);
+}
+
+void sse2Downmix51ToStereo(const float *in, float *out, int frames) {
+  const __m128 front = _mm_set1_ps(kFront51);
+  const __m128 center = _mm_set1_ps(kCenter51);
+  const __m128 lfe = _mm_set1_ps(kLfe51);
+  const __m128 surround = _mm_set1_ps(kSurround51);
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const float *block = in + static_cast<size_t>(i) * 6U;
+    // Overlapping loads: a* covers channels 0-3, b* covers channels 2-5.
+    __m128 a0 = _mm_loadu_ps(block);
+    __m128 a1 = _mm_loadu_ps(block + 6);
+    __m128 a2 = _mm_loadu_ps(block + 12);
+    __m128 a3 = _mm_loadu_ps(block + 18);
+    __m128 b0 = _mm_loadu_ps(block + 2);
+    __m128 b1 = _mm_loadu_ps(block + 8);
+    __m128 b2 = _mm_loadu_ps(block + 14);
+    __m128 b3 = _mm_loadu_ps(block + 20);
+    _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+    _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+
+    const __m128 common = _mm_add_ps(_mm_mul_ps(center, a2), _mm_mul_ps(lfe, a3));
+    const __m128 left = _mm_add_ps(_mm_add_ps(_mm_mul_ps(front, a0), common), _mm_mul_ps(surround, b2));
+    const __m128 right = _mm_add_ps(_mm_add_ps(_mm_mul_ps(front, a1), common), _mm_mul_ps(surround, b3));
+    _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(left, right));
+    _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(left, right));
+  }
+  scalarDownmix51ToStereo(in + static_cast<size_t>(i) * 6U, out + 2 * i, frames - i);
+}
+
+void sse2Downmix71ToStereo(const float *in, float *out, int frames) {
+  const __m128 front = _mm_set1_ps(kFront71);
+  const __m128 center = _mm_set1_ps(kCenter71);
+  const __m128 lfe = _mm_set1_ps(kLfe71);
+  const __m128 surround = _mm_set1_ps(kSurround71);
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const float *block = in + static_cast<size_t>(i) * 8U;
+    __m128 front0 = _mm_loadu_ps(block);
+    __m128 front1 = _mm_loadu_ps(block + 8);
+    __m128 front2 = _mm_loadu_ps(block + 16);
+    __m128 front3 = _mm_loadu_ps(block + 24);
+    __m128 rear0 = _mm_loadu_ps(block + 4);
+    __m128 rear1 = _mm_loadu_ps(block + 12);
+    __m128 rear2 = _mm_loadu_ps(block + 20);
+    __m128 rear3 = _mm_loadu_ps(block + 28);
+    _MM_TRANSPOSE4_PS(front0, front1, front2, front3);
+    _MM_TRANSPOSE4_PS(rear0, rear1, rear2, rear3);
+
+    const __m128 common = _mm_add_ps(_mm_mul_ps(center, front2), _mm_mul_ps(lfe, front3));
+    const __m128 left =
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(front, front0), common), _mm_mul_ps(surround, _mm_add_ps(rear0, rear2)));
+    const __m128 right =
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(front, front1), common), _mm_mul_ps(surround, _mm_add_ps(rear1, rear3)));
+    _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(left, right));
+    _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(left, right));
+  }
+  scalarDownmix71ToStereo(in + static_cast<size_t>(i) * 8U, out + 2 * i, frames - i);
+}
+
+void sse2InterleavedToStereo(const float *in, float *out, int frames, int channels) {
+  if (channels == 1) {
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+      const __m128 mono = _mm_loadu_ps(in + i);
+      _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(mono, mono));
+      _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(mono, mono));
+    }
+    scalarInterleavedToStereo(in + i, out + 2 * i, frames - i, 1);
+    return;
+  }
+  if (channels == 6) {
+    sse2Downmix51ToStereo(in, out, frames);
+    return;
+  }
+  if (channels == 8) {
+    sse2Downmix71ToStereo(in, out, frames);
+    return;
+  }
+  scalarInterleavedToStereo(in, out, frames, channels);
+}
+
+void sse2S16ToFloat(const int16_t *in, float *out, int samples) {
+  const __m128 scale = _mm_set1_ps(kS16Scale);
+  int i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+    const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+    _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+  }
+  scalarS16ToFloat(in + i, out + i, samples - i);
+}
+
+void sse2S32ToFloat(const int32_t *in, float *out, int samples) {
+  const __m128 scale = _mm_set1_ps(kS32Scale);
+  int i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(value), scale));
+  }
+  scalarS32ToFloat(in + i, out + i, samples - i);
+}
+
+void sse2StereoLevels(const float *in, int frames, float *peaks, float *sumSquares) {
+  const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+  __m128 peak0 = _mm_setzero_ps();
+  __m128 peak1 = _mm_setzero_ps();
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 a = _mm_loadu_ps(in + 2 * i);
+    const __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+    peak0 = _mm_max_ps(peak0, _mm_and_ps(a, magnitude));
+    peak1 = _mm_max_ps(peak1, _mm_and_ps(b, magnitude));
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(a, a));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(b, b));
+  }
+  float laneMaxima[4];
+  float laneSums[4];
+  _mm_storeu_ps(laneMaxima, _mm_max_ps(peak0, peak1));
+  _mm_storeu_ps(laneSums, _mm_add_ps(sum0, sum1));
+  float tailPeaks[2];
+  float tailSums[2];
+  scalarStereoLevels(in + 2 * i, frames - i, tailPeaks, tailSums);
+  mergeStereoLevels(laneMaxima, laneSums, 4, tailPeaks, tailSums, peaks, sumSquares);
+}
+
+void sse2FftButterflies(float *re, float *im, const float *twiddleRe, const float *twiddleIm, int half) {
+  int j = 0;
+  for (; j + 4 <= half; j += 4) {
+    const __m128 wr = _mm_loadu_ps(twiddleRe + j);
+    const __m128 wi = _mm_loadu_ps(twiddleIm + j);
+    const __m128 br = _mm_loadu_ps(re + j + half);
+    const __m128 bi = _mm_loadu_ps(im + j + half);
+    const __m128 ar = _mm_loadu_ps(re + j);
+    const __m128 ai = _mm_loadu_ps(im + j);
+    const __m128 oddRe = _mm_sub_ps(_mm_mul_ps(wr, br), _mm_mul_ps(wi, bi));
+    const __m128 oddIm = _mm_add_ps(_mm_mul_ps(wr, bi), _mm_mul_ps(wi, br));
+    _mm_storeu_ps(re + j + half, _mm_sub_ps(ar, oddRe));
+    _mm_storeu_ps(im + j + half, _mm_sub_ps(ai, oddIm));
+    _mm_storeu_ps(re + j, _mm_add_ps(ar, oddRe));
+    _mm_storeu_ps(im + j, _mm_add_ps(ai, oddIm));
+  }
+  fftButterfliesFrom(re, im, twiddleRe, twiddleIm, half, j);
+}
+
+const SampleKernels kSse2Kernels = {
+    "sse2",
+    &sse2InterleavedToMono,
+    &sse2InterleavedToStereo,
+    &sse2S16ToFloat,
+    &sse2S32ToFloat,
+    &sse2Downmix51ToStereo,
+    &sse2Downmix71ToStereo,
+    &sse2StereoLevels,
+    &sse2FftButterflies,
+};
+
+__attribute__((target("avx2"))) void avx2InterleavedToMono(const float *in, float *out, int frames, int channels) {
+  if (channels != 2) {
+    scalarInterleavedToMono(in, out, frames, channels);
+    return;
+  }
+
+  const __m256 half = _mm256_set1_ps(0.5f);
+  int i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    const __m256 a = _mm256_loadu_ps(in + 2 * i);
+    const __m256 b = _mm256_loadu_ps(in + 2 * i + 8);
+    const __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m256 mixed = _mm256_mul_ps(_mm256_add_ps(left, right), half);
+    // The in-lane shuffles leave frames ordered 0 1 4 5 | 2 3 6 7.
+    const __m256 ordered =
+        _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(mixed), _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm256_storeu_ps(out + i, ordered);
+  }
+  sse2InterleavedToMono(in + 2 * i, out + i, frames - i, 2);
+}
+
+__attribute__((target("avx2"))) void avx2InterleavedToStereo(const float *in, float *out, int frames, int channels) {
+  if (channels != 1) {
+    sse2InterleavedToStereo(in, out, frames, channels);
+    return;
+  }
+
+  int i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    const __m256 mono = _mm256_loadu_ps(in + i);
+    const __m256 low = _mm256_unpacklo_ps(mono, mono);
+    const __m256 high = _mm256_unpackhi_ps(mono, mono);
+    _mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(low, high, 0x20));
+    _mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(low, high, 0x31));
+  }
+  sse2InterleavedToStereo(in + i, out + 2 * i, frames - i, 1);
+}
+
+__attribute__((target("avx2"))) void avx2S16ToFloat(const int16_t *in, float *out, int samples) {
+  const __m256 scale = _mm256_set1_ps(kS16Scale);
+  int i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    const __m256i widened = _mm256_cvtepi16_epi32(packed);
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(widened), scale));
+  }
+  scalarS16ToFloat(in + i, out + i, samples - i);
+}
+
+__attribute__((target("avx2"))) void avx2S32ToFloat(const int32_t *in, float *out, int samples) {
+  const __m256 scale = _mm256_set1_ps(kS32Scale);
+  int i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(value), scale));
+  }
+  scalarS32ToFloat(in + i, out + i, samples - i);
+}
+
+__attribute__((target("avx2"))) void avx2StereoLevels(const float *in, int frames, float *peaks, float *sumSquares) {
+  const __m256 magnitude = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+  __m256 peak0 = _mm256_setzero_ps();
+  __m256 peak1 = _mm256_setzero_ps();
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    const __m256 a = _mm256_loadu_ps(in + 2 * i);
+    const __m256 b = _mm256_loadu_ps(in + 2 * i + 8);
+    peak0 = _mm256_max_ps(peak0, _mm256_and_ps(a, magnitude));
+    peak1 = _mm256_max_ps(peak1, _mm256_and_ps(b, magnitude));
+    sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(a, a));
+    sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(b, b));
+  }
+  float laneMaxima[8];
+  float laneSums[8];
+  _mm256_storeu_ps(laneMaxima, _mm256_max_ps(peak0, peak1));
+  _mm256_storeu_ps(laneSums, _mm256_add_ps(sum0, sum1));
+  float tailPeaks[2];
+  float tailSums[2];
+  sse2StereoLevels(in + 2 * i, frames - i, tailPeaks, tailSums);
+  mergeStereoLevels(laneMaxima, laneSums, 8, tailPeaks, tailSums, peaks, sumSquares);
+}
+
+__attribute__((target("avx2"))) void avx2FftButterflies(float *re,
+                                                        float *im,
+                                                        const float *twiddleRe,
+                                                        const float *twiddleIm,
+                                                        int half) {
+  if (half < 8) {
+    sse2FftButterflies(re, im, twiddleRe, twiddleIm, half);
+    return;
+  }
+
+  int j = 0;
+  for (; j + 8 <= half; j += 8) {
+    const __m256 wr = _mm256_loadu_ps(twiddleRe + j);
+    const __m256 wi = _mm256_loadu_ps(twiddleIm + j);
+    const __m256 br = _mm256_loadu_ps(re + j + half);
+    const __m256 bi = _mm256_loadu_ps(im + j + half);
+    const __m256 ar = _mm256_loadu_ps(re + j);
+    const __m256 ai = _mm256_loadu_ps(im + j);
+    const __m256 oddRe = _mm256_sub_ps(_mm256_mul_ps(wr, br), _mm256_mul_ps(wi, bi));
+    const __m256 oddIm = _mm256_add_ps(_mm256_mul_ps(wr, bi), _mm256_mul_ps(wi, br));
+    _mm256_storeu_ps(re + j + half, _mm256_sub_ps(ar, oddRe));
+    _mm256_storeu_ps(im + j + half, _mm256_sub_ps(ai, oddIm));
+    _mm256_storeu_ps(re + j, _mm256_add_ps(ar, oddRe));
+    _mm256_storeu_ps(im + j, _mm256_add_ps(ai, oddIm));
+  }
+  fftButterfliesFrom(re, im, twiddleRe, twiddleIm, half, j);
+}
+
+// The 5.1/7.1 transposes are bound by shuffle ports, not vector width, so the
+// AVX2 table keeps the SSE2 downmix kernels.
+const SampleKernels kAvx2Kernels = {
+    "avx2",
+    &avx2InterleavedToMono,
+    &avx2InterleavedToStereo,
+    &avx2S16ToFloat,
+    &avx2S32ToFloat,
+    &sse2Downmix51ToStereo,
+    &sse2Downmix71ToStereo,
+    &avx2StereoLevels,
+    &avx2FftButterflies,
+};
+#endif
+
+#ifdef QT6MPLAYER_KERNELS_NEON
+void neonInterleavedToMono(const float *in, float *out, int frames, int channels) {
+  if (channels != 2) {
+    scalarInterleavedToMono(in, out, frames, channels);
+    return;
+  }
+
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const float32x4x2_t stereo = vld2q_f32(in + 2 * i);
+    vst1q_f32(out + i, vmulq_n_f32(vaddq_f32(stereo.val[0], stereo.val[1]), 0.5f));
+  }
+  scalarInterleavedToMono(in + 2 * i, out + i, frames - i, 2);
+}
+
+void neonDownmix51ToStereo(const float *in, float *out, int frames) {
+  // vld3q on 6-channel frames yields lanes {FL,LFE}, {FR,RL}, {FC,RR} for two frames.
+  const float32x4_t leftGain0 = {kFront51, kLfe51, kFront51, kLfe51};
+  const float32x4_t leftGain1 = {0.0f, kSurround51, 0.0f, kSurround51};
+  const float32x4_t leftGain2 = {kCenter51, 0.0f, kCenter51, 0.0f};
+  const float32x4_t rightGain0 = {0.0f, kLfe51, 0.0f, kLfe51};
+  const float32x4_t rightGain1 = {kFront51, 0.0f, kFront51, 0.0f};
+  const float32x4_t rightGain2 = {kCenter51, kSurround51, kCenter51, kSurround51};
+  int i = 0;
+  for (; i + 2 <= frames; i += 2) {
+    const float32x4x3_t lanes = vld3q_f32(in + static_cast<size_t>(i) * 6U);
+    float32x4_t left = vmulq_f32(lanes.val[0], leftGain0);
+    left = vmlaq_f32(left, lanes.val[1], leftGain1);
+    left = vmlaq_f32(left, lanes.val[2], leftGain2);
+    float32x4_t right = vmulq_f32(lanes.val[0], rightGain0);
+    right = vmlaq_f32(right, lanes.val[1], rightGain1);
+    right = vmlaq_f32(right, lanes.val[2], rightGain2);
+    const float32x4_t sums = vpaddq_f32(left, right);
+    const float32x2x2_t zipped = vzip_f32(vget_low_f32(sums), vget_high_f32(sums));
+    vst1q_f32(out + 2 * i, vcombine_f32(zipped.val[0], zipped.val[1]));
+  }
+  scalarDownmix51ToStereo(in + static_cast<size_t>(i) * 6U, out + 2 * i, frames - i);
+}
+
+void neonDownmix71ToStereo(const float *in, float *out, int frames) {
+  // vld4q on 8-channel frames yields lanes {FL,RL}, {FR,RR}, {FC,SL}, {LFE,SR} for two frames.
+  const float32x4_t leftGain0 = {kFront71, kSurround71, kFront71, kSurround71};
+  const float32x4_t leftGain2 = {kCenter71, kSurround71, kCenter71, kSurround71};
+  const float32x4_t leftGain3 = {kLfe71, 0.0f, kLfe71, 0.0f};
+  const float32x4_t rightGain1 = {kFront71, kSurround71, kFront71, kSurround71};
+  const float32x4_t rightGain2 = {kCenter71, 0.0f, kCenter71, 0.0f};
+  const float32x4_t rightGain3 = {kLfe71, kSurround71, kLfe71, kSurround71};
+  int i = 0;
+  for (; i + 2 <= frames; i += 2) {
+    const float32x4x4_t lanes = vld4q_f32(in + static_cast<size_t>(i) * 8U);
+    float32x4_t left = vmulq_f32(lanes.val[0], leftGain0);
+    left = vmlaq_f32(left, lanes.val[2], leftGain2);
+    left = vmlaq_f32(left, lanes.val[3], leftGain3);
+    float32x4_t right = vmulq_f32(lanes.val[1], rightGain1);
+    right = vmlaq_f32(right, lanes.val[2], rightGain2);
+    right = vmlaq_f32(right, lanes.val[3], rightGain3);
+    const float32x4_t sums = vpaddq_f32(left, right);
+    const float32x2x2_t zipped = vzip_f32(vget_low_f32(sums), vget_high_f32(sums));
+    vst1q_f32(out + 2 * i, vcombine_f32(zipped.val[0], zipped.val[1]));
+  }
+  scalarDownmix71ToStereo(in + static_cast<size_t>(i) * 8U, out + 2 * i, frames - i);
+}
+
+void neonInterleavedToStereo(const float *in, float *out, int frames, int channels) {
+  if (channels == 1) {
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+      const float32x4_t mono = vld1q_f32(in + i);
+      float32x4x2_t stereo;
+      stereo.val[0] = mono;
+      stereo.val[1] = mono;
+      vst2q_f32(out + 2 * i, stereo);
+    }
+    scalarInterleavedToStereo(in + i, out + 2 * i, frames - i, 1);
+    return;
+  }
+  if (channels == 6) {
+    neonDownmix51ToStereo(in, out, frames);
+    return;
+  }
+  if (channels == 8) {
+    neonDownmix71ToStereo(in, out, frames);
+    return;
+  }
+  scalarInterleavedToStereo(in, out, frames, channels);
+}
+
+void neonS16ToFloat(const int16_t *in, float *out, int samples) {
+  int i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const int16x8_t packed = vld1q_s16(in + i);
+    vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(packed))), kS16Scale));
+    vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(packed))), kS16Scale));
+  }
+  scalarS16ToFloat(in + i, out + i, samples - i);
+}
+
+void neonS32ToFloat(const int32_t *in, float *out, int samples) {
+  int i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(in + i)), kS32Scale));
+  }
+  scalarS32ToFloat(in + i, out + i, samples - i);
+}
+
+void neonStereoLevels(const float *in, int frames, float *peaks, float *sumSquares) {
+  float32x4_t peak0 = vdupq_n_f32(0.0f);
+  float32x4_t peak1 = vdupq_n_f32(0.0f);
+  float32x4_t sum0 = vdupq_n_f32(0.0f);
+  float32x4_t sum1 = vdupq_n_f32(0.0f);
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const float32x4_t a = vld1q_f32(in + 2 * i);
+    const float32x4_t b = vld1q_f32(in + 2 * i + 4);
+    peak0 = vmaxq_f32(peak0, vabsq_f32(a));
+    peak1 = vmaxq_f32(peak1, vabsq_f32(b));
+    sum0 = vmlaq_f32(sum0, a, a);
+    sum1 = vmlaq_f32(sum1, b, b);
+  }
+  float laneMaxima[4];
+  float laneSums[4];
+  vst1q_f32(laneMaxima, vmaxq_f32(peak0, peak1));
+  vst1q_f32(laneSums, vaddq_f32(sum0, sum1));
+  float tailPeaks[2];
+  float tailSums[2];
+  scalarStereoLevels(in + 2 * i, frames - i, tailPeaks, tailSums);
+  mergeStereoLevels(laneMaxima, laneSums, 4, tailPeaks, tailSums, peaks, sumSquares);
+}
+
+void neonFftButterflies(float *re, float *im, const float *twiddleRe, const float *twiddleIm, int half) {
+  int j = 0;
+  for (; j + 4 <= half; j += 4) {
+    const float32x4_t wr = vld1q_f32(twiddleRe + j);
+    const float32x4_t wi = vld1q_f32(twiddleIm + j);
+    const float32x4_t br = vld1q_f32(re + j + half);
+    const float32x4_t bi = vld1q_f32(im + j + half);
+    const float32x4_t ar = vld1q_f32(re + j);
+    const float32x4_t ai = vld1q_f32(im + j);
+    const float32x4_t oddRe = vmlsq_f32(vmulq_f32(wr, br), wi, bi);
+    const float32x4_t oddIm = vmlaq_f32(vmulq_f32(wr, bi), wi, br);
+    vst1q_f32(re + j + half, vsubq_f32(ar, oddRe));
+    vst1q_f32(im + j + half, vsubq_f32(ai, oddIm));
+    vst1q_f32(re + j, vaddq_f32(ar, oddRe));
+    vst1q_f32(im + j, vaddq_f32(ai, oddIm));
+  }
+  fftButterfliesFrom(re, im, twiddleRe, twiddleIm, half, j);
+}
+
+const SampleKernels kNeonKernels = {
+    "neon",
+    &neonInterleavedToMono,
+    &neonInterleavedToStereo,
+    &neonS16ToFloat,
+    &neonS32ToFloat,
+    &neonDownmix51ToStereo,
+    &neonDownmix71ToStereo,
+    &neonStereoLevels,
+    &neonFftButterflies,
+};
+#endif
+
+bool samplesMatch(const std::vector<float> &expected, const std::vector<float> &actual) {
+  for (size_t i = 0; i < expected.size(); ++i) {
+    const float tolerance = 1.0e-5f * (1.0f + std::fabs(expected[i]));
+    if (!(std::fabs(expected[i] - actual[i]) <= tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const SampleKernels &selectSampleKernels() {
+  const std::vector<const SampleKernels *> candidates = availableSampleKernels();
+
+  // A forced table is still checked: an override must not bypass verification.
+  const char *forced = std::getenv("QT6MPLAYER_SAMPLE_KERNELS");
+  if (forced != nullptr && *forced != '\0') {
+    const auto match = std::find_if(candidates.begin(), candidates.end(), [forced](const SampleKernels *kernels) {
+      return std::strcmp(kernels->name, forced) == 0;
+    });
+    if (match == candidates.end()) {
+      qWarning("[qt6mplayer] QT6MPLAYER_SAMPLE_KERNELS=%s is not available here; selecting automatically.", forced);
+    } else {
+      const char *failedKernel = nullptr;
+      if (verifySampleKernels(**match, &failedKernel)) {
+        return **match;
+      }
+      qWarning("[qt6mplayer] Forced %s sample kernels failed verification (%s); using scalar.", forced, failedKernel);
+      return kScalarKernels;
+    }
+  }
+
+  for (const SampleKernels *candidate : candidates) {
+    if (verifySampleKernels(*candidate)) {
+      return *candidate;
+    }
+  }
+  return kScalarKernels;
+}
+} // namespace
+
+const SampleKernels &sampleKernels() {
+  static const SampleKernels &selected = selectSampleKernels();
+  return selected;
+}
+
+const SampleKernels &scalarSampleKernels() { return kScalarKernels; }
+
+std::vector<const SampleKernels *> availableSampleKernels() {
+  std::vector<const SampleKernels *> tables;
+#ifdef QT6MPLAYER_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    tables.push_back(&kAvx2Kernels);
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    tables.push_back(&kSse2Kernels);
+  }
+#endif
+#ifdef QT6MPLAYER_KERNELS_NEON
+  tables.push_back(&kNeonKernels);
+#endif
+  tables.push_back(&kScalarKernels);
+  return tables;
+}
+
+bool verifySampleKernels(const SampleKernels &candidate, const char **failedKernel, int frames) {
+  if (&candidate == &kScalarKernels) {
+    return true;
+  }
+
+  const int blockFrames = std::max(frames, 1);
+  constexpr int kMaxChannels = 8;
+  // The FFT passes below read up to 6 * 64 floats whatever the block length.
+  constexpr int kMinBufferFrames = 64;
+  const auto fail = [failedKernel](const char *kernel) {
+    if (failedKernel != nullptr) {
+      *failedKernel = kernel;
+    }
+    return false;
+  };
+
+  uint32_t state = 0x2545F491U;
+  const auto nextRandom = [&state]() {
+    state = state * 1664525U + 1013904223U;
+    return state;
+  };
+
+  std::vector<float> floats(static_cast<size_t>(std::max(blockFrames, kMinBufferFrames)) * kMaxChannels);
+  for (float &value : floats) {
+    value = static_cast<float>(static_cast<int32_t>(nextRandom())) / 2147483648.0f;
+  }
+  std::vector<int16_t> s16(static_cast<size_t>(blockFrames) * 2U);
+  for (int16_t &value : s16) {
+    value = static_cast<int16_t>(nextRandom() >> 16U);
+  }
+  std::vector<int32_t> s32(static_cast<size_t>(blockFrames) * 2U);
+  for (int32_t &value : s32) {
+    value = static_cast<int32_t>(nextRandom());
+  }
+
+  std::vector<float> expected;
+  std::vector<float> actual;
+  const int channelCounts[] = {1, 2, 3, 6, 8};
+  for (const int channels : channelCounts) {
+    expected.assign(blockFrames, 0.0f);
+    actual.assign(blockFrames, 0.0f);
+    kScalarKernels.interleavedToMono(floats.data(), expected.data(), blockFrames, channels);
+    candidate.interleavedToMono(floats.data(), actual.data(), blockFrames, channels);
+    if (!samplesMatch(expected, actual)) {
+      return fail("interleavedToMono");
+    }
+
+    expected.assign(static_cast<size_t>(blockFrames) * 2U, 0.0f);
+    actual.assign(static_cast<size_t>(blockFrames) * 2U, 0.0f);
+    kScalarKernels.interleavedToStereo(floats.data(), expected.data(), blockFrames, channels);
+    candidate.interleavedToStereo(floats.data(), actual.data(), blockFrames, channels);
+    if (!samplesMatch(expected, actual)) {
+      return fail("interleavedToStereo");
+    }
+  }
+
+  expected.assign(static_cast<size_t>(blockFrames) * 2U, 0.0f);
+  actual.assign(static_cast<size_t>(blockFrames) * 2U, 0.0f);
+  kScalarKernels.downmix51ToStereo(floats.data(), expected.data(), blockFrames);
+  candidate.downmix51ToStereo(floats.data(), actual.data(), blockFrames);
+  if (!samplesMatch(expected, actual)) {
+    return fail("downmix51ToStereo");
+  }
+
+  kScalarKernels.downmix71ToStereo(floats.data(), expected.data(), blockFrames);
+  candidate.downmix71ToStereo(floats.data(), actual.data(), blockFrames);
+  if (!samplesMatch(expected, actual)) {
+    return fail("downmix71ToStereo");
+  }
+
+  kScalarKernels.s16ToFloat(s16.data(), expected.data(), static_cast<int>(s16.size()));
+  candidate.s16ToFloat(s16.data(), actual.data(), static_cast<int>(s16.size()));
+  if (!samplesMatch(expected, actual)) {
+    return fail("s16ToFloat");
+  }
+
+  kScalarKernels.s32ToFloat(s32.data(), expected.data(), static_cast<int>(s32.size()));
+  candidate.s32ToFloat(s32.data(), actual.data(), static_cast<int>(s32.size()));
+  if (!samplesMatch(expected, actual)) {
+    return fail("s32ToFloat");
+  }
+
+  // Lane-wise partial sums round differently from the serial loop.
+  expected.assign(4, 0.0f);
+  actual.assign(4, 0.0f);
+  kScalarKernels.stereoLevels(floats.data(), blockFrames, expected.data(), expected.data() + 2);
+  candidate.stereoLevels(floats.data(), blockFrames, actual.data(), actual.data() + 2);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    if (!(std::fabs(expected[i] - actual[i]) <= 1.0e-4f * (1.0f + std::fabs(expected[i])))) {
+      return fail("stereoLevels");
+    }
+  }
+
+  // Passes shorter than a vector and with a remainder as well as full ones.
+  const int halves[] = {1, 2, 4, 8, 13, 64};
+  std::vector<float> actualIm;
+  std::vector<float> expectedIm;
+  for (const int half : halves) {
+    const float *twiddles = floats.data() + 4 * half;
+    expected.assign(floats.begin(), floats.begin() + 2 * half);
+    expectedIm.assign(floats.begin() + 2 * half, floats.begin() + 4 * half);
+    actual = expected;
+    actualIm = expectedIm;
+    kScalarKernels.fftButterflies(expected.data(), expectedIm.data(), twiddles, twiddles + half, half);
+    candidate.fftButterflies(actual.data(), actualIm.data(), twiddles, twiddles + half, half);
+    if (!samplesMatch(expected, actual) || !samplesMatch(expectedIm, actualIm)) {
+      return fail("fftButterflies");
+    }
+  }
+
+  return true;
+}
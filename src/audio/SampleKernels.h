@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum class PcmSampleFormat { F32, S32, S16 };
+
+inline int bytesPerSample(PcmSampleFormat format) {
+  switch (format) {
+  case PcmSampleFormat::S16:
+    return 2;
+  case PcmSampleFormat::S32:
+  case PcmSampleFormat::F32:
+    return 4;
+  }
+  return 4;
+}
+
+inline const char *sampleFormatName(PcmSampleFormat format) {
+  switch (format) {
+  case PcmSampleFormat::S16:
+    return "S16";
+  case PcmSampleFormat::S32:
+    return "S32";
+  case PcmSampleFormat::F32:
+    return "F32";
+  }
+  return "F32";
+}
+
+// Sample conversion, downmix and analysis kernels used on the capture path. Every
+// table entry has the same contract as the scalar reference; the SIMD
+// tables are checked against it before they are handed out.
+struct SampleKernels {
+  const char *name;
+  void (*interleavedToMono)(const float *in, float *out, int frames, int channels);
+  void (*interleavedToStereo)(const float *in, float *out, int frames, int channels);
+  void (*s16ToFloat)(const int16_t *in, float *out, int samples);
+  void (*s32ToFloat)(const int32_t *in, float *out, int samples);
+  // 5.1 input order: FL FR FC LFE RL RR. 7.1 input order: FL FR FC LFE RL RR SL SR.
+  void (*downmix51ToStereo)(const float *in, float *out, int frames);
+  void (*downmix71ToStereo)(const float *in, float *out, int frames);
+  // Per-channel peak magnitude and sum of squares of interleaved stereo.
+  void (*stereoLevels)(const float *in, int frames, float *peaks, float *sumSquares);
+  // One radix-2 FFT pass over split complex data: for j < half,
+  // x[j], x[j + half] = x[j] + w[j] * x[j + half], x[j] - w[j] * x[j + half].
+  void (*fftButterflies)(float *re, float *im, const float *twiddleRe, const float *twiddleIm, int half);
+};
+
+const SampleKernels &sampleKernels();
+const SampleKernels &scalarSampleKernels();
+// Every table this build and CPU can run, preferred first; scalar is last.
+std::vector<const SampleKernels *> availableSampleKernels();
+// Compares candidate with the scalar table on blocks of frames frames; odd
+// counts exercise the scalar tail of every vector loop.
+bool verifySampleKernels(const SampleKernels &candidate, const char **failedKernel = nullptr, int frames = 1027);
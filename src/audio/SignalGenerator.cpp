@@ -0,0 +1,157 @@
+#include "SignalGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586;
+// One bar of eighths: four on the floor plus the "and" of four, which swing moves.
+constexpr bool kKickPattern[8] = {true, false, true, false, true, false, true, true};
+constexpr double kKickLengthSeconds = 0.5;
+} // namespace
+
+void SignalGenerator::configure(const SignalGeneratorSettings &settings) {
+  m_settings = settings;
+  m_settings.sampleRate = std::clamp(m_settings.sampleRate, 8000, 384000);
+  m_settings.blockFrames = std::clamp(m_settings.blockFrames, 16, 8192);
+  m_settings.level = std::clamp(m_settings.level, 0.0f, 1.0f);
+  m_settings.bpm = std::clamp(m_settings.bpm, 20.0, 400.0);
+  m_settings.swing = std::clamp(m_settings.swing, 0.0, 0.75);
+  m_settings.sweepSeconds = std::max(0.1, m_settings.sweepSeconds);
+  const double nyquist = m_settings.sampleRate / 2.0;
+  m_settings.frequencyHz = std::clamp(m_settings.frequencyHz, 1.0, nyquist);
+  m_settings.sweepStartHz = std::clamp(m_settings.sweepStartHz, 1.0, nyquist);
+  m_settings.sweepEndHz = std::clamp(m_settings.sweepEndHz, 1.0, nyquist);
+
+  m_position = 0;
+  m_phase = 0.0;
+  m_noiseState = m_settings.seed != 0U ? m_settings.seed : 1U;
+  std::fill(std::begin(m_pinkState), std::end(m_pinkState), 0.0f);
+  m_eventIndex = 0;
+  m_nextEventFrame = eventFrame(0);
+  m_kickStartFrame = -1;
+  m_kickPhase = 0.0;
+}
+
+const SignalGeneratorSettings &SignalGenerator::settings() const { return m_settings; }
+
+uint64_t SignalGenerator::position() const { return m_position; }
+
+void SignalGenerator::render(float *stereo, int frames) {
+  if (m_settings.waveform == SignalWaveform::Sine) {
+    // The right channel runs slightly ahead so stereo meters see two signals.
+    const double step = kTwoPi * m_settings.frequencyHz / m_settings.sampleRate;
+    for (int i = 0; i < frames; ++i) {
+      stereo[2 * i] = m_settings.level * static_cast<float>(std::sin(m_phase));
+      stereo[2 * i + 1] = m_settings.level * static_cast<float>(std::sin(m_phase + 0.5));
+      m_phase = std::fmod(m_phase + step, kTwoPi);
+    }
+    m_position += static_cast<uint64_t>(std::max(0, frames));
+    return;
+  }
+
+  for (int i = 0; i < frames; ++i) {
+    const float sample = nextSample();
+    stereo[2 * i] = sample;
+    stereo[2 * i + 1] = sample;
+    ++m_position;
+  }
+}
+
+float SignalGenerator::nextSample() {
+  const double rate = m_settings.sampleRate;
+  switch (m_settings.waveform) {
+  case SignalWaveform::Sine:
+    break;
+  case SignalWaveform::WhiteNoise:
+    return m_settings.level * nextWhite();
+  case SignalWaveform::PinkNoise: {
+    // Paul Kellet's refined filter; the output gain keeps peaks near the white level.
+    const float white = nextWhite();
+    float *b = m_pinkState;
+    b[0] = 0.99886f * b[0] + white * 0.0555179f;
+    b[1] = 0.99332f * b[1] + white * 0.0750759f;
+    b[2] = 0.96900f * b[2] + white * 0.1538520f;
+    b[3] = 0.86650f * b[3] + white * 0.3104856f;
+    b[4] = 0.55000f * b[4] + white * 0.5329522f;
+    b[5] = -0.7616f * b[5] - white * 0.0168980f;
+    const float pink = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + white * 0.5362f;
+    b[6] = white * 0.115926f;
+    return m_settings.level * std::clamp(pink * 0.11f, -1.0f, 1.0f);
+  }
+  case SignalWaveform::LogSweep: {
+    // Exponential sweep restarted every sweepSeconds; the phase is the
+    // closed form, so it does not accumulate rounding error.
+    const auto sweepFrames = static_cast<uint64_t>(m_settings.sweepSeconds * rate);
+    const double t = static_cast<double>(m_position % std::max<uint64_t>(1, sweepFrames)) / rate;
+    const double ratio = std::log(m_settings.sweepEndHz / m_settings.sweepStartHz);
+    double phase = kTwoPi * m_settings.sweepStartHz * t;
+    if (std::fabs(ratio) > 1e-9) {
+      const double k = m_settings.sweepSeconds / ratio;
+      phase = kTwoPi * m_settings.sweepStartHz * k * (std::exp(t / k) - 1.0);
+    }
+    return m_settings.level * static_cast<float>(std::sin(phase));
+  }
+  case SignalWaveform::ImpulseTrain: {
+    const auto position = static_cast<int64_t>(m_position);
+    if (position < m_nextEventFrame) {
+      return 0.0f;
+    }
+    while (m_nextEventFrame <= position) {
+      m_nextEventFrame = eventFrame(++m_eventIndex);
+    }
+    return m_settings.level;
+  }
+  case SignalWaveform::Kick: {
+    const auto position = static_cast<int64_t>(m_position);
+    while (m_nextEventFrame <= position) {
+      if (isKickEvent(m_eventIndex)) {
+        m_kickStartFrame = m_nextEventFrame;
+        m_kickPhase = 0.0;
+      }
+      m_nextEventFrame = eventFrame(++m_eventIndex);
+    }
+    if (m_kickStartFrame < 0) {
+      return 0.0f;
+    }
+    const double age = static_cast<double>(position - m_kickStartFrame) / rate;
+    if (age >= kKickLengthSeconds) {
+      m_kickStartFrame = -1;
+      return 0.0f;
+    }
+    // Pitch falls from ~150 Hz to 50 Hz while the body decays.
+    const double frequency = 50.0 + 100.0 * std::exp(-age / 0.03);
+    m_kickPhase += kTwoPi * frequency / rate;
+    const double envelope = std::exp(-age / 0.12);
+    return m_settings.level * static_cast<float>(std::sin(m_kickPhase) * envelope);
+  }
+  }
+  return 0.0f;
+}
+
+float SignalGenerator::nextWhite() {
+  // xorshift32: cheap, and the same seed gives the same noise on every run.
+  uint32_t x = m_noiseState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  m_noiseState = x;
+  return static_cast<float>(static_cast<int32_t>(x) * (1.0 / 2147483648.0));
+}
+
+// Impulses fall on every beat; kick events on every eighth, off-beats swung.
+int64_t SignalGenerator::eventFrame(uint64_t eventIndex) const {
+  const double beatSeconds = 60.0 / m_settings.bpm;
+  double seconds = static_cast<double>(eventIndex) * beatSeconds;
+  if (m_settings.waveform == SignalWaveform::Kick) {
+    const double eighthSeconds = beatSeconds / 2.0;
+    seconds = static_cast<double>(eventIndex) * eighthSeconds;
+    if ((eventIndex & 1U) != 0U) {
+      seconds += m_settings.swing * eighthSeconds;
+    }
+  }
+  return std::llround(seconds * m_settings.sampleRate);
+}
+
+bool SignalGenerator::isKickEvent(uint64_t eventIndex) const { return kKickPattern[eventIndex % 8U]; }
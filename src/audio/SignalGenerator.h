@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+enum class SignalWaveform { Sine, WhiteNoise, PinkNoise, LogSweep, ImpulseTrain, Kick };
+
+struct SignalGeneratorSettings {
+  SignalWaveform waveform = SignalWaveform::Sine;
+  int sampleRate = 48000;
+  int blockFrames = 512;
+  // Linear peak level of every waveform.
+  float level = 0.5f;
+  double frequencyHz = 440.0;
+  double sweepStartHz = 20.0;
+  double sweepEndHz = 20000.0;
+  double sweepSeconds = 10.0;
+  double bpm = 120.0;
+  // Delay of every off-beat eighth as a fraction of an eighth; 1/3 is triplet swing.
+  double swing = 0.0;
+  uint32_t seed = 1;
+};
+
+// Deterministic test signals, rendered as interleaved stereo. Every event
+// (impulse, kick) lands on the sample computed from its index, so timing
+// does not drift however the output is split into blocks.
+class SignalGenerator {
+public:
+  void configure(const SignalGeneratorSettings &settings);
+  const SignalGeneratorSettings &settings() const;
+
+  void render(float *stereo, int frames);
+  uint64_t position() const;
+
+private:
+  float nextSample();
+  float nextWhite();
+  int64_t eventFrame(uint64_t eventIndex) const;
+  bool isKickEvent(uint64_t eventIndex) const;
+
+  SignalGeneratorSettings m_settings;
+  uint64_t m_position = 0;
+  double m_phase = 0.0;
+  uint32_t m_noiseState = 1;
+  float m_pinkState[7] = {};
+  uint64_t m_eventIndex = 0;
+  int64_t m_nextEventFrame = 0;
+  int64_t m_kickStartFrame = -1;
+  double m_kickPhase = 0.0;
+};
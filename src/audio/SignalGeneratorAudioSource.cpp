@@ -0,0 +1,252 @@
+#include "SignalGeneratorAudioSource.h"
+
+#include "ThreadPlacement.h"
+
+#include <QStringList>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+constexpr int kRingCapacityFrames = 65536;
+constexpr int64_t kResyncLateNs = 1000000000LL;
+
+const QString kGeneratorPrefix = QStringLiteral("generator:");
+
+struct WaveformName {
+  SignalWaveform waveform;
+  const char *name;
+  const char *description;
+};
+
+constexpr WaveformName kWaveforms[] = {
+    {SignalWaveform::Sine, "sine", "Sine tone"},
+    {SignalWaveform::WhiteNoise, "white", "White noise"},
+    {SignalWaveform::PinkNoise, "pink", "Pink noise"},
+    {SignalWaveform::LogSweep, "sweep", "Logarithmic sweep"},
+    {SignalWaveform::ImpulseTrain, "impulse", "Impulse train on every beat"},
+    {SignalWaveform::Kick, "kick", "Kick pattern"},
+};
+
+QString waveformName(SignalWaveform waveform) {
+  for (const WaveformName &entry : kWaveforms) {
+    if (entry.waveform == waveform) {
+      return QString::fromLatin1(entry.name);
+    }
+  }
+  return QStringLiteral("sine");
+}
+} // namespace
+
+SignalGeneratorAudioSource::SignalGeneratorAudioSource(QObject *parent)
+    : BufferedAudioSource(kRingCapacityFrames, parent), m_deviceId(kGeneratorPrefix + QStringLiteral("sine")) {}
+
+SignalGeneratorAudioSource::~SignalGeneratorAudioSource() { stop(); }
+
+bool SignalGeneratorAudioSource::start() {
+  if (m_running) {
+    return true;
+  }
+
+  {
+    const std::lock_guard<std::mutex> lock(m_settingsMutex);
+    m_sampleRate = m_settings.sampleRate;
+  }
+  m_settingsChanged = true;
+  m_running = true;
+  startDraining();
+  m_generatorThread = std::thread(&SignalGeneratorAudioSource::runGenerator, this);
+  Q_EMIT statusMessage(QStringLiteral("Audio backend: signal generator (%1).").arg(selectedDeviceId()));
+  return true;
+}
+
+void SignalGeneratorAudioSource::stop() {
+  m_running = false;
+  if (m_generatorThread.joinable()) {
+    m_generatorThread.join();
+  }
+  stopDraining();
+}
+
+bool SignalGeneratorAudioSource::isRunning() const { return m_running.load(); }
+
+QString SignalGeneratorAudioSource::backendName() const { return QStringLiteral("Generator"); }
+
+QVector<AudioDeviceInfo> SignalGeneratorAudioSource::availableDevices() const {
+  QVector<AudioDeviceInfo> devices;
+  for (const WaveformName &entry : kWaveforms) {
+    AudioDeviceInfo device;
+    device.id = kGeneratorPrefix + QString::fromLatin1(entry.name);
+    device.name = QStringLiteral("Generator: %1").arg(QString::fromLatin1(entry.description));
+    device.description = QStringLiteral("Built-in test signal; append ,key=value to tune it");
+    devices.push_back(device);
+  }
+
+  // Keep a customised selection visible next to the defaults.
+  const QString current = selectedDeviceId();
+  bool listed = false;
+  for (const AudioDeviceInfo &device : devices) {
+    listed = listed || device.id == current;
+  }
+  if (!listed) {
+    AudioDeviceInfo device;
+    device.id = current;
+    device.name = QStringLiteral("Generator: %1").arg(current.mid(kGeneratorPrefix.size()));
+    device.description = QStringLiteral("Built-in test signal");
+    devices.push_back(device);
+  }
+  return devices;
+}
+
+QString SignalGeneratorAudioSource::selectedDeviceId() const {
+  const std::lock_guard<std::mutex> lock(m_settingsMutex);
+  return m_deviceId;
+}
+
+void SignalGeneratorAudioSource::setSelectedDeviceId(const QString &deviceId) {
+  // Ids saved for other backends are ignored so the generator keeps its signal.
+  if (!deviceId.startsWith(kGeneratorPrefix)) {
+    return;
+  }
+  SignalGeneratorSettings settings;
+  QString error;
+  if (!parseDeviceId(deviceId, &settings, &error)) {
+    Q_EMIT errorMessage(QStringLiteral("Signal generator: %1").arg(error));
+    return;
+  }
+
+  const std::lock_guard<std::mutex> lock(m_settingsMutex);
+  m_deviceId = deviceId;
+  m_settings = settings;
+  m_settingsChanged = true;
+}
+
+bool SignalGeneratorAudioSource::retargetDevice(const QString &deviceId) {
+  if (!deviceId.startsWith(kGeneratorPrefix)) {
+    return false;
+  }
+  setSelectedDeviceId(deviceId);
+  return selectedDeviceId() == deviceId;
+}
+
+AudioLatencyInfo SignalGeneratorAudioSource::latencyInfo() const {
+  AudioLatencyInfo info;
+  info.requestedFrames = m_blockFrames.load();
+  info.quantumFrames = info.requestedFrames;
+  info.sampleRate = m_sampleRate.load();
+  return info;
+}
+
+bool SignalGeneratorAudioSource::parseDeviceId(const QString &deviceId, SignalGeneratorSettings *settings,
+                                               QString *error) {
+  const QString spec = deviceId.startsWith(kGeneratorPrefix) ? deviceId.mid(kGeneratorPrefix.size()) : deviceId;
+  const QStringList parts = spec.split(QLatin1Char(','));
+  SignalGeneratorSettings parsed;
+
+  const QString waveform = parts.value(0).trimmed().toLower();
+  bool knownWaveform = waveform.isEmpty();
+  for (const WaveformName &entry : kWaveforms) {
+    if (waveform == QLatin1String(entry.name)) {
+      parsed.waveform = entry.waveform;
+      knownWaveform = true;
+    }
+  }
+  if (!knownWaveform) {
+    if (error != nullptr) {
+      *error = QStringLiteral("unknown waveform \"%1\"").arg(waveform);
+    }
+    return false;
+  }
+
+  for (qsizetype i = 1; i < parts.size(); ++i) {
+    const QString option = parts.at(i).trimmed();
+    if (option.isEmpty()) {
+      continue;
+    }
+    const qsizetype separator = option.indexOf(QLatin1Char('='));
+    const QString key = option.left(separator).trimmed().toLower();
+    bool ok = separator > 0;
+    const double value = ok ? option.mid(separator + 1).trimmed().toDouble(&ok) : 0.0;
+    if (!ok) {
+      if (error != nullptr) {
+        *error = QStringLiteral("expected key=number, got \"%1\"").arg(option);
+      }
+      return false;
+    }
+
+    if (key == QStringLiteral("rate")) {
+      parsed.sampleRate = static_cast<int>(value);
+    } else if (key == QStringLiteral("block")) {
+      parsed.blockFrames = static_cast<int>(value);
+    } else if (key == QStringLiteral("level")) {
+      parsed.level = static_cast<float>(value);
+    } else if (key == QStringLiteral("freq")) {
+      parsed.frequencyHz = value;
+    } else if (key == QStringLiteral("from")) {
+      parsed.sweepStartHz = value;
+    } else if (key == QStringLiteral("to")) {
+      parsed.sweepEndHz = value;
+    } else if (key == QStringLiteral("seconds")) {
+      parsed.sweepSeconds = value;
+    } else if (key == QStringLiteral("bpm")) {
+      parsed.bpm = value;
+    } else if (key == QStringLiteral("swing")) {
+      parsed.swing = value;
+    } else if (key == QStringLiteral("seed")) {
+      parsed.seed = static_cast<uint32_t>(value);
+    } else {
+      if (error != nullptr) {
+        *error = QStringLiteral("unknown option \"%1\" for %2").arg(key, waveformName(parsed.waveform));
+      }
+      return false;
+    }
+  }
+
+  *settings = parsed;
+  return true;
+}
+
+void SignalGeneratorAudioSource::runGenerator() {
+  const ThreadPlacementScope placement(ThreadRole::Capture, "generator");
+  SignalGenerator generator;
+  std::vector<float> block;
+  int64_t startNs = 0;
+  uint64_t generated = 0;
+
+  while (m_running) {
+    if (m_settingsChanged.exchange(false)) {
+      SignalGeneratorSettings settings;
+      {
+        const std::lock_guard<std::mutex> lock(m_settingsMutex);
+        settings = m_settings;
+      }
+      generator.configure(settings);
+      block.assign(static_cast<size_t>(generator.settings().blockFrames) * 2U, 0.0f);
+      m_sampleRate = generator.settings().sampleRate;
+      m_blockFrames = generator.settings().blockFrames;
+      startNs = monotonicTimeNs();
+      generated = 0;
+    }
+
+    const SignalGeneratorSettings &settings = generator.settings();
+    const auto rate = static_cast<uint64_t>(settings.sampleRate);
+    generator.render(block.data(), settings.blockFrames);
+    generated += static_cast<uint64_t>(settings.blockFrames);
+
+    // Pace against the absolute sample clock, not the previous wake-up, so
+    // oversleeping one block does not push every later block back.
+    int64_t dueNs = startNs + static_cast<int64_t>((generated / rate) * 1000000000ULL +
+                                                         (generated % rate) * 1000000000ULL / rate);
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(dueNs)));
+    const int64_t lateNs = monotonicTimeNs() - dueNs;
+    if (lateNs > kResyncLateNs) {
+      // Stalled (suspend, debugger): restart the clock rather than burst to catch up.
+      startNs += lateNs;
+      dueNs += lateNs;
+    }
+
+    m_ring.write(block.data(), settings.blockFrames);
+    meterCaptured(block.data(), settings.blockFrames);
+    m_ring.markTimestamp(dueNs - static_cast<int64_t>(1000000000ULL / rate));
+  }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "BufferedAudioSource.h"
+#include "SignalGenerator.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// Synthetic input for benchmarking without hardware. A generator thread
+// renders one block per period against an absolute sample clock and
+// stamps each block with its ideal capture time. Device ids are
+// "generator:<waveform>[,key=value...]", for example
+// "generator:kick,bpm=128,swing=0.33" or "generator:sweep,from=20,to=20000,seconds=5".
+class SignalGeneratorAudioSource : public BufferedAudioSource {
+  Q_OBJECT
+
+public:
+  explicit SignalGeneratorAudioSource(QObject *parent = nullptr);
+  ~SignalGeneratorAudioSource() override;
+
+  bool start() override;
+  void stop() override;
+  bool isRunning() const override;
+  QString backendName() const override;
+  QVector<AudioDeviceInfo> availableDevices() const override;
+  QString selectedDeviceId() const override;
+  void setSelectedDeviceId(const QString &deviceId) override;
+  bool retargetDevice(const QString &deviceId) override;
+  AudioLatencyInfo latencyInfo() const override;
+
+  static bool parseDeviceId(const QString &deviceId, SignalGeneratorSettings *settings, QString *error = nullptr);
+
+private:
+  void runGenerator();
+
+  std::atomic<bool> m_running{false};
+  std::thread m_generatorThread;
+  mutable std::mutex m_settingsMutex;
+  QString m_deviceId;
+  SignalGeneratorSettings m_settings;
+  std::atomic<bool> m_settingsChanged{false};
+  std::atomic<int> m_blockFrames{512};
+};
@@ -0,0 +1,196 @@
+#include "TempoTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kHistorySeconds = 8.0;
+constexpr double kMinHistorySeconds = 4.0;
+constexpr double kEstimateSeconds = 0.5;
+constexpr double kMinBpm = 60.0;
+constexpr double kMaxBpm = 180.0;
+constexpr double kPreferredBpm = 120.0;
+// Standard deviation of the tempo prior, in octaves.
+constexpr double kPriorOctaves = 0.9;
+constexpr float kDoublePeriodWeight = 0.5f;
+// Variance below which the envelope is the ripple of a sustained sound, not beats.
+constexpr float kMinEnvelopeVariance = 0.006f;
+
+int64_t nextGridPoint(int64_t anchorNs, int64_t periodNs, int64_t timeNs) {
+  if (periodNs <= 0) {
+    return 0;
+  }
+  if (timeNs <= anchorNs) {
+    return anchorNs - ((anchorNs - timeNs) / periodNs) * periodNs;
+  }
+  return anchorNs + ((timeNs - anchorNs + periodNs - 1) / periodNs) * periodNs;
+}
+} // namespace
+
+int64_t TempoEstimate::nextBeatNs(int64_t timeNs) const { return nextGridPoint(beatNs, beatPeriodNs, timeNs); }
+
+int64_t TempoEstimate::nextDownbeatNs(int64_t timeNs) const {
+  return nextGridPoint(downbeatNs, beatPeriodNs * kBeatsPerBar, timeNs);
+}
+
+TempoTracker::TempoTracker() { configure(512 * 1000000000LL / 48000); }
+
+void TempoTracker::configure(int64_t hopNs) {
+  m_hopNs = std::max<int64_t>(1, hopNs);
+  const double hopsPerSecond = 1.0e9 / static_cast<double>(m_hopNs);
+  m_capacity = static_cast<int>(std::ceil(kHistorySeconds * hopsPerSecond));
+  m_minLag = std::max(1, static_cast<int>(std::floor(60.0 / kMaxBpm * hopsPerSecond)));
+  m_maxLag = static_cast<int>(std::ceil(60.0 / kMinBpm * hopsPerSecond));
+  m_hopsPerEstimate = std::max(1, static_cast<int>(kEstimateSeconds * hopsPerSecond));
+  m_novelty.assign(m_capacity, 0.0f);
+  m_lowNovelty.assign(m_capacity, 0.0f);
+  m_centered.assign(m_capacity, 0.0f);
+  m_correlation.assign(2 * m_maxLag + 2, 0.0f);
+  reset();
+}
+
+void TempoTracker::reset() {
+  std::fill(m_novelty.begin(), m_novelty.end(), 0.0f);
+  std::fill(m_lowNovelty.begin(), m_lowNovelty.end(), 0.0f);
+  m_newest = -1;
+  m_filled = 0;
+  m_newestNs = 0;
+  m_hopsSinceEstimate = 0;
+  m_estimate = TempoEstimate();
+}
+
+bool TempoTracker::push(float novelty, float lowNovelty, int64_t timeNs) {
+  m_newest = (m_newest + 1) % m_capacity;
+  // Low-band onsets count twice: beats fall on kicks more often than on hats.
+  m_novelty[m_newest] = novelty + lowNovelty;
+  m_lowNovelty[m_newest] = lowNovelty;
+  m_newestNs = timeNs;
+  m_filled = std::min(m_filled + 1, m_capacity);
+
+  if (++m_hopsSinceEstimate < m_hopsPerEstimate) {
+    return false;
+  }
+  m_hopsSinceEstimate = 0;
+  if (m_filled < static_cast<int>(kMinHistorySeconds * 1.0e9 / static_cast<double>(m_hopNs))) {
+    return false;
+  }
+  updateEstimate();
+  return true;
+}
+
+TempoEstimate TempoTracker::estimate() const { return m_estimate; }
+
+// age 0 is the newest hop.
+float TempoTracker::sampleAt(const std::vector<float> &values, int age) const {
+  return values[(m_newest - age + m_capacity) % m_capacity];
+}
+
+void TempoTracker::updateEstimate() {
+  const int count = m_filled;
+  double mean = 0.0;
+  for (int age = 0; age < count; ++age) {
+    mean += sampleAt(m_novelty, age);
+  }
+  mean /= count;
+  // Oldest first, so the correlation loop walks memory forwards. The
+  // [1 2 1] smoothing widens each onset so a period that falls between
+  // two hops still correlates fully at one of them.
+  for (int i = 0; i < count; ++i) {
+    const int age = count - 1 - i;
+    const float previous = sampleAt(m_novelty, std::min(age + 1, count - 1));
+    const float next = sampleAt(m_novelty, std::max(age - 1, 0));
+    m_centered[i] = 0.25f * (previous + 2.0f * sampleAt(m_novelty, age) + next) - static_cast<float>(mean);
+  }
+
+  const int lastLag = std::min(2 * m_maxLag + 1, count - 1);
+  for (int lag = 0; lag <= lastLag; ++lag) {
+    float sum = 0.0f;
+    for (int i = lag; i < count; ++i) {
+      sum += m_centered[i] * m_centered[i - lag];
+    }
+    m_correlation[lag] = sum / static_cast<float>(count - lag);
+  }
+  if (m_correlation[0] < kMinEnvelopeVariance) {
+    m_estimate = TempoEstimate();
+    return;
+  }
+
+  const double hopsPerMinute = 60.0e9 / static_cast<double>(m_hopNs);
+  int bestLag = 0;
+  float bestScore = 0.0f;
+  for (int lag = m_minLag; lag <= std::min(m_maxLag, lastLag); ++lag) {
+    const double octaves = std::log2(hopsPerMinute / lag / kPreferredBpm) / kPriorOctaves;
+    const float prior = static_cast<float>(std::exp(-0.5 * octaves * octaves));
+    float score = m_correlation[lag];
+    if (2 * lag <= lastLag) {
+      score += kDoublePeriodWeight * m_correlation[2 * lag];
+    }
+    score *= prior;
+    if (score > bestScore) {
+      bestScore = score;
+      bestLag = lag;
+    }
+  }
+  if (bestLag == 0) {
+    m_estimate = TempoEstimate();
+    return;
+  }
+
+  // Parabolic interpolation for a period between hops.
+  double period = bestLag;
+  if (bestLag > m_minLag && bestLag < lastLag) {
+    const double before = m_correlation[bestLag - 1];
+    const double at = m_correlation[bestLag];
+    const double after = m_correlation[bestLag + 1];
+    const double curvature = before - 2.0 * at + after;
+    if (curvature < 0.0) {
+      period += std::clamp(0.5 * (before - after) / curvature, -0.5, 0.5);
+    }
+  }
+
+  // Comb over the envelope: the offset whose beats carry the most onsets.
+  const int beats = static_cast<int>((count - 1) / period);
+  int bestPhase = 0;
+  float bestPhaseScore = -1.0f;
+  for (int phase = 0; phase < bestLag; ++phase) {
+    float score = 0.0f;
+    for (int beat = 0; beat < beats; ++beat) {
+      const int age = phase + static_cast<int>(std::lround(beat * period));
+      if (age >= count) {
+        break;
+      }
+      score += sampleAt(m_novelty, age);
+    }
+    if (score > bestPhaseScore) {
+      bestPhaseScore = score;
+      bestPhase = phase;
+    }
+  }
+
+  // The bar position with the most low-band energy starts the bar.
+  int bestBar = 0;
+  float bestBarScore = -1.0f;
+  for (int offset = 0; offset < TempoEstimate::kBeatsPerBar; ++offset) {
+    float score = 0.0f;
+    for (int beat = offset; beat < beats; beat += TempoEstimate::kBeatsPerBar) {
+      const int age = bestPhase + static_cast<int>(std::lround(beat * period));
+      if (age + 1 >= count) {
+        break;
+      }
+      // One hop either side absorbs rounding in the grid.
+      score += std::max({sampleAt(m_lowNovelty, std::max(0, age - 1)), sampleAt(m_lowNovelty, age),
+                         sampleAt(m_lowNovelty, age + 1)});
+    }
+    if (score > bestBarScore) {
+      bestBarScore = score;
+      bestBar = offset;
+    }
+  }
+
+  const double periodNs = period * static_cast<double>(m_hopNs);
+  m_estimate.bpm = 60.0e9 / periodNs;
+  m_estimate.confidence = std::clamp(m_correlation[bestLag] / m_correlation[0], 0.0f, 1.0f);
+  m_estimate.beatPeriodNs = static_cast<int64_t>(std::llround(periodNs));
+  m_estimate.beatNs = m_newestNs - static_cast<int64_t>(bestPhase) * m_hopNs;
+  m_estimate.downbeatNs = m_estimate.beatNs - static_cast<int64_t>(std::llround(bestBar * periodNs));
+}
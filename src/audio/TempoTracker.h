@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Tempo and beat grid on the capture clock. beatNs and downbeatNs are a
+// recent beat and bar start; the grid extends from them every
+// beatPeriodNs, so predictions stay valid between estimates.
+struct TempoEstimate {
+  static constexpr int kBeatsPerBar = 4;
+
+  double bpm = 0.0;
+  // 0..1, the normalised autocorrelation at the chosen period.
+  float confidence = 0.0f;
+  int64_t beatPeriodNs = 0;
+  int64_t beatNs = 0;
+  int64_t downbeatNs = 0;
+
+  bool isValid() const { return beatPeriodNs > 0; }
+  // First grid point at or after timeNs; 0 without a tempo.
+  int64_t nextBeatNs(int64_t timeNs) const;
+  int64_t nextDownbeatNs(int64_t timeNs) const;
+};
+
+// Estimates tempo, beat phase and downbeat from an onset envelope sampled
+// once per analysis hop. Every half second the last 8 s are
+// autocorrelated over 60..180 BPM, weighted towards 120 BPM and helped by
+// the double period so half and double tempo lose to the felt one. A comb
+// at that period then places the beats, and the beat of the bar with the
+// most low-band onset energy is taken as the downbeat.
+// Not thread-safe: the analysis worker owns it.
+class TempoTracker {
+public:
+  TempoTracker();
+
+  // hopNs is the envelope sample spacing; changing it clears the history.
+  void configure(int64_t hopNs);
+  void reset();
+  // novelty and lowNovelty describe the hop starting at timeNs. True when
+  // the estimate was refreshed.
+  bool push(float novelty, float lowNovelty, int64_t timeNs);
+  TempoEstimate estimate() const;
+
+private:
+  void updateEstimate();
+  float sampleAt(const std::vector<float> &values, int age) const;
+
+  int64_t m_hopNs = 0;
+  int m_capacity = 0;
+  int m_minLag = 0;
+  int m_maxLag = 0;
+  int m_hopsPerEstimate = 0;
+
+  std::vector<float> m_novelty;
+  std::vector<float> m_lowNovelty;
+  int m_newest = -1;
+  int m_filled = 0;
+  int64_t m_newestNs = 0;
+  int m_hopsSinceEstimate = 0;
+
+  std::vector<float> m_centered;
+  std::vector<float> m_correlation;
+  TempoEstimate m_estimate;
+};
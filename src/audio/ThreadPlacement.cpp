@@ -0,0 +1,320 @@
+#include "ThreadPlacement.h"
+
+#include <QHash>
+#include <QStringList>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+constexpr int kMaxThreads = 32;
+constexpr int kRoleCount = 3;
+constexpr int kClaimedTid = -1;
+
+struct ThreadSlot {
+  std::atomic<int> tid{0};
+  std::atomic<int> role{0};
+  std::atomic<const char *> name{nullptr};
+  std::atomic<bool> pending{false};
+};
+
+ThreadSlot g_slots[kMaxThreads];
+std::mutex g_policyMutex;
+ThreadPlacementPolicy g_policies[kRoleCount];
+QHash<int, QString> g_notes;
+
+QString errnoText(int error) { return QString::fromLocal8Bit(std::strerror(error)); }
+
+bool parseCpuList(const QString &text, cpu_set_t *set) {
+  CPU_ZERO(set);
+  for (const QString &part : text.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+    const QStringList range = part.split(QLatin1Char('-'));
+    bool firstOk = false;
+    bool lastOk = range.size() == 1;
+    const int first = range.value(0).trimmed().toInt(&firstOk);
+    const int last = range.size() == 2 ? range.at(1).trimmed().toInt(&lastOk) : first;
+    if (!firstOk || !lastOk || range.size() > 2 || first < 0 || last < first || last >= CPU_SETSIZE) {
+      return false;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      CPU_SET(cpu, set);
+    }
+  }
+  return CPU_COUNT(set) > 0;
+}
+
+QString formatCpuSet(const cpu_set_t &set) {
+  QStringList ranges;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &set)) {
+      continue;
+    }
+    int last = cpu;
+    while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &set)) {
+      ++last;
+    }
+    ranges << (last == cpu ? QString::number(cpu) : QStringLiteral("%1-%2").arg(cpu).arg(last));
+    cpu = last;
+  }
+  return ranges.join(QLatin1Char(','));
+}
+
+int policyFromName(const QString &name) {
+  if (name == QStringLiteral("other")) {
+    return SCHED_OTHER;
+  }
+  if (name == QStringLiteral("batch")) {
+    return SCHED_BATCH;
+  }
+  if (name == QStringLiteral("idle")) {
+    return SCHED_IDLE;
+  }
+  if (name == QStringLiteral("fifo")) {
+    return SCHED_FIFO;
+  }
+  if (name == QStringLiteral("rr")) {
+    return SCHED_RR;
+  }
+  return -1;
+}
+
+QString policyName(int policy) {
+  switch (policy & ~SCHED_RESET_ON_FORK) {
+  case SCHED_OTHER:
+    return QStringLiteral("other");
+  case SCHED_BATCH:
+    return QStringLiteral("batch");
+  case SCHED_IDLE:
+    return QStringLiteral("idle");
+  case SCHED_FIFO:
+    return QStringLiteral("fifo");
+  case SCHED_RR:
+    return QStringLiteral("rr");
+  default:
+    return QStringLiteral("policy %1").arg(policy);
+  }
+}
+
+// Each step is attempted on its own; whatever the kernel refuses is left as
+// it was and described in the returned note.
+QString applyPolicy(int tid, const ThreadPlacementPolicy &policy) {
+  QStringList notes;
+  if (!policy.cpus.isEmpty()) {
+    cpu_set_t set;
+    if (!parseCpuList(policy.cpus, &set)) {
+      notes << QStringLiteral("invalid CPU list %1").arg(policy.cpus);
+    } else if (sched_setaffinity(tid, sizeof(set), &set) != 0) {
+      notes << QStringLiteral("CPUs %1 refused (%2)").arg(policy.cpus, errnoText(errno));
+    }
+  }
+
+  if (!policy.policy.isEmpty()) {
+    const int scheduler = policyFromName(policy.policy);
+    sched_param param = {};
+    if (scheduler == SCHED_FIFO || scheduler == SCHED_RR) {
+      param.sched_priority = std::clamp(policy.priority, sched_get_priority_min(scheduler),
+                                        sched_get_priority_max(scheduler));
+    }
+    if (scheduler < 0) {
+      notes << QStringLiteral("unknown policy %1").arg(policy.policy);
+    } else if (sched_setscheduler(tid, scheduler, &param) != 0) {
+      notes << QStringLiteral("%1 refused (%2), kept %3")
+                   .arg(policy.policy, errnoText(errno), policyName(sched_getscheduler(tid)));
+    }
+  }
+
+  if (policy.hasNice && setpriority(PRIO_PROCESS, static_cast<id_t>(tid), policy.nice) != 0) {
+    notes << QStringLiteral("nice %1 refused (%2)").arg(policy.nice).arg(errnoText(errno));
+  }
+  return notes.join(QStringLiteral("; "));
+}
+
+void placeSlot(ThreadSlot &slot) {
+  const int tid = slot.tid.load();
+  if (tid <= 0) {
+    return;
+  }
+  slot.pending = false;
+  const std::lock_guard<std::mutex> lock(g_policyMutex);
+  const ThreadPlacementPolicy &policy = g_policies[slot.role.load()];
+  if (policy.isEmpty()) {
+    g_notes.remove(tid);
+    return;
+  }
+  const QString note = applyPolicy(tid, policy);
+  if (note.isEmpty()) {
+    g_notes.remove(tid);
+  } else {
+    g_notes.insert(tid, note);
+  }
+}
+} // namespace
+
+QString threadRoleName(ThreadRole role) {
+  switch (role) {
+  case ThreadRole::Capture:
+    return QStringLiteral("capture");
+  case ThreadRole::Render:
+    return QStringLiteral("render");
+  case ThreadRole::Worker:
+    return QStringLiteral("worker");
+  }
+  return QString();
+}
+
+bool parseThreadPlacement(const QString &spec, ThreadPlacementPolicy *policy, QString *error) {
+  ThreadPlacementPolicy parsed;
+  const auto fail = [error](const QString &message) {
+    if (error != nullptr) {
+      *error = message;
+    }
+    return false;
+  };
+
+  for (const QString &token : spec.simplified().split(QLatin1Char(' '), Qt::SkipEmptyParts)) {
+    const qsizetype separator = token.indexOf(QLatin1Char('='));
+    if (separator <= 0) {
+      return fail(QStringLiteral("expected key=value, got \"%1\"").arg(token));
+    }
+    const QString key = token.left(separator).toLower();
+    const QString value = token.mid(separator + 1);
+    bool ok = true;
+    if (key == QStringLiteral("cpus")) {
+      cpu_set_t set;
+      if (!parseCpuList(value, &set)) {
+        return fail(QStringLiteral("invalid CPU list \"%1\"").arg(value));
+      }
+      parsed.cpus = value;
+    } else if (key == QStringLiteral("policy")) {
+      parsed.policy = value.toLower();
+      if (policyFromName(parsed.policy) < 0) {
+        return fail(QStringLiteral("unknown policy \"%1\" (other, batch, idle, fifo, rr)").arg(value));
+      }
+    } else if (key == QStringLiteral("priority")) {
+      parsed.priority = value.toInt(&ok);
+      if (!ok || parsed.priority < 1 || parsed.priority > 99) {
+        return fail(QStringLiteral("priority must be 1-99, got \"%1\"").arg(value));
+      }
+    } else if (key == QStringLiteral("nice")) {
+      parsed.nice = value.toInt(&ok);
+      parsed.hasNice = true;
+      if (!ok || parsed.nice < -20 || parsed.nice > 19) {
+        return fail(QStringLiteral("nice must be -20-19, got \"%1\"").arg(value));
+      }
+    } else {
+      return fail(QStringLiteral("unknown key \"%1\"").arg(key));
+    }
+  }
+
+  if ((parsed.policy == QStringLiteral("fifo") || parsed.policy == QStringLiteral("rr")) && parsed.priority == 0) {
+    parsed.priority = 1;
+  }
+  *policy = parsed;
+  return true;
+}
+
+QString threadPlacementOverride(ThreadRole role) {
+  switch (role) {
+  case ThreadRole::Capture:
+    return qEnvironmentVariable("QT6MPLAYER_CAPTURE_THREADS").trimmed();
+  case ThreadRole::Render:
+    return qEnvironmentVariable("QT6MPLAYER_RENDER_THREAD").trimmed();
+  case ThreadRole::Worker:
+    return qEnvironmentVariable("QT6MPLAYER_WORKER_THREADS").trimmed();
+  }
+  return QString();
+}
+
+void setThreadPlacementPolicy(ThreadRole role, const ThreadPlacementPolicy &policy) {
+  {
+    const std::lock_guard<std::mutex> lock(g_policyMutex);
+    g_policies[static_cast<int>(role)] = policy;
+  }
+  for (ThreadSlot &slot : g_slots) {
+    if (slot.tid.load() > 0 && slot.role.load() == static_cast<int>(role)) {
+      placeSlot(slot);
+    }
+  }
+}
+
+void registerThread(int tid, ThreadRole role, const char *name) {
+  for (ThreadSlot &slot : g_slots) {
+    int expected = 0;
+    if (slot.tid.compare_exchange_strong(expected, kClaimedTid)) {
+      slot.role = static_cast<int>(role);
+      slot.name = name;
+      slot.pending = true;
+      slot.tid = tid;
+      return;
+    }
+  }
+}
+
+void unregisterThread(int tid) {
+  for (ThreadSlot &slot : g_slots) {
+    int expected = tid;
+    if (tid > 0 && slot.tid.compare_exchange_strong(expected, 0)) {
+      const std::lock_guard<std::mutex> lock(g_policyMutex);
+      g_notes.remove(tid);
+      return;
+    }
+  }
+}
+
+void applyPendingThreadPlacement() {
+  for (ThreadSlot &slot : g_slots) {
+    if (slot.pending.load() && slot.tid.load() > 0) {
+      placeSlot(slot);
+    }
+  }
+}
+
+int currentThreadId() { return static_cast<int>(::syscall(SYS_gettid)); }
+
+QVector<ThreadPlacementReport> threadPlacementReports() {
+  QVector<ThreadPlacementReport> reports;
+  for (const ThreadSlot &slot : g_slots) {
+    const int tid = slot.tid.load();
+    if (tid <= 0) {
+      continue;
+    }
+
+    ThreadPlacementReport report;
+    report.role = static_cast<ThreadRole>(slot.role.load());
+    report.name = QString::fromLatin1(slot.name.load());
+    report.tid = tid;
+    cpu_set_t set;
+    if (sched_getaffinity(tid, sizeof(set), &set) == 0) {
+      report.cpus = formatCpuSet(set);
+    }
+    const int scheduler = sched_getscheduler(tid);
+    report.policy = scheduler >= 0 ? policyName(scheduler) : QStringLiteral("unknown");
+    sched_param param = {};
+    if (sched_getparam(tid, &param) == 0) {
+      report.priority = param.sched_priority;
+    }
+    errno = 0;
+    report.nice = getpriority(PRIO_PROCESS, static_cast<id_t>(tid));
+    {
+      const std::lock_guard<std::mutex> lock(g_policyMutex);
+      report.note = g_notes.value(tid);
+    }
+    reports.push_back(report);
+  }
+  return reports;
+}
+
+ThreadPlacementScope::ThreadPlacementScope(ThreadRole role, const char *name) : m_tid(currentThreadId()) {
+  registerThread(m_tid, role, name);
+  applyPendingThreadPlacement();
+}
+
+ThreadPlacementScope::~ThreadPlacementScope() { unregisterThread(m_tid); }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+enum class ThreadRole { Capture, Render, Worker };
+
+// Where and how a group of threads runs. Specs are whitespace-separated
+// key=value pairs, e.g. "cpus=2-3,6 policy=fifo priority=60" or "cpus=0 nice=5".
+struct ThreadPlacementPolicy {
+  QString cpus;
+  // other, batch, idle, fifo or rr; empty keeps the thread's current policy.
+  QString policy;
+  int priority = 0;
+  bool hasNice = false;
+  int nice = 0;
+
+  bool isEmpty() const { return cpus.isEmpty() && policy.isEmpty() && !hasNice; }
+};
+
+struct ThreadPlacementReport {
+  ThreadRole role = ThreadRole::Worker;
+  QString name;
+  int tid = 0;
+  QString cpus;
+  QString policy;
+  int priority = 0;
+  int nice = 0;
+  // Why the requested placement was not (fully) applied.
+  QString note;
+};
+
+QString threadRoleName(ThreadRole role);
+bool parseThreadPlacement(const QString &spec, ThreadPlacementPolicy *policy, QString *error = nullptr);
+// QT6MPLAYER_CAPTURE_THREADS / QT6MPLAYER_RENDER_THREAD / QT6MPLAYER_WORKER_THREADS.
+QString threadPlacementOverride(ThreadRole role);
+
+// Applies to every registered thread of the role now and to later registrations.
+void setThreadPlacementPolicy(ThreadRole role, const ThreadPlacementPolicy &policy);
+
+// Registration only fills a fixed slot with atomics, so threads we do not
+// own (the PipeWire data loop) can register from realtime code. Those are
+// placed by the next applyPendingThreadPlacement() call.
+void registerThread(int tid, ThreadRole role, const char *name);
+void unregisterThread(int tid);
+void applyPendingThreadPlacement();
+int currentThreadId();
+
+// Kernel view of every registered thread.
+QVector<ThreadPlacementReport> threadPlacementReports();
+
+// Registers and places the calling thread for the scope's lifetime.
+class ThreadPlacementScope {
+public:
+  ThreadPlacementScope(ThreadRole role, const char *name);
+  ~ThreadPlacementScope();
+  ThreadPlacementScope(const ThreadPlacementScope &) = delete;
+  ThreadPlacementScope &operator=(const ThreadPlacementScope &) = delete;
+
+private:
+  int m_tid = 0;
+};
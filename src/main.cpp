@@ -1,10 +1,13 @@
 #include "MainWindow.h"
+#include "audio/PipeWireAudioSource.h"
+#include "audio/RtSafetyGuard.h"
 
 #include <QApplication>
 #include <QCoreApplication>
 #include <QFileInfo>
 #include <QSettings>
 #include <QSurfaceFormat>
+#include <QTextStream>
 
 namespace {
 QString normalizeGpuPreference(const QString &value) {
@@ -74,9 +77,32 @@ void applyQtPlatformPreference() {
     qputenv("QT_QPA_PLATFORM", QByteArrayLiteral("xcb"));
   }
 }
+
+// --rt-self-check: push synthetic buffers through the capture path and exit
+// non-zero if the process thread would have allocated or locked.
+int runRtSelfCheck(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QTextStream out(stdout);
+  if (!rtSafetyChecksEnabled()) {
+    out << "RT-safety checks are not compiled in; configure with -DENABLE_RT_CHECKS=ON or a Debug build.\n";
+    return 2;
+  }
+
+  PipeWireAudioSource source;
+  QString report;
+  const bool clean = source.runRtSelfCheck(&report);
+  out << (clean ? "PASS: " : "FAIL: ") << report << '\n';
+  return clean ? 0 : 1;
+}
 } // namespace
 
 int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    if (qstrcmp(argv[i], "--rt-self-check") == 0) {
+      return runRtSelfCheck(argc, argv);
+    }
+  }
+
   applyQtPlatformPreference();
   applyGpuPreference();
   QCoreApplication::setAttribute(Qt::AA_UseDesktopOpenGL);
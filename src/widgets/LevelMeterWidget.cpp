@@ -0,0 +1,72 @@
+#include "LevelMeterWidget.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr float kFloorDb = -60.0f;
+
+float meterPosition(float amplitude) {
+  if (amplitude <= 0.0f) {
+    return 0.0f;
+  }
+  const float db = 20.0f * std::log10(amplitude);
+  return std::clamp((db - kFloorDb) / -kFloorDb, 0.0f, 1.0f);
+}
+} // namespace
+
+LevelMeterWidget::LevelMeterWidget(QWidget *parent) : QWidget(parent) {
+  setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Preferred);
+  setLevels(AudioLevels{});
+}
+
+void LevelMeterWidget::setLevels(const AudioLevels &levels) {
+  m_levels = levels;
+  setToolTip(QStringLiteral("Peak %1 / %2 dBFS\nShort-term loudness %3 / %4 LUFS")
+                 .arg(m_levels.peak[0] > 0.0f ? 20.0 * std::log10(m_levels.peak[0]) : kFloorDb, 0, 'f', 1)
+                 .arg(m_levels.peak[1] > 0.0f ? 20.0 * std::log10(m_levels.peak[1]) : kFloorDb, 0, 'f', 1)
+                 .arg(m_levels.shortTermLufs[0], 0, 'f', 1)
+                 .arg(m_levels.shortTermLufs[1], 0, 'f', 1));
+  update();
+}
+
+void LevelMeterWidget::setMarker(float amplitude) {
+  m_marker = amplitude;
+  update();
+}
+
+QSize LevelMeterWidget::sizeHint() const { return {120, 20}; }
+
+QSize LevelMeterWidget::minimumSizeHint() const { return {60, 12}; }
+
+void LevelMeterWidget::paintEvent(QPaintEvent *event) {
+  Q_UNUSED(event);
+
+  QPainter painter(this);
+  const QRect area = rect().adjusted(1, 1, -1, -1);
+  painter.fillRect(area, palette().color(QPalette::Base));
+
+  const int barHeight = std::max(1, (area.height() - 1) / 2);
+  for (int channel = 0; channel < 2; ++channel) {
+    const int top = area.top() + channel * (barHeight + 1);
+    const int rmsWidth = static_cast<int>(area.width() * meterPosition(m_levels.rms[channel]));
+    const float peak = m_levels.peak[channel];
+    const QColor fill = peak >= 1.0f ? QColor(220, 60, 50) : peak >= 0.5f ? QColor(230, 190, 40) : QColor(70, 180, 90);
+    painter.fillRect(QRect(area.left(), top, rmsWidth, barHeight), fill);
+
+    if (peak > 0.0f) {
+      const int x = area.left() + static_cast<int>((area.width() - 1) * meterPosition(peak));
+      painter.fillRect(QRect(x, top, 2, barHeight), fill.darker(130));
+    }
+  }
+
+  if (m_marker > 0.0f) {
+    const int x = area.left() + static_cast<int>((area.width() - 1) * meterPosition(m_marker));
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawLine(x, area.top(), x, area.bottom());
+  }
+  painter.setPen(palette().color(QPalette::Mid));
+  painter.drawRect(area.adjusted(0, 0, -1, -1));
+}
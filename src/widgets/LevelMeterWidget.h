@@ -0,0 +1,28 @@
+#pragma once
+
+#include "audio/AudioSource.h"
+
+#include <QWidget>
+
+// Two horizontal bars, left over right, on a -60..0 dBFS scale: the fill is
+// RMS, the tick is peak and an optional vertical line marks a threshold.
+class LevelMeterWidget : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit LevelMeterWidget(QWidget *parent = nullptr);
+
+  void setLevels(const AudioLevels &levels);
+  // Linear amplitude; 0 hides the marker.
+  void setMarker(float amplitude);
+
+  QSize sizeHint() const override;
+  QSize minimumSizeHint() const override;
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+
+private:
+  AudioLevels m_levels;
+  float m_marker = 0.0f;
+};
@@ -0,0 +1,140 @@
+#include "BufferedAudioSource.h"
+#include "PcmRechunker.h"
+
+#include <QtTest>
+
+#include <vector>
+
+namespace {
+constexpr int kRingFrames = 8192;
+constexpr int kBlockFrames = 1024;
+constexpr int kHopFrames = 512;
+constexpr size_t kWantedWindows = 4;
+constexpr int kTimeoutMs = 2000;
+} // namespace
+
+// Captures only what the test writes; the drain timer does the rest.
+class TestSource : public BufferedAudioSource {
+  Q_OBJECT
+
+public:
+  TestSource() : BufferedAudioSource(kRingFrames) {}
+
+  bool start() override {
+    startDraining();
+    setFillGaps(true);
+    m_running = true;
+    return true;
+  }
+  void stop() override {
+    stopDraining();
+    m_running = false;
+  }
+  bool isRunning() const override { return m_running; }
+  QString backendName() const override { return QStringLiteral("Test"); }
+  QVector<AudioDeviceInfo> availableDevices() const override { return {}; }
+  QString selectedDeviceId() const override { return {}; }
+  void setSelectedDeviceId(const QString &deviceId) override { Q_UNUSED(deviceId); }
+
+  void capture(int frames) {
+    const std::vector<float> stereo(static_cast<size_t>(frames) * 2U, 0.5f);
+    m_ring.write(stereo.data(), frames);
+  }
+
+private:
+  bool m_running = false;
+};
+
+class BufferedAudioSourceTest : public QObject {
+  Q_OBJECT
+
+private Q_SLOTS:
+  void gapSilenceFillsWindows();
+  void gapSilenceContinuesCapturedAudio();
+  void capturedAudioContinuesGapSilence();
+
+private:
+  void collect(TestSource *source);
+
+  PcmRechunker m_rechunker;
+  std::vector<uint64_t> m_windowPositions;
+  uint64_t m_nextBlockPosition = 0;
+  int m_discontinuities = 0;
+  int m_blocks = 0;
+  int m_capturedBlocks = 0;
+};
+
+void BufferedAudioSourceTest::collect(TestSource *source) {
+  m_rechunker.configure(kBlockFrames, kHopFrames);
+  m_windowPositions.clear();
+  m_nextBlockPosition = 0;
+  m_discontinuities = 0;
+  m_blocks = 0;
+  m_capturedBlocks = 0;
+  connect(source, &AudioSource::pcmFrameReady, this, [this](const QVector<float> &stereo, const PcmBlockInfo &info) {
+    if (m_blocks > 0 && info.samplePosition != m_nextBlockPosition) {
+      ++m_discontinuities;
+    }
+    ++m_blocks;
+    if (!stereo.isEmpty() && stereo.front() != 0.0f) {
+      ++m_capturedBlocks;
+    }
+    const int frames = static_cast<int>(stereo.size() / 2);
+    m_nextBlockPosition = info.samplePosition + static_cast<uint64_t>(frames);
+    m_rechunker.push(stereo.constData(), frames, info, [this](const float *, const float *, const PcmBlockInfo &window) {
+      m_windowPositions.push_back(window.samplePosition);
+    });
+  });
+}
+
+void BufferedAudioSourceTest::gapSilenceFillsWindows() {
+  TestSource source;
+  collect(&source);
+  source.start();
+
+  QTRY_VERIFY_WITH_TIMEOUT(m_windowPositions.size() >= kWantedWindows, kTimeoutMs);
+  source.stop();
+
+  QVERIFY(m_blocks > 1);
+  QCOMPARE(m_discontinuities, 0);
+  for (size_t i = 1; i < m_windowPositions.size(); ++i) {
+    QCOMPARE(m_windowPositions[i], m_windowPositions[i - 1] + kHopFrames);
+  }
+}
+
+void BufferedAudioSourceTest::gapSilenceContinuesCapturedAudio() {
+  TestSource source;
+  collect(&source);
+  source.start();
+  source.capture(kHopFrames);
+
+  QTRY_VERIFY_WITH_TIMEOUT(m_windowPositions.size() >= kWantedWindows, kTimeoutMs);
+  source.stop();
+
+  QCOMPARE(m_discontinuities, 0);
+  QCOMPARE(m_windowPositions.front(), uint64_t{0});
+}
+
+// A source coming back after a reconnect: its first captured block must
+// follow the silence that covered the outage, not restart behind it.
+void BufferedAudioSourceTest::capturedAudioContinuesGapSilence() {
+  TestSource source;
+  collect(&source);
+  source.start();
+
+  QTRY_VERIFY_WITH_TIMEOUT(m_blocks >= 2, kTimeoutMs);
+  source.capture(kBlockFrames);
+  QTRY_VERIFY_WITH_TIMEOUT(m_capturedBlocks > 0, kTimeoutMs);
+  const int blocksAtCapture = m_blocks;
+  QTRY_VERIFY_WITH_TIMEOUT(m_blocks > blocksAtCapture, kTimeoutMs);
+  source.stop();
+
+  QCOMPARE(m_discontinuities, 0);
+  QVERIFY(m_windowPositions.size() >= 2);
+  for (size_t i = 1; i < m_windowPositions.size(); ++i) {
+    QCOMPARE(m_windowPositions[i], m_windowPositions[i - 1] + kHopFrames);
+  }
+}
+
+QTEST_GUILESS_MAIN(BufferedAudioSourceTest)
+#include "tst_bufferedaudiosource.moc"
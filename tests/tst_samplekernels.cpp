@@ -0,0 +1,87 @@
+#include "SampleKernels.h"
+
+#include <QtTest>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+// Lengths around every vector width (4 and 8 lanes, 2 and 4 stereo frames
+// per register) plus a few odd blocks, so each tail length is covered.
+constexpr int kFrameCounts[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 13, 15, 16, 17, 31, 33, 63, 65, 257, 1027, 4099};
+} // namespace
+
+class SampleKernelsTest : public QObject {
+  Q_OBJECT
+
+private Q_SLOTS:
+  void tablesMatchScalar_data();
+  void tablesMatchScalar();
+  void fullScaleDownmixStaysInRange_data();
+  void fullScaleDownmixStaysInRange();
+  void selectedTableIsVerified();
+};
+
+void SampleKernelsTest::tablesMatchScalar_data() {
+  QTest::addColumn<int>("table");
+  QTest::addColumn<int>("frames");
+  const std::vector<const SampleKernels *> tables = availableSampleKernels();
+  for (int table = 0; table < static_cast<int>(tables.size()); ++table) {
+    for (const int frames : kFrameCounts) {
+      QTest::addRow("%s/%d", tables[table]->name, frames) << table << frames;
+    }
+  }
+}
+
+void SampleKernelsTest::tablesMatchScalar() {
+  QFETCH(int, table);
+  QFETCH(int, frames);
+  const char *failedKernel = nullptr;
+  const bool matches = verifySampleKernels(*availableSampleKernels().at(table), &failedKernel, frames);
+  QVERIFY2(matches, failedKernel);
+}
+
+void SampleKernelsTest::fullScaleDownmixStaysInRange_data() {
+  QTest::addColumn<int>("table");
+  QTest::addColumn<int>("channels");
+  QTest::addColumn<float>("level");
+  const std::vector<const SampleKernels *> tables = availableSampleKernels();
+  for (int table = 0; table < static_cast<int>(tables.size()); ++table) {
+    for (const int channels : {6, 8}) {
+      QTest::addRow("%s/%d/+1", tables[table]->name, channels) << table << channels << 1.0f;
+      QTest::addRow("%s/%d/-1", tables[table]->name, channels) << table << channels << -1.0f;
+    }
+  }
+}
+
+void SampleKernelsTest::fullScaleDownmixStaysInRange() {
+  QFETCH(int, table);
+  QFETCH(int, channels);
+  QFETCH(float, level);
+  // Odd length so both the vector body and the scalar tail run.
+  constexpr int frames = 17;
+  const SampleKernels &kernels = *availableSampleKernels().at(table);
+  const std::vector<float> in(static_cast<size_t>(frames) * static_cast<size_t>(channels), level);
+  std::vector<float> out(static_cast<size_t>(frames) * 2U, 0.0f);
+  if (channels == 6) {
+    kernels.downmix51ToStereo(in.data(), out.data(), frames);
+  } else {
+    kernels.downmix71ToStereo(in.data(), out.data(), frames);
+  }
+  for (const float sample : out) {
+    QVERIFY2(std::abs(sample) <= 1.0f + 1e-6f, qPrintable(QString::number(sample)));
+    QVERIFY(std::abs(sample) >= 0.99f);
+  }
+}
+
+void SampleKernelsTest::selectedTableIsVerified() {
+  const SampleKernels &selected = sampleKernels();
+  const std::vector<const SampleKernels *> tables = availableSampleKernels();
+  QVERIFY(std::find(tables.begin(), tables.end(), &selected) != tables.end());
+  QVERIFY(verifySampleKernels(selected));
+  QCOMPARE(tables.back(), &scalarSampleKernels());
+}
+
+QTEST_GUILESS_MAIN(SampleKernelsTest)
+#include "tst_samplekernels.moc"